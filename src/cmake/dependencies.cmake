@@ -148,6 +148,13 @@ if(BUILD_WITH_BULLET AND NOT USE_SYSTEM_BULLET)
   set(BUILD_ENET OFF CACHE BOOL "" FORCE)
   set(BUILD_CLSOCKET OFF CACHE BOOL "" FORCE)
   set(BUILD_EXTRAS OFF CACHE BOOL "" FORCE)
+  # Thread-safe Bullet, for the optional multi-threaded collision dispatch of
+  # BulletPhysicsManager. Uses Bullet's own thread pool.
+  set(BULLET2_MULTITHREADING ON CACHE BOOL "" FORCE)
+  # Bullet only defines this for its own sources, but it changes what is safe
+  # to call concurrently, e.g. for the parallel ray casts of
+  # BulletPhysicsManager
+  add_definitions(-DBT_THREADSAFE=1)
   set(BUILD_BULLET3 OFF CACHE BOOL "" FORCE)
   # This is needed in case BUILD_EXTRAS is enabled, as you'd get a CMake syntax
   # error otherwise
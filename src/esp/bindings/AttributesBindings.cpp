@@ -335,6 +335,19 @@ void initAttributesBindings(py::module& m) {
           &ObjectAttributes::setJoinCollisionMeshes,
           R"(Whether collision meshes for objects constructed from this
           template should be joined into a convex hull or kept separate.)")
+      .def_property(
+          "simplify_collision_hulls",
+          &ObjectAttributes::getSimplifyCollisionHulls,
+          &ObjectAttributes::setSimplifyCollisionHulls,
+          R"(Whether the convex collision shapes built from the collision
+          meshes of this template should only keep the vertices of their
+          convex hull. Computed once per asset and shared between objects.)")
+      .def_property(
+          "max_collision_hull_vertices",
+          &ObjectAttributes::getMaxCollisionHullVertices,
+          &ObjectAttributes::setMaxCollisionHullVertices,
+          R"(If positive and simplify_collision_hulls is set, the convex
+          hulls are decimated to at most this many vertices.)")
       .def_property(
           "is_visibile", &ObjectAttributes::getIsVisible,
           &ObjectAttributes::setIsVisible,
@@ -463,7 +476,17 @@ void initAttributesBindings(py::module& m) {
           &PhysicsManagerAttributes::getRestitutionCoefficient,
           &PhysicsManagerAttributes::setRestitutionCoefficient,
           R"(Default restitution coefficient for contact modeling.  Can be overridden by
-          stage and object values.)");
+          stage and object values.)")
+      .def_property(
+          "num_threads", &PhysicsManagerAttributes::getNumThreads,
+          &PhysicsManagerAttributes::setNumThreads,
+          R"(Number of threads used to step the world. 1 steps single-threaded, 0 or less
+          uses all hardware threads.)")
+      .def_property(
+          "deterministic", &PhysicsManagerAttributes::getDeterministic,
+          &PhysicsManagerAttributes::setDeterministic,
+          R"(Whether multi-threaded stepping gives the same results as single-threaded
+          stepping, at some cost in speed.)");
 
   // ==== AbstractPrimitiveAttributes ====
   py::class_<AbstractPrimitiveAttributes, AbstractAttributes,
@@ -135,6 +135,13 @@ void initPhysicsBindings(py::module& m) {
           "frame_b", &RigidConstraintSettings::frameB,
           R"(Constraint orientation frame in local space of objectB as 3x3 rotation matrix for RigidConstraintType::Fixed.)");
 
+  // ==== struct object PhysicsStateSnapshot ====
+  py::class_<PhysicsStateSnapshot, PhysicsStateSnapshot::ptr>(
+      m, "PhysicsStateSnapshot",
+      R"(Opaque snapshot of the dynamic state of a physics world. Object motion types are not captured. See Simulator.save_physics_state.)")
+      .def_readonly("world_time", &PhysicsStateSnapshot::worldTime,
+                    R"(The simulated time of the world.)");
+
   // ==== struct object RayHitInfo ====
   py::class_<RayHitInfo, RayHitInfo::ptr>(m, "RayHitInfo")
       .def(py::init(&RayHitInfo::create<>))
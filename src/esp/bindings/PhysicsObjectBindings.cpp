@@ -425,6 +425,24 @@ void declareArticulatedObjectWrapper(py::module& m,
                      "'s joint positions. For link to index mapping see "
                      "get_link_joint_pos_offset and get_link_num_joint_pos.")
                         .c_str())
+      .def_property_readonly(
+          "num_joint_positions",
+          &ManagedArticulatedObject::getNumJointPositions,
+          ("The number of joint position values of this " + objType + ".")
+              .c_str())
+      .def_property_readonly(
+          "num_dofs", &ManagedArticulatedObject::getNumDoFs,
+          ("The number of joint degrees of freedom of this " + objType + ".")
+              .c_str())
+      .def_property(
+          "packed_state", &ManagedArticulatedObject::getPackedState,
+          &ManagedArticulatedObject::setPackedState,
+          ("Get or set the full state of this " + objType +
+           " as one flat list: root translation (3), root rotation as an (x, "
+           "y, z, w) quaternion (4), root linear velocity (3), root angular "
+           "velocity (3), joint positions (num_joint_positions) and joint "
+           "velocities (num_dofs).")
+              .c_str())
       .def("get_joint_motor_torques",
            &ManagedArticulatedObject::getJointMotorTorques,
            ("Get " + objType +
@@ -8,6 +8,7 @@
 #include <pybind11/functional.h>
 #include <pybind11/stl.h>
 
+#include <Corrade/Containers/ArrayViewStl.h>
 #include <Corrade/Containers/OptionalPythonBindings.h>
 #include <Magnum/Math/Vector3.h>
 
@@ -52,6 +53,16 @@ void initShortestPathBindings(py::module& m) {
           "geodesic_distance", &ShortestPath::geodesicDistance,
           R"(The geodesic distance between requestedStart and requestedEnd. Will be inf if no path exists.)");
 
+  py::class_<NavLocation, NavLocation::ptr>(
+      m, "NavLocation",
+      R"(A point on the NavMesh together with the NavMesh polygon containing it. Returned by PathFinder.locate() and PathFinder.try_step() and accepted by other PathFinder queries to skip projecting the point to the NavMesh again.)")
+      .def(py::init(&NavLocation::create<>))
+      .def_readwrite("position", &NavLocation::position,
+                     R"(The point on the NavMesh.)")
+      .def_readonly(
+          "poly_ref", &NavLocation::polyRef,
+          R"(Opaque NavMesh polygon containing the position, 0 if the point isn't on the NavMesh.)");
+
   py::class_<MultiGoalShortestPath, MultiGoalShortestPath::ptr>(
       m, "MultiGoalShortestPath",
       R"(Struct for multi-goal shortest path finding. Used in conjunction with PathFinder.findPath().)")
@@ -68,6 +79,13 @@ void initShortestPathBindings(py::module& m) {
           "geodesic_distance", &MultiGoalShortestPath::geodesicDistance,
           R"(The total geodesic distance of the path. Will be inf if no path exists.)");
 
+  py::class_<GoalDistanceField, GoalDistanceField::ptr>(
+      m, "GoalDistanceField",
+      R"(Geodesic distance field to a fixed set of goal points, computed by the first PathFinder.distance_to_goals() query. Makes repeated distance queries to the same goals cheap.)")
+      .def(py::init(&GoalDistanceField::create<>))
+      .def_property("goals", &GoalDistanceField::getGoals,
+                    &GoalDistanceField::setGoals, R"(The goal points.)");
+
   py::class_<NavMeshSettings, NavMeshSettings::ptr>(
       m, "NavMeshSettings",
       R"(Configuration structure for NavMesh generation with recast. Passed to PathFinder::build to construct the NavMesh. Serialized with saved .navmesh files for later equivalency checks upon re-load.)")
@@ -121,6 +139,9 @@ void initShortestPathBindings(py::module& m) {
           "filter_walkable_low_height_spans",
           &NavMeshSettings::filterWalkableLowHeightSpans,
           R"(Marks navigable spans as non-navigable if the clearence above the span is less than the specified height. Allows the formation of navigable regions that will flow over low lying objects such as curbs, and up structures such as stairways. Default True.)")
+      .def_readwrite(
+          "tile_size", &NavMeshSettings::tileSize,
+          R"(Width and depth of the navmesh tiles in voxels. If positive, the scene is partitioned into tiles which are built concurrently. Zero builds a single tile. Default 0.)")
       .def("set_defaults", &NavMeshSettings::setDefaults)
       .def("read_from_json", &NavMeshSettings::readFromJSON,
            R"(Overwrite these settings with values from a JSON file.)")
@@ -140,7 +161,7 @@ void initShortestPathBindings(py::module& m) {
           R"(Get the axis aligned bounding box containing the navigation mesh.)")
       .def(
           "seed", &PathFinder::seed,
-          R"(Seed the pathfinder.  Useful for get_random_navigable_point(). Seeds the global c rand function.)")
+          R"(Seed the pathfinder.  Useful for get_random_navigable_point(). Seeds the random generator owned by this PathFinder.)")
       .def(
           "get_topdown_view", &PathFinder::getTopDownView,
           R"(Returns the topdown view of the PathFinder's navmesh at a given vertical slice with eps slack.)",
@@ -150,13 +171,40 @@ void initShortestPathBindings(py::module& m) {
           R"(Returns the topdown view of the PathFinder's navmesh with island indices at each point or -1 for non-navigable cells for a given vertical slice with eps slack.)",
           "meters_per_pixel"_a, "height"_a, "eps"_a = 0.5)
       // detailed docs in docs/docs.rst
-      .def("get_random_navigable_point", &PathFinder::getRandomNavigablePoint,
+      .def("get_random_navigable_point",
+           py::overload_cast<int, int>(&PathFinder::getRandomNavigablePoint),
            "max_tries"_a = 10, "island_index"_a = ID_UNDEFINED)
+      .def(
+          "get_random_navigable_point",
+          py::overload_cast<core::Random&, int, int>(
+              &PathFinder::getRandomNavigablePoint, py::const_),
+          "rng"_a, "max_tries"_a = 10, "island_index"_a = ID_UNDEFINED,
+          R"(Returns a random navigable point sampled with the given Random generator instead of the one seeded by seed(). Optionally specify the island from which to sample the point.)")
+      .def(
+          "get_random_navigable_points",
+          py::overload_cast<int, int>(&PathFinder::getRandomNavigablePoints),
+          "num_points"_a, "island_index"_a = ID_UNDEFINED,
+          R"(Returns a list of num_points random navigable points, distributed uniformly by area. Optionally specify the island from which to sample the points.)")
+      .def(
+          "get_random_navigable_points",
+          py::overload_cast<core::Random&, int, int>(
+              &PathFinder::getRandomNavigablePoints, py::const_),
+          "rng"_a, "num_points"_a, "island_index"_a = ID_UNDEFINED,
+          R"(Returns a list of num_points random navigable points sampled with the given Random generator.)")
       .def(
           "get_random_navigable_point_near",
-          &PathFinder::getRandomNavigablePointAroundSphere, "circle_center"_a,
-          "radius"_a, "max_tries"_a = 100, "island_index"_a = ID_UNDEFINED,
+          py::overload_cast<const vec3f&, float, int, int>(
+              &PathFinder::getRandomNavigablePointAroundSphere),
+          "circle_center"_a, "radius"_a, "max_tries"_a = 100,
+          "island_index"_a = ID_UNDEFINED,
           R"(Returns a random navigable point within a specified radius about a given point. Optionally specify the island from which to sample the point. Default -1 queries the full navmesh.)")
+      .def(
+          "get_random_navigable_point_near",
+          py::overload_cast<core::Random&, const vec3f&, float, int, int>(
+              &PathFinder::getRandomNavigablePointAroundSphere, py::const_),
+          "rng"_a, "circle_center"_a, "radius"_a, "max_tries"_a = 100,
+          "island_index"_a = ID_UNDEFINED,
+          R"(Returns a random navigable point within a specified radius about a given point, sampled with the given Random generator.)")
       .def(
           "find_path", py::overload_cast<ShortestPath&>(&PathFinder::findPath),
           "path"_a,
@@ -166,6 +214,43 @@ void initShortestPathBindings(py::module& m) {
           py::overload_cast<MultiGoalShortestPath&>(&PathFinder::findPath),
           "path"_a,
           R"(Finds the shortest path between a start point and the closest of a set of end points (in geodesic distance) on the navigation mesh using MultiGoalShortestPath module. Path variable is filled if successful. Returns boolean success.)")
+      .def(
+          "find_path",
+          py::overload_cast<const NavLocation&, const NavLocation&,
+                            ShortestPath&>(&PathFinder::findPath),
+          "start"_a, "end"_a, "path"_a,
+          R"(Finds the shortest path between two NavLocations, reusing their NavMesh polygons. Path variable is filled if successful. Returns boolean success.)")
+      .def(
+          "geodesic_distances",
+          [](PathFinder& self, const std::vector<vec3f>& starts,
+             const std::vector<vec3f>& ends, int numThreads) {
+            std::vector<float> distances(starts.size());
+            self.findPaths(starts, ends, distances, nullptr, numThreads);
+            return distances;
+          },
+          "starts"_a, "ends"_a, "num_threads"_a = 0,
+          R"(Computes the geodesic distance between each pair of start and end points in parallel. Returns a list of distances, inf where no path exists.)")
+      .def(
+          "distance_to_goals", &PathFinder::distanceToGoals, "field"_a, "pt"_a,
+          R"(Returns the geodesic distance from pt to the closest goal of a GoalDistanceField, inf if none is reachable. The field is computed on first use and reused while the goals and the NavMesh stay the same.)")
+      .def(
+          "find_paths",
+          [](PathFinder& self, const std::vector<vec3f>& starts,
+             const std::vector<vec3f>& ends, int numThreads) {
+            std::vector<float> distances(starts.size());
+            std::vector<std::vector<vec3f>> points;
+            self.findPaths(starts, ends, distances, &points, numThreads);
+            std::vector<ShortestPath> paths(starts.size());
+            for (size_t i = 0; i < paths.size(); ++i) {
+              paths[i].requestedStart = starts[i];
+              paths[i].requestedEnd = ends[i];
+              paths[i].geodesicDistance = distances[i];
+              paths[i].points = std::move(points[i]);
+            }
+            return paths;
+          },
+          "starts"_a, "ends"_a, "num_threads"_a = 0,
+          R"(Finds the shortest paths between each pair of start and end points in parallel. Returns a list of ShortestPath.)")
       .def("try_step", &PathFinder::tryStep<Magnum::Vector3>, "start"_a,
            "end"_a)
       .def("try_step", &PathFinder::tryStep<vec3f>, "start"_a, "end"_a)
@@ -173,6 +258,28 @@ void initShortestPathBindings(py::module& m) {
            &PathFinder::tryStepNoSliding<Magnum::Vector3>, "start"_a, "end"_a)
       .def("try_step_no_sliding", &PathFinder::tryStepNoSliding<vec3f>,
            "start"_a, "end"_a)
+      .def("try_step",
+           py::overload_cast<const NavLocation&, const vec3f&>(
+               &PathFinder::tryStep),
+           "start"_a, "end"_a)
+      .def("try_step_no_sliding",
+           py::overload_cast<const NavLocation&, const vec3f&>(
+               &PathFinder::tryStepNoSliding),
+           "start"_a, "end"_a)
+      .def(
+          "try_steps",
+          [](PathFinder& self, const std::vector<vec3f>& starts,
+             const std::vector<vec3f>& ends,
+             std::vector<std::uint64_t> polyRefs, bool allowSliding,
+             int numThreads) {
+            std::vector<vec3f> results(starts.size());
+            self.trySteps(starts, ends, results, polyRefs, allowSliding,
+                          numThreads);
+            return std::make_pair(std::move(results), std::move(polyRefs));
+          },
+          "starts"_a, "ends"_a, "poly_refs"_a = std::vector<std::uint64_t>{},
+          "allow_sliding"_a = true, "num_threads"_a = 0,
+          R"(Steps a batch of agents from starts towards ends in parallel, like try_step or try_step_no_sliding. Returns the end points and the NavMesh polygon of each. Pass those polygons as poly_refs for the next step to skip projecting the start points again.)")
       .def("snap_point", &PathFinder::snapPoint<Magnum::Vector3>, "point"_a,
            "island_index"_a = ID_UNDEFINED)
       .def("snap_point", &PathFinder::snapPoint<vec3f>, "point"_a,
@@ -183,6 +290,13 @@ void initShortestPathBindings(py::module& m) {
       .def(
           "get_island", &PathFinder::getIsland<vec3f>, "point"_a,
           R"(Query the island closest to a point. Snaps the point to the NavMesh first, so check the snap distance also if unsure.)")
+      .def(
+          "get_island",
+          py::overload_cast<const NavLocation&>(&PathFinder::getIsland),
+          "location"_a, R"(Query the island of a NavLocation.)")
+      .def(
+          "locate", &PathFinder::locate, "point"_a, "hint"_a = NavLocation{},
+          R"(Snaps a point to the NavMesh and returns it as a NavLocation. While the point is over the polygon of hint, e.g. the location at the previous step, that polygon is used without searching the NavMesh.)")
       .def(
           "island_radius",
           [](PathFinder& self, const vec3f& pt) {
@@ -225,15 +339,45 @@ void initShortestPathBindings(py::module& m) {
           },
           "island_index"_a = ID_UNDEFINED,
           R"(Returns an array of triangle index data for the triangulated NavMesh poly vertices returned by build_navmesh_vertices(). Optionally limit results to a specific island. Default (island_index==-1) queries all islands.)")
-      .def("load_nav_mesh", &PathFinder::loadNavMesh, "path"_a,
-           R"(Load a .navmesh file overriding this PathFinder instance.)")
+      .def(
+          "load_nav_mesh", &PathFinder::loadNavMesh, "path"_a,
+          "memory_map"_a = false,
+          R"(Load a .navmesh file overriding this PathFinder instance. With memory_map, the file is mapped into memory and its tiles are used in place, sharing them through the page cache with other processes loading the same file.)")
       .def(
           "save_nav_mesh", &PathFinder::saveNavMesh, "path"_a,
           R"(Serialize this PathFinder instance and current NavMesh settings to a .navmesh file.)")
+      .def(
+          "build_landmark_index", &PathFinder::buildLandmarkIndex,
+          "num_landmarks"_a = 8,
+          R"(Precompute geodesic distances from num_landmarks landmarks to every NavMesh polygon. Used by estimate_geodesic_distance and to order the goals of MultiGoalShortestPath queries. Discarded when the NavMesh changes.)")
+      .def_property_readonly("has_landmark_index",
+                             &PathFinder::hasLandmarkIndex)
+      .def(
+          "load_landmark_index", &PathFinder::loadLandmarkIndex, "path"_a,
+          R"(Load a landmark index saved by save_landmark_index for the current NavMesh.)")
+      .def(
+          "save_landmark_index", &PathFinder::saveLandmarkIndex, "path"_a,
+          R"(Serialize the landmark index, e.g. next to the .navmesh file it was built for.)")
+      .def(
+          "estimate_geodesic_distance", &PathFinder::estimateGeodesicDistance,
+          "start"_a, "end"_a,
+          R"(Approximate geodesic distance between two points without a path search, from the landmark index if available. inf if the points aren't connected.)")
+      .def(
+          "build_clearance_field", &PathFinder::buildClearanceField,
+          "tolerance"_a = 0.05f, "max_search_radius"_a = 2.0f,
+          R"(Precompute the distance to the closest obstacle over the NavMesh. Afterwards distance_to_closest_obstacle interpolates it, within tolerance of the searched distance, for search radii up to max_search_radius. Discarded when the NavMesh changes.)")
+      .def_property_readonly("has_clearance_field",
+                             &PathFinder::hasClearanceField)
       .def("distance_to_closest_obstacle",
-           &PathFinder::distanceToClosestObstacle,
+           py::overload_cast<const vec3f&, float>(
+               &PathFinder::distanceToClosestObstacle, py::const_),
            R"(Returns the distance to the closest obstacle.)", "pt"_a,
            "max_search_radius"_a = 2.0)
+      .def("distance_to_closest_obstacle",
+           py::overload_cast<const NavLocation&, float>(
+               &PathFinder::distanceToClosestObstacle, py::const_),
+           R"(Returns the distance to the closest obstacle from a NavLocation.)",
+           "location"_a, "max_search_radius"_a = 2.0)
       // detailed docs in docs/docs.rst
       .def("closest_obstacle_surface_point",
            &PathFinder::closestObstacleSurfacePoint,
@@ -284,6 +428,9 @@ void initShortestPathBindings(py::module& m) {
            py::overload_cast<const core::RigidState&, const Mn::Vector3&>(
                &GreedyGeodesicFollowerImpl::findPath),
            py::return_value_policy::move)
+      .def("find_paths", &GreedyGeodesicFollowerImpl::findPaths, "starts"_a,
+           "ends"_a, "allow_sliding"_a = true, "num_threads"_a = 0,
+           R"(Finds the full paths for a batch of start states and end locations in parallel. Actions are simulated with the default agent controls filtered through the pathfinder instead of the python move functions. Paths are empty if no path was found.)")
       .def("reset", &GreedyGeodesicFollowerImpl::reset);
 }
 
@@ -4,12 +4,15 @@
 
 #include "esp/bindings/Bindings.h"
 
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <Corrade/Utility/DebugStl.h>
 #include <Magnum/ImageView.h>
 #include <Magnum/Magnum.h>
 #include <Magnum/SceneGraph/SceneGraph.h>
 
 #include <Magnum/PythonBindings.h>
 #include <Magnum/SceneGraph/PythonBindings.h>
+#include <pybind11/numpy.h>
 
 #include "esp/gfx/Renderer.h"
 #include "esp/gfx/replay/ReplayManager.h"
@@ -29,6 +32,109 @@ using py::literals::operator""_a;
 namespace esp {
 namespace sim {
 
+namespace {
+
+using FloatArray =
+    py::array_t<float, py::array::c_style | py::array::forcecast>;
+using IntArray = py::array_t<int, py::array::c_style | py::array::forcecast>;
+
+/**
+ * @brief Convert an (N, components) array argument to a contiguous float
+ * array, or to an empty one for None. Contiguous float32 arrays are not
+ * copied.
+ */
+FloatArray castRows(const py::object& obj,
+                    std::size_t n,
+                    std::size_t components,
+                    const char* name,
+                    const char* function =
+                        "Simulator::set_rigid_object_states()") {
+  if (obj.is_none()) {
+    return FloatArray({std::size_t{0}, components});
+  }
+  FloatArray array = py::cast<FloatArray>(obj);
+  ESP_CHECK(array.ndim() == 2 && std::size_t(array.shape(0)) == n &&
+                std::size_t(array.shape(1)) == components,
+            function << Mn::Debug::nospace << ":" << name
+                     << "must be of shape (" << n << "," << components
+                     << ")");
+  return array;
+}
+
+/**
+ * @brief Get the output array @p name of a dict of preallocated arrays passed
+ * as out to @p function, or allocate a new one if @p out is None.
+ * Preallocated arrays are filled in place, so they must be C-contiguous,
+ * writeable and of the exact dtype and shape.
+ */
+template <class Array>
+Array outputArray(const py::object& out,
+                  const char* function,
+                  const char* name,
+                  const std::vector<std::size_t>& shape) {
+  if (out.is_none()) {
+    return Array(shape);
+  }
+  const py::object obj = py::cast<py::dict>(out)[name];
+  // anything else would be converted to a copy and filled without effect
+  ESP_CHECK(py::isinstance<Array>(obj),
+            function << Mn::Debug::nospace << ": out[" << Mn::Debug::nospace
+                     << name << Mn::Debug::nospace << "] must be a C-contiguous"
+                     << (std::is_same<typename Array::value_type,
+                                      float>::value
+                             ? "float32"
+                             : "int32")
+                     << "array");
+  Array array = py::reinterpret_borrow<Array>(obj);
+  bool shapeMatches = std::size_t(array.ndim()) == shape.size();
+  for (std::size_t i = 0; shapeMatches && i != shape.size(); ++i) {
+    shapeMatches = std::size_t(array.shape(i)) == shape[i];
+  }
+  ESP_CHECK(array.writeable() && shapeMatches,
+            function << Mn::Debug::nospace << ": out[" << Mn::Debug::nospace
+                     << name << Mn::Debug::nospace
+                     << "] must be a writeable array of shape" << shape);
+  return array;
+}
+
+/**
+ * @brief Get the (N) or (N, @p components) output array @p name of
+ * Simulator::get_rigid_object_states(), see @ref outputArray.
+ */
+template <class Array>
+Array outputRows(const py::object& out,
+                 const char* name,
+                 std::size_t n,
+                 std::size_t components) {
+  std::vector<std::size_t> shape{n};
+  if (components != 0) {
+    shape.push_back(components);
+  }
+  return outputArray<Array>(out, "Simulator::get_rigid_object_states()", name,
+                            shape);
+}
+
+/**
+ * @brief View the rows of a float array returned by @ref castRows as
+ * elements of T.
+ */
+template <class T>
+Corrade::Containers::ArrayView<const T> rowsView(const FloatArray& array) {
+  return {reinterpret_cast<const T*>(array.data()),
+          std::size_t(array.shape(0))};
+}
+
+/**
+ * @brief Mutable counterpart of @ref rowsView.
+ */
+template <class T>
+Corrade::Containers::ArrayView<T> mutableRowsView(FloatArray& array) {
+  return {reinterpret_cast<T*>(array.mutable_data()),
+          std::size_t(array.shape(0))};
+}
+
+}  // namespace
+
 void initSimBindings(py::module& m) {
   // ==== SimulatorConfiguration ====
   py::class_<SimulatorConfiguration, SimulatorConfiguration::ptr>(
@@ -96,6 +202,9 @@ void initSimBindings(py::module& m) {
       .def_readwrite(
           "requires_textures", &SimulatorConfiguration::requiresTextures,
           R"(Whether or not to load textures for the meshes. This MUST be true for RGB rendering.)")
+      .def_readwrite(
+          "navmesh_cache_dir", &SimulatorConfiguration::navMeshCacheDir,
+          R"(Directory to cache recomputed NavMeshes in, keyed by a hash of the scene geometry and NavMeshSettings. Empty disables the cache. May be shared by concurrent processes.)")
       .def(py::self == py::self)
       .def(py::self != py::self);
 
@@ -249,9 +358,21 @@ void initSimBindings(py::module& m) {
           "get_physics_step_collision_summary",
           &Simulator::getPhysicsStepCollisionSummary,
           R"(Get a summary of collision-processing from the last physics step.)")
-      .def("get_physics_contact_points", &Simulator::getPhysicsContactPoints,
-           R"(Return a list of ContactPointData "
-          "objects describing the contacts from the most recent physics substep.)")
+      .def(
+          "get_physics_contact_points",
+          [](Simulator& self, const std::vector<int>& objectIds) {
+            if (objectIds.empty()) {
+              return self.getPhysicsContactPoints();
+            }
+            // count the matching contacts first, then fill them in place
+            std::vector<esp::physics::ContactPointData> contactPoints(
+                self.getPhysicsContactPoints(nullptr, objectIds));
+            self.getPhysicsContactPoints(contactPoints, objectIds);
+            return contactPoints;
+          },
+          "object_ids"_a = std::vector<int>{},
+          R"(Return a list of ContactPointData "
+          "objects describing the contacts from the most recent physics substep. If object_ids is not empty, only contacts involving one of those objects are returned.)")
       .def(
           "perform_discrete_collision_detection",
           &Simulator::performDiscreteCollisionDetection,
@@ -260,6 +381,68 @@ void initSimBindings(py::module& m) {
           "cast_ray", &Simulator::castRay, "ray"_a, "max_distance"_a = 100.0,
           "scene_id"_a = 0,
           R"(Cast a ray into the collidable scene and return hit results. Physics must be enabled. max_distance in units of ray length.)")
+      .def(
+          "cast_rays",
+          [](Simulator& self, const py::object& origins,
+             const py::object& directions, double maxDistance,
+             int maxHitsPerRay, int collisionFilterMask, int numThreads,
+             const py::object& out, int sceneID) {
+            ESP_CHECK(maxHitsPerRay > 0,
+                      "Simulator::cast_rays(): max_hits_per_ray must be "
+                      "positive but is"
+                          << maxHitsPerRay);
+            // keep converted arrays alive for the duration of the call
+            FloatArray originRows = py::cast<FloatArray>(origins);
+            ESP_CHECK(originRows.ndim() == 2 && originRows.shape(1) == 3,
+                      "Simulator::cast_rays(): origins must be of shape (N, "
+                      "3)");
+            const std::size_t n = originRows.shape(0);
+            const std::size_t k = maxHitsPerRay;
+            FloatArray directionRows = castRows(directions, n, 3, "directions",
+                                                "Simulator::cast_rays()");
+            const auto originView = rowsView<Mn::Vector3>(originRows);
+            const auto directionView = rowsView<Mn::Vector3>(directionRows);
+            std::vector<esp::geo::Ray> rays(n);
+            for (std::size_t i = 0; i < n; ++i) {
+              rays[i] = esp::geo::Ray{originView[i], directionView[i]};
+            }
+
+            FloatArray distances = outputArray<FloatArray>(
+                out, "Simulator::cast_rays()", "distance", {n, k});
+            FloatArray normals = outputArray<FloatArray>(
+                out, "Simulator::cast_rays()", "normal", {n, k, 3});
+            IntArray objectIds = outputArray<IntArray>(
+                out, "Simulator::cast_rays()", "object_id", {n, k});
+            // slots stay empty if the scene has no collision world
+            std::vector<esp::physics::RayHitInfo> hits(n * k);
+            for (esp::physics::RayHitInfo& hit : hits) {
+              hit.rayDistance = -1.0;
+            }
+            self.castRays(rays, hits, maxDistance, collisionFilterMask,
+                          numThreads, sceneID);
+
+            float* distanceData = distances.mutable_data();
+            Mn::Vector3* normalData =
+                reinterpret_cast<Mn::Vector3*>(normals.mutable_data());
+            int* objectIdData = objectIds.mutable_data();
+            for (std::size_t i = 0; i < hits.size(); ++i) {
+              distanceData[i] = float(hits[i].rayDistance);
+              normalData[i] = hits[i].normal;
+              objectIdData[i] = hits[i].objectId;
+            }
+            if (!out.is_none()) {
+              return py::cast<py::dict>(out);
+            }
+            py::dict results;
+            results["distance"] = distances;
+            results["normal"] = normals;
+            results["object_id"] = objectIds;
+            return results;
+          },
+          "origins"_a, "directions"_a, "max_distance"_a = 100.0,
+          "max_hits_per_ray"_a = 1, "collision_filter_mask"_a = -1,
+          "num_threads"_a = 0, "out"_a = py::none(), "scene_id"_a = 0,
+          R"(Cast a batch of rays, given as (N, 3) arrays of origins and directions, into the collidable scene in parallel. Returns a dict of NumPy arrays with max_hits_per_ray hit slots per ray, sorted by distance: distance (N, max_hits_per_ray), normal (N, max_hits_per_ray, 3) and object_id (N, max_hits_per_ray). Slots past the last hit of a ray have a negative distance, their normal and object_id are undefined. With the default max_hits_per_ray of 1 only the closest hit is searched for. Pass the dict returned by a previous call as out to fill its arrays in place instead of allocating new ones. Physics must be enabled. max_distance in units of ray length.)")
       .def("set_object_bb_draw", &Simulator::setObjectBBDraw, "draw_bb"_a,
            "object_id"_a, "scene_id"_a = 0,
            R"(Enable or disable bounding box visualization for an object.)")
@@ -267,6 +450,10 @@ void initSimBindings(py::module& m) {
           "recompute_navmesh", &Simulator::recomputeNavMesh, "pathfinder"_a,
           "navmesh_settings"_a, "include_static_objects"_a = false,
           R"(Recompute the NavMesh for a given PathFinder instance using configured NavMeshSettings. Optionally include all MotionType::STATIC objects in the navigability constraints.)")
+      .def(
+          "update_navmesh", &Simulator::updateNavMesh, "pathfinder"_a,
+          "navmesh_settings"_a,
+          R"(Update a NavMesh computed with recompute_navmesh(include_static_objects=True) after MotionType::STATIC objects were added, moved or removed. If the NavMesh is tiled (NavMeshSettings.tile_size > 0), only the tiles around the changed objects are rebuilt, otherwise the NavMesh is recomputed.)")
 #ifdef ESP_BUILD_WITH_VHACD
       .def(
           "apply_convex_hull_decomposition",
@@ -357,6 +544,162 @@ void initSimBindings(py::module& m) {
            R"(Get a copy of the settings for an existing rigid constraint.)")
       .def("remove_rigid_constraint", &Simulator::removeRigidConstraint,
            "constraint_id"_a, R"(Remove a rigid constraint by id.)")
+      .def(
+          "get_rigid_object_states",
+          [](Simulator& self, const py::object& objectIds,
+             const py::object& out) {
+            IntArray ids;
+            if (objectIds.is_none()) {
+              const std::vector<int> allIds = self.getExistingObjectIDs();
+              ids = outputRows<IntArray>(out, "object_ids", allIds.size(), 0);
+              std::copy(allIds.begin(), allIds.end(), ids.mutable_data());
+            } else {
+              ids = py::cast<IntArray>(objectIds);
+            }
+            const std::size_t n = ids.size();
+            FloatArray translations =
+                outputRows<FloatArray>(out, "translations", n, 3);
+            FloatArray rotations =
+                outputRows<FloatArray>(out, "rotations", n, 4);
+            FloatArray linearVelocities =
+                outputRows<FloatArray>(out, "linear_velocities", n, 3);
+            FloatArray angularVelocities =
+                outputRows<FloatArray>(out, "angular_velocities", n, 3);
+            IntArray motionTypeValues =
+                outputRows<IntArray>(out, "motion_types", n, 0);
+            std::vector<esp::physics::MotionType> motionTypes(n);
+            self.getRigidObjectStates(
+                {ids.data(), n}, mutableRowsView<Mn::Vector3>(translations),
+                mutableRowsView<Mn::Quaternion>(rotations),
+                mutableRowsView<Mn::Vector3>(linearVelocities),
+                mutableRowsView<Mn::Vector3>(angularVelocities), motionTypes);
+            for (std::size_t i = 0; i < n; ++i) {
+              motionTypeValues.mutable_data()[i] = int(motionTypes[i]);
+            }
+            if (!out.is_none()) {
+              return py::cast<py::dict>(out);
+            }
+            py::dict states;
+            states["object_ids"] = ids;
+            states["translations"] = translations;
+            states["rotations"] = rotations;
+            states["linear_velocities"] = linearVelocities;
+            states["angular_velocities"] = angularVelocities;
+            states["motion_types"] = motionTypeValues;
+            return states;
+          },
+          "object_ids"_a = py::none(), "out"_a = py::none(),
+          R"(Get the state of a set of rigid objects, or of all of them if object_ids is None, in one call. Returns a dict of NumPy arrays filled in place by the simulator: object_ids (N), translations (N, 3), rotations (N, 4) as (x, y, z, w) quaternions, linear_velocities (N, 3), angular_velocities (N, 3) and motion_types (N) as MotionType values. Unknown ids get MotionType.UNDEFINED. Pass the dict returned by a previous call as out to fill its arrays in place instead of allocating new ones; out["object_ids"] is only written if object_ids is None.)")
+      .def(
+          "set_rigid_object_states",
+          [](Simulator& self, const py::object& objectIds,
+             const py::object& translations, const py::object& rotations,
+             const py::object& linearVelocities,
+             const py::object& angularVelocities) {
+            IntArray ids = py::cast<IntArray>(objectIds);
+            const std::size_t n = ids.size();
+            // keep converted arrays alive for the duration of the call
+            FloatArray translationRows =
+                castRows(translations, n, 3, "translations");
+            FloatArray rotationRows = castRows(rotations, n, 4, "rotations");
+            FloatArray linearVelocityRows =
+                castRows(linearVelocities, n, 3, "linear_velocities");
+            FloatArray angularVelocityRows =
+                castRows(angularVelocities, n, 3, "angular_velocities");
+            return self.setRigidObjectStates(
+                {ids.data(), n}, rowsView<Mn::Vector3>(translationRows),
+                rowsView<Mn::Quaternion>(rotationRows),
+                rowsView<Mn::Vector3>(linearVelocityRows),
+                rowsView<Mn::Vector3>(angularVelocityRows));
+          },
+          "object_ids"_a, "translations"_a = py::none(),
+          "rotations"_a = py::none(), "linear_velocities"_a = py::none(),
+          "angular_velocities"_a = py::none(),
+          R"(Set the state of a set of rigid objects in one call. Each of translations (N, 3), rotations (N, 4) as (x, y, z, w) quaternions, linear_velocities (N, 3) and angular_velocities (N, 3) may be None to leave that field unchanged. Contiguous float32 arrays are read without copying. Returns whether all ids refer to existing rigid objects; unknown ids are skipped.)")
+      .def(
+          "get_articulated_joint_states",
+          [](Simulator& self, const py::object& objectIds, bool includeForces,
+             const py::object& out) {
+            const char* function = "Simulator::get_articulated_joint_states()";
+            IntArray ids;
+            if (objectIds.is_none()) {
+              const std::vector<int> allIds =
+                  self.getExistingArticulatedObjectIds();
+              ids = outputArray<IntArray>(out, function, "object_ids",
+                                          {allIds.size()});
+              std::copy(allIds.begin(), allIds.end(), ids.mutable_data());
+            } else {
+              ids = py::cast<IntArray>(objectIds);
+            }
+            const Corrade::Containers::ArrayView<const int> idView{
+                ids.data(), std::size_t(ids.size())};
+            std::size_t numPositions = 0;
+            std::size_t numDoFs = 0;
+            ESP_CHECK(self.countArticulatedJointValues(idView, numPositions,
+                                                       numDoFs),
+                      function << Mn::Debug::nospace
+                               << ": unknown articulated object id");
+            FloatArray positions = outputArray<FloatArray>(
+                out, function, "joint_positions", {numPositions});
+            FloatArray velocities = outputArray<FloatArray>(
+                out, function, "joint_velocities", {numDoFs});
+            // an empty output skips the fetch
+            FloatArray forces =
+                includeForces ? outputArray<FloatArray>(out, function,
+                                                        "joint_forces",
+                                                        {numDoFs})
+                              : FloatArray(0);
+            self.getArticulatedJointStates(
+                idView, {positions.mutable_data(), numPositions},
+                {velocities.mutable_data(), numDoFs},
+                {forces.mutable_data(), std::size_t(forces.size())});
+            if (!out.is_none()) {
+              return py::cast<py::dict>(out);
+            }
+            py::dict states;
+            states["object_ids"] = ids;
+            states["joint_positions"] = positions;
+            states["joint_velocities"] = velocities;
+            if (includeForces) {
+              states["joint_forces"] = forces;
+            }
+            return states;
+          },
+          "object_ids"_a = py::none(), "include_forces"_a = true,
+          "out"_a = py::none(),
+          R"(Get the joint state of a set of articulated objects, or of all of them if object_ids is None, in one call. Returns a dict of flat NumPy arrays: object_ids, joint_positions, joint_velocities and, if include_forces is True, joint_forces, with the values of all objects concatenated in the order of object_ids. Each object contributes num_joint_positions positions and num_dofs velocities and forces. Pass the dict returned by a previous call as out to fill its arrays in place instead of allocating new ones; out["object_ids"] is only written if object_ids is None.)")
+      .def(
+          "set_articulated_joint_states",
+          [](Simulator& self, const py::object& objectIds,
+             const py::object& positions, const py::object& velocities,
+             const py::object& forces) {
+            IntArray ids = py::cast<IntArray>(objectIds);
+            // keep converted arrays alive for the duration of the call
+            FloatArray positionValues = positions.is_none()
+                                            ? FloatArray(0)
+                                            : py::cast<FloatArray>(positions);
+            FloatArray velocityValues =
+                velocities.is_none() ? FloatArray(0)
+                                     : py::cast<FloatArray>(velocities);
+            FloatArray forceValues = forces.is_none()
+                                         ? FloatArray(0)
+                                         : py::cast<FloatArray>(forces);
+            return self.setArticulatedJointStates(
+                {ids.data(), std::size_t(ids.size())},
+                {positionValues.data(), std::size_t(positionValues.size())},
+                {velocityValues.data(), std::size_t(velocityValues.size())},
+                {forceValues.data(), std::size_t(forceValues.size())});
+          },
+          "object_ids"_a, "joint_positions"_a = py::none(),
+          "joint_velocities"_a = py::none(), "joint_forces"_a = py::none(),
+          R"(Set the joint state of a set of articulated objects in one call, using the layout of get_articulated_joint_states. Any of joint_positions, joint_velocities and joint_forces may be None to leave that field unchanged. Contiguous float32 arrays are read without copying. Returns whether the ids and array sizes were valid; nothing is changed otherwise.)")
+      .def(
+          "save_physics_state", &Simulator::savePhysicsState,
+          R"(Capture the dynamic state of all objects and rigid constraints: transforms, velocities, joint positions and velocities, joint motor settings and activation states. Motion types are not captured. Restore it with restore_physics_state to reset an episode without removing and re-adding objects.)")
+      .def(
+          "restore_physics_state", &Simulator::restorePhysicsState,
+          "snapshot"_a,
+          R"(Restore a snapshot taken with save_physics_state in place. Objects and constraints are matched by id. Returns whether the snapshot matched the current objects and constraints; the matching ones are restored either way.)")
       .def("get_debug_line_render", &Simulator::getDebugLineRender,
            pybind11::return_value_policy::reference,
            R"(Get visualization helper for rendering lines.)");
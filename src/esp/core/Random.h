@@ -32,6 +32,12 @@ class Random {
   //! std::numeric_limits<uint32_t>::max()]
   uint32_t uniform_uint() { return uniform_uint32_(gen_); }
 
+  //! Return randomly sampled uint32_t distributed uniformly in [0, n), for
+  //! n > 0. Unlike uniform_uint() % n, every value is equally likely.
+  uint32_t uniform_uint(uint32_t n) {
+    return std::uniform_int_distribution<uint32_t>(0, n - 1)(gen_);
+  }
+
   //! Return randomly sampled float distributed uniformly in [0, 1)
   float uniform_float_01() { return uniform_float_01_(gen_); }
 
@@ -92,6 +92,8 @@ ObjectAttributes::ObjectAttributes(const std::string& handle)
 
   setBoundingBoxCollisions(false);
   setJoinCollisionMeshes(true);
+  setSimplifyCollisionHulls(false);
+  setMaxCollisionHullVertices(0);
   // default to use material-derived shader unless otherwise specified in config
   // or instance config
   setShaderType(getShaderTypeName(ObjectInstanceShaderType::Material));
@@ -120,6 +122,8 @@ void ObjectAttributes::writeValuesToJsonInternal(
   writeValueToJson("inertia", jsonObj, allocator);
   writeValueToJson("semantic_id", jsonObj, allocator);
   writeValueToJson("join_collision_meshes", jsonObj, allocator);
+  writeValueToJson("simplify_collision_hulls", jsonObj, allocator);
+  writeValueToJson("max_collision_hull_vertices", jsonObj, allocator);
 
 }  // ObjectAttributes::writeValuesToJsonInternal
 
@@ -363,6 +363,24 @@ class ObjectAttributes : public AbstractObjectAttributes {
     return get<bool>("join_collision_meshes");
   }
 
+  // if true replace the points of mesh collision shapes with the vertices of
+  // their convex hull, computed once per asset
+  void setSimplifyCollisionHulls(bool simplifyCollisionHulls) {
+    set("simplify_collision_hulls", simplifyCollisionHulls);
+  }
+  bool getSimplifyCollisionHulls() const {
+    return get<bool>("simplify_collision_hulls");
+  }
+
+  // if positive and collision hulls are simplified, decimate each hull to at
+  // most this many vertices
+  void setMaxCollisionHullVertices(int maxCollisionHullVertices) {
+    set("max_collision_hull_vertices", maxCollisionHullVertices);
+  }
+  int getMaxCollisionHullVertices() const {
+    return get<int>("max_collision_hull_vertices");
+  }
+
   void setSemanticId(int semanticId) { set("semantic_id", semanticId); }
 
   uint32_t getSemanticId() const { return get<int>("semantic_id"); }
@@ -105,6 +105,18 @@ void ObjectAttributesManager::setValsFromJSONDoc(
       [objAttributes](bool join_collision_meshes) {
         objAttributes->setJoinCollisionMeshes(join_collision_meshes);
       });
+  // Replace mesh collision shapes with their convex hulls if specified
+  io::jsonIntoSetter<bool>(
+      jsonConfig, "simplify_collision_hulls",
+      [objAttributes](bool simplify_collision_hulls) {
+        objAttributes->setSimplifyCollisionHulls(simplify_collision_hulls);
+      });
+  // Max vertex count of simplified collision hulls
+  io::jsonIntoSetter<int>(
+      jsonConfig, "max_collision_hull_vertices",
+      [objAttributes](int max_collision_hull_vertices) {
+        objAttributes->setMaxCollisionHullVertices(max_collision_hull_vertices);
+      });
 
   // The object's interia matrix diagonal
   io::jsonIntoConstSetter<Magnum::Vector3>(
@@ -67,6 +67,19 @@ void PhysicsAttributesManager::setValsFromJSONDoc(
             restitution_coefficient);
       });
 
+  // load the number of threads used to step the world
+  io::jsonIntoSetter<int>(
+      jsonConfig, "num_threads", [physicsManagerAttributes](int num_threads) {
+        physicsManagerAttributes->setNumThreads(num_threads);
+      });
+
+  // load whether multi-threaded stepping must be deterministic
+  io::jsonIntoSetter<bool>(
+      jsonConfig, "deterministic",
+      [physicsManagerAttributes](bool deterministic) {
+        physicsManagerAttributes->setDeterministic(deterministic);
+      });
+
   // load world gravity
   io::jsonIntoConstSetter<Magnum::Vector3>(
       jsonConfig, "gravity",
@@ -8,6 +8,13 @@
 #include <Magnum/EigenIntegration/GeometryIntegration.h>
 #include <Magnum/EigenIntegration/Integration.h>
 
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "esp/core/Check.h"
 #include "esp/core/Esp.h"
 #include "esp/geo/Geo.h"
 
@@ -35,36 +42,99 @@ GreedyGeodesicFollowerImpl::GreedyGeodesicFollowerImpl(
       goalDist_{goalDist},
       turnAmount_{turnAmount},
       fixThrashing_{fixThrashing},
-      thrashingThreshold_{thrashingThreshold} {};
-
-float GreedyGeodesicFollowerImpl::geoDist(const Mn::Vector3& start,
-                                          const Mn::Vector3& end) {
-  geoDistPath_.requestedStart = cast<vec3f>(start);
-  geoDistPath_.requestedEnd = cast<vec3f>(end);
-  pathfinder_->findPath(geoDistPath_);
-  return geoDistPath_.geodesicDistance;
+      thrashingThreshold_{thrashingThreshold} {
+  nodePlanner_.moveForward = [this](core::RigidState& state) {
+    return applyToDummyNode(moveForward_, state);
+  };
+  nodePlanner_.turnLeft = [this](core::RigidState& state) {
+    return applyToDummyNode(turnLeft_, state);
+  };
+  nodePlanner_.turnRight = [this](core::RigidState& state) {
+    return applyToDummyNode(turnRight_, state);
+  };
+};
+
+bool GreedyGeodesicFollowerImpl::applyToDummyNode(const MoveFn& moveFn,
+                                                  core::RigidState& state) {
+  moveDummyNode_.setTranslation(state.translation);
+  moveDummyNode_.setRotation(state.rotation);
+
+  const bool didCollide = moveFn(&moveDummyNode_);
+  state = {moveDummyNode_.rotation(),
+           moveDummyNode_.MagnumObject::translation()};
+  return didCollide;
 }
 
-GreedyGeodesicFollowerImpl::TryStepResult GreedyGeodesicFollowerImpl::tryStep(
-    const scene::SceneNode& node,
-    const Mn::Vector3& end) {
-  tryStepDummyNode_.MagnumObject::setTransformation(
-      node.MagnumObject::transformation());
+GreedyGeodesicFollowerImpl::Planner GreedyGeodesicFollowerImpl::navMeshPlanner(
+    bool allowSliding) const {
+  // Same as the default agent controls with the simulator's step filter, see
+  // ObjectControls and habitat_sim.agent.controls
+  constexpr float collisionEps = 1e-5f;
+  const PathFinder::ptr pathfinder = pathfinder_;
+  const float forwardAmount = forwardAmount_;
+  const Mn::Rad turnAmount{float(turnAmount_)};
+
+  Planner planner;
+  planner.moveForward = [pathfinder, forwardAmount,
+                         allowSliding](core::RigidState& state) {
+    const Mn::Vector3 start = state.translation;
+    const Mn::Vector3 end =
+        start + state.rotation.transformVectorNormalized(
+                    Mn::Vector3{0.0f, 0.0f, -forwardAmount});
+    const Mn::Vector3 filteredEnd =
+        allowSliding ? pathfinder->tryStep(start, end)
+                     : pathfinder->tryStepNoSliding(start, end);
+    state.translation = filteredEnd;
+
+    return (filteredEnd - start).length() + collisionEps <
+           (end - start).length();
+  };
+  planner.turnLeft = [turnAmount](core::RigidState& state) {
+    state.rotation = (state.rotation * Mn::Quaternion::rotation(
+                                           turnAmount, Mn::Vector3::yAxis()))
+                         .normalized();
+    return false;
+  };
+  planner.turnRight = [turnAmount](core::RigidState& state) {
+    state.rotation = (state.rotation * Mn::Quaternion::rotation(
+                                           -turnAmount, Mn::Vector3::yAxis()))
+                         .normalized();
+    return false;
+  };
+
+  return planner;
+}
 
-  const bool didCollide = moveForward_(&tryStepDummyNode_);
-  const Mn::Vector3 newPose = tryStepDummyNode_.MagnumObject::translation();
+float GreedyGeodesicFollowerImpl::geoDist(Planner& planner,
+                                          const Mn::Vector3& start,
+                                          const Mn::Vector3& end) const {
+  planner.geoDistPath.requestedStart = cast<vec3f>(start);
+  planner.geoDistPath.requestedEnd = cast<vec3f>(end);
+  pathfinder_->findPath(planner.geoDistPath);
+  return planner.geoDistPath.geodesicDistance;
+}
 
-  const float geoDistAfter = geoDist(newPose, end);
+GreedyGeodesicFollowerImpl::TryStepResult GreedyGeodesicFollowerImpl::tryStep(
+    Planner& planner,
+    const core::RigidState& state,
+    const Mn::Vector3& end) const {
+  core::RigidState newState = state;
+  const bool didCollide = planner.moveForward(newState);
+  const Mn::Vector3 newPose = newState.translation;
+
+  const float geoDistAfter = geoDist(planner, newPose, end);
   const float distToObsAfter = pathfinder_->distanceToClosestObstacle(
       cast<vec3f>(newPose), 1.1 * closeToObsThreshold_);
 
   return {geoDistAfter, distToObsAfter, didCollide};
 }
 
-float GreedyGeodesicFollowerImpl::computeReward(const scene::SceneNode& node,
+float GreedyGeodesicFollowerImpl::computeReward(Planner& planner,
+                                                const core::RigidState& state,
                                                 const ShortestPath& path,
-                                                const size_t primLen) {
-  const auto tryStepRes = tryStep(node, Mn::Vector3{path.requestedEnd});
+                                                const size_t primLen) const {
+  const auto tryStepRes =
+      tryStep(planner, state, Mn::Vector3{path.requestedEnd});
 
   // Try to minimize geodesic distance to target
   // Divide by forwardAmount_ to make the reward structure independent of step
@@ -83,8 +153,9 @@ float GreedyGeodesicFollowerImpl::computeReward(const scene::SceneNode& node,
 }
 
 std::vector<GreedyGeodesicFollowerImpl::CODES>
-GreedyGeodesicFollowerImpl::nextBestPrimAlong(const core::RigidState& state,
-                                              const ShortestPath& path) {
+GreedyGeodesicFollowerImpl::nextBestPrimAlong(Planner& planner,
+                                              const core::RigidState& state,
+                                              const ShortestPath& path) const {
   if (path.geodesicDistance == std::numeric_limits<float>::infinity()) {
     return {CODES::ERROR};
   }
@@ -98,17 +169,15 @@ GreedyGeodesicFollowerImpl::nextBestPrimAlong(const core::RigidState& state,
   float bestReward = -collisionCost_;
   std::vector<CODES> bestPrim, leftPrim, rightPrim;
 
-  leftDummyNode_.setTranslation(state.translation);
-  leftDummyNode_.setRotation(state.rotation);
-
-  rightDummyNode_.setTranslation(state.translation);
-  rightDummyNode_.setRotation(state.rotation);
+  core::RigidState leftState = state;
+  core::RigidState rightState = state;
 
   // Plan over all primitives of the form [LEFT] * n + [FORWARD]
   // or [RIGHT] * n + [FORWARD]
   for (float angle = 0; angle < M_PI; angle += turnAmount_) {
     {
-      const float reward = computeReward(leftDummyNode_, path, leftPrim.size());
+      const float reward =
+          computeReward(planner, leftState, path, leftPrim.size());
       if (reward > bestReward) {
         bestReward = reward;
         bestPrim = leftPrim;
@@ -118,7 +187,7 @@ GreedyGeodesicFollowerImpl::nextBestPrimAlong(const core::RigidState& state,
 
     {
       const float reward =
-          computeReward(rightDummyNode_, path, rightPrim.size());
+          computeReward(planner, rightState, path, rightPrim.size());
       if (reward > bestReward) {
         bestReward = reward;
         bestPrim = rightPrim;
@@ -132,10 +201,10 @@ GreedyGeodesicFollowerImpl::nextBestPrimAlong(const core::RigidState& state,
       break;
 
     leftPrim.emplace_back(CODES::LEFT);
-    turnLeft_(&leftDummyNode_);
+    planner.turnLeft(leftState);
 
     rightPrim.emplace_back(CODES::RIGHT);
-    turnRight_(&rightDummyNode_);
+    planner.turnRight(rightState);
   }
 
   return bestPrim;
@@ -172,7 +241,7 @@ GreedyGeodesicFollowerImpl::CODES GreedyGeodesicFollowerImpl::nextActionAlong(
     nextAction = thrashingActions_.back();
     thrashingActions_.pop_back();
   } else {
-    const auto nextActions = nextBestPrimAlong(start, path);
+    const auto nextActions = nextBestPrimAlong(nodePlanner_, start, path);
     if (nextActions.empty()) {
       nextAction = CODES::ERROR;
     } else if (fixThrashing_ && isThrashing()) {
@@ -189,58 +258,98 @@ GreedyGeodesicFollowerImpl::CODES GreedyGeodesicFollowerImpl::nextActionAlong(
   return actions_.back();
 }
 
-std::vector<GreedyGeodesicFollowerImpl::CODES>
-GreedyGeodesicFollowerImpl::findPath(const core::RigidState& start,
-                                     const Mn::Vector3& end) {
+bool GreedyGeodesicFollowerImpl::planPath(Planner& planner,
+                                          const core::RigidState& start,
+                                          const Mn::Vector3& end,
+                                          std::vector<CODES>& actions) const {
   constexpr int maxActions = 5e3;
-  findPathDummyNode_.setTranslation(Mn::Vector3{start.translation});
-  findPathDummyNode_.setRotation(Mn::Quaternion{start.rotation});
+  core::RigidState state = start;
 
   do {
-    core::RigidState state{findPathDummyNode_.rotation(),
-                           findPathDummyNode_.MagnumObject::translation()};
     ShortestPath path;
     path.requestedStart = cast<vec3f>(state.translation);
     path.requestedEnd = cast<vec3f>(end);
     pathfinder_->findPath(path);
-    const auto nextPrim = nextBestPrimAlong(state, path);
+    const auto nextPrim = nextBestPrimAlong(planner, state, path);
     if (nextPrim.empty()) {
-      actions_.emplace_back(CODES::ERROR);
+      actions.emplace_back(CODES::ERROR);
     } else {
       for (const auto nextAction : nextPrim) {
         switch (nextAction) {
           case CODES::FORWARD:
-            moveForward_(&findPathDummyNode_);
+            planner.moveForward(state);
             break;
 
           case CODES::RIGHT:
-            turnRight_(&findPathDummyNode_);
+            planner.turnRight(state);
             break;
 
           case CODES::LEFT:
-            turnLeft_(&findPathDummyNode_);
+            planner.turnLeft(state);
             break;
 
           default:
             break;
         }
 
-        actions_.emplace_back(nextAction);
+        actions.emplace_back(nextAction);
       }
     }
 
-  } while (actions_.back() != CODES::STOP && actions_.back() != CODES::ERROR &&
-           actions_.size() < maxActions);
+  } while (actions.back() != CODES::STOP && actions.back() != CODES::ERROR &&
+           actions.size() < maxActions);
 
-  if (actions_.back() == CODES::ERROR)
-    return {};
+  return actions.back() != CODES::ERROR && actions.size() != maxActions;
+}
 
-  if (actions_.size() == maxActions)
+std::vector<GreedyGeodesicFollowerImpl::CODES>
+GreedyGeodesicFollowerImpl::findPath(const core::RigidState& start,
+                                     const Mn::Vector3& end) {
+  if (!planPath(nodePlanner_, start, end, actions_))
     return {};
 
   return actions_;
 }
 
+std::vector<std::vector<GreedyGeodesicFollowerImpl::CODES>>
+GreedyGeodesicFollowerImpl::findPaths(
+    const std::vector<core::RigidState>& starts,
+    const std::vector<Mn::Vector3>& ends,
+    bool allowSliding,
+    int numThreads) {
+  ESP_CHECK(starts.size() == ends.size(),
+            "GreedyGeodesicFollowerImpl::findPaths(): expected the same "
+            "number of starts and ends but got"
+                << starts.size() << "and" << ends.size());
+  const int numQueries = starts.size();
+  std::vector<std::vector<CODES>> paths(numQueries);
+
+#ifdef _OPENMP
+  if (numThreads <= 0) {
+    numThreads = omp_get_max_threads();
+  }
+#else
+  numThreads = 1;
+#endif
+  numThreads = std::max(1, std::min(numThreads, numQueries));
+
+#pragma omp parallel num_threads(numThreads)
+  {
+    // Each worker thread simulates the actions on its own states and reuses
+    // its own geodesic distance query, PathFinder queries are thread-safe
+    Planner planner = navMeshPlanner(allowSliding);
+
+#pragma omp for schedule(dynamic)
+    for (int i = 0; i < numQueries; ++i) {
+      if (!planPath(planner, starts[i], ends[i], paths[i])) {
+        paths[i].clear();
+      }
+    }
+  }
+
+  return paths;
+}
+
 GreedyGeodesicFollowerImpl::CODES GreedyGeodesicFollowerImpl::nextActionAlong(
     const Mn::Quaternion& currentRot,
     const Mn::Vector3& currentPos,
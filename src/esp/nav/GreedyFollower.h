@@ -112,6 +112,36 @@ class GreedyGeodesicFollowerImpl {
   std::vector<CODES> findPath(const core::RigidState& start,
                               const Magnum::Vector3& end);
 
+  /**
+   * @brief Finds the full paths for a batch of start states and end locations
+   *
+   * Plans are computed concurrently on worker threads. Instead of the
+   * @ref MoveFn callbacks, which may call into python, each plan simulates the
+   * actions on its own @ref core::RigidState: "move_forward" moves by
+   * forwardAmount along the forward (-Z) axis and is filtered through
+   * @ref PathFinder::tryStep (or @ref PathFinder::tryStepNoSliding), counting
+   * as a collision if the filter shortened the step, and "turn_left" /
+   * "turn_right" rotate by turnAmount around the Y axis. This matches the
+   * default agent controls with the simulator's step filter.
+   *
+   * Does not modify the state of the follower, so @ref reset is not needed
+   * between calls.
+   *
+   * @param[in] starts The starting states
+   * @param[in] ends The end location of each path. Must be the same size as
+   *                 @p starts.
+   * @param[in] allowSliding Whether "move_forward" may slide along walls
+   * @param[in] numThreads The number of worker threads. Values <= 0 use the
+   *                       OpenMP default.
+   *
+   * @return The actions of each path, empty if no path was found
+   */
+  std::vector<std::vector<CODES>> findPaths(
+      const std::vector<core::RigidState>& starts,
+      const std::vector<Magnum::Vector3>& ends,
+      bool allowSliding = true,
+      int numThreads = 0);
+
   /**
    * @brief Reset the planner.
    *
@@ -132,32 +162,62 @@ class GreedyGeodesicFollowerImpl {
   std::vector<CODES> actions_;
   std::vector<CODES> thrashingActions_;
 
+  //! Applies an action to a state in place, returns whether it collided
+  typedef std::function<bool(core::RigidState&)> StateMoveFn;
+
+  /**
+   * @brief Everything a single plan mutates, so that several plans can run
+   * concurrently
+   */
+  struct Planner {
+    StateMoveFn moveForward, turnLeft, turnRight;
+    ShortestPath geoDistPath;
+  };
+
+  //! Plans through @ref moveForward_ and friends, applied to a dummy node
+  Planner nodePlanner_;
+
   scene::SceneGraph dummyScene_;
-  scene::SceneNode findPathDummyNode_{dummyScene_.getRootNode()},
-      leftDummyNode_{dummyScene_.getRootNode()},
-      rightDummyNode_{dummyScene_.getRootNode()},
-      tryStepDummyNode_{dummyScene_.getRootNode()};
+  scene::SceneNode moveDummyNode_{dummyScene_.getRootNode()};
+
+  bool applyToDummyNode(const MoveFn& moveFn, core::RigidState& state);
+
+  Planner navMeshPlanner(bool allowSliding) const;
 
-  ShortestPath geoDistPath_;
-  float geoDist(const Magnum::Vector3& start, const Magnum::Vector3& end);
+  float geoDist(Planner& planner,
+                const Magnum::Vector3& start,
+                const Magnum::Vector3& end) const;
 
   struct TryStepResult {
     float postGeodesicDistance, postDistanceToClosestObstacle;
     bool didCollide;
   };
 
-  TryStepResult tryStep(const scene::SceneNode& node,
-                        const Magnum::Vector3& end);
+  TryStepResult tryStep(Planner& planner,
+                        const core::RigidState& state,
+                        const Magnum::Vector3& end) const;
 
-  float computeReward(const scene::SceneNode& node,
+  float computeReward(Planner& planner,
+                      const core::RigidState& state,
                       const nav::ShortestPath& path,
-                      size_t primLen);
+                      size_t primLen) const;
 
   bool isThrashing();
 
   std::vector<nav::GreedyGeodesicFollowerImpl::CODES> nextBestPrimAlong(
+      Planner& planner,
       const core::RigidState& state,
-      const nav::ShortestPath& path);
+      const nav::ShortestPath& path) const;
+
+  /**
+   * @brief Appends the actions to get from @p start to @p end to @p actions
+   *
+   * @return False if no path was found within the action limit
+   */
+  bool planPath(Planner& planner,
+                const core::RigidState& start,
+                const Magnum::Vector3& end,
+                std::vector<CODES>& actions) const;
 
   ESP_SMART_POINTERS(GreedyGeodesicFollowerImpl)
 };
@@ -3,12 +3,19 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "PathFinder.h"
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <numeric>
+#include <queue>
 #include <stack>
 #include <unordered_map>
 
 #include <Magnum/Magnum.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Range.h>
 #include <Magnum/Math/Vector3.h>
 
 #include <Magnum/EigenIntegration/GeometryIntegration.h>
@@ -17,16 +24,31 @@
 #include <Corrade/Containers/Optional.h>
 #include <Corrade/Utility/Path.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include <cstdio>
 // NOLINTNEXTLINE
 #define _USE_MATH_DEFINES
 #include <cmath>
 #include <limits>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 #include "esp/assets/MeshData.h"
 #include "esp/core/Esp.h"
+#include "esp/core/Random.h"
 
+#include "DetourCommon.h"
 #include "DetourNavMesh.h"
 #include "DetourNavMeshBuilder.h"
 #include "DetourNavMeshQuery.h"
@@ -54,7 +76,7 @@ bool operator==(const NavMeshSettings& a, const NavMeshSettings& b) {
          CLOSE(edgeMaxError) && CLOSE(vertsPerPoly) &&
          CLOSE(detailSampleDist) && CLOSE(detailSampleMaxError) &&
          EQ(filterLowHangingObstacles) && EQ(filterLedgeSpans) &&
-         EQ(filterWalkableLowHeightSpans);
+         EQ(filterWalkableLowHeightSpans) && EQ(tileSize);
 
 #undef CLOSE
 #undef EQ
@@ -117,16 +139,51 @@ const std::vector<vec3f>& MultiGoalShortestPath::getRequestedEnds() const {
   return pimpl_->requestedEnds;
 }
 
+struct GoalDistanceField::Impl {
+  std::vector<vec3f> goals;
+
+  //! PathFinder::Impl and navmesh generation the field was computed for
+  const void* owner = nullptr;
+  int generation = ID_UNDEFINED;
+
+  //! Distance to the closest goal of the entry point of each polygon, indexed
+  //! by polygon index. Inf for polygons not connected to any goal.
+  std::vector<float> polyDistances;
+  //! Point the distance of each polygon is measured from, on the portal it was
+  //! entered through or a goal inside it
+  std::vector<vec3f> polyEntries;
+  //! Polygon index and snapped position of each goal, sorted by polygon
+  std::vector<std::pair<int, vec3f>> polyGoals;
+};
+
+GoalDistanceField::GoalDistanceField()
+    : pimpl_{spimpl::make_unique_impl<Impl>()} {};
+
+void GoalDistanceField::setGoals(const std::vector<vec3f>& newGoals) {
+  pimpl_->goals = newGoals;
+  pimpl_->owner = nullptr;
+  pimpl_->generation = ID_UNDEFINED;
+}
+
+const std::vector<vec3f>& GoalDistanceField::getGoals() const {
+  return pimpl_->goals;
+}
+
 namespace {
+// Maximum number of polygons in a path corridor and of points in a straight
+// path.
+const int MAX_POLYS = 256;
+
+// Defines size of the bounding box to search in for the nearest polygon.  If
+// there is no polygon inside the bounding box, the status is set to failure
+// and polyRef == 0
+constexpr float polyPickExt[3] = {2, 4, 2};  // [2 * dx, 2 * dy, 2 * dz]
+
 template <typename T>
 std::tuple<dtStatus, dtPolyRef, vec3f> projectToPoly(
     const T& pt,
     const dtNavMeshQuery* navQuery,
     const dtQueryFilter* filter) {
-  // Defines size of the bounding box to search in for the nearest polygon.  If
-  // there is no polygon inside the bounding box, the status is set to failure
-  // and polyRef == 0
-  constexpr float polyPickExt[3] = {2, 4, 2};  // [2 * dx, 2 * dy, 2 * dz]
   dtPolyRef polyRef = 0;
   // Initialize with all NANs at dtStatusSucceed(status) == true does NOT mean
   // that it found a point to project to..........
@@ -140,84 +197,76 @@ std::tuple<dtStatus, dtPolyRef, vec3f> projectToPoly(
 
   return std::make_tuple(status, polyRef, polyXYZ);
 }
-}  // namespace
 
-namespace impl {
-// some systems lack this typedef (e.g. emscripten build)
-typedef unsigned short int ushort;  // NOLINT
+//! Returns a new navmesh generation, unique over all PathFinders so that
+//! locations of one are never taken for locations of another
+int newNavMeshGeneration() {
+  static std::atomic<int> lastGeneration{0};
+  return ++lastGeneration;
+}
 
-//! (flag & flag) operator wrapper for function pointers
-inline ushort andFlag(ushort curFlags, ushort flag) {
-  return curFlags & flag;
+//! Endpoints of the part of a polygon edge shared with the neighbour of a link
+void portalSegment(const dtMeshTile* tile,
+                   const dtPoly* poly,
+                   const dtLink& link,
+                   vec3f& left,
+                   vec3f& right) {
+  const Eigen::Map<const vec3f> v0(
+      &tile->verts[static_cast<size_t>(poly->verts[link.edge]) * 3]);
+  const Eigen::Map<const vec3f> v1(
+      &tile->verts[static_cast<size_t>(
+                       poly->verts[(link.edge + 1) % poly->vertCount]) *
+                   3]);
+  left = v0;
+  right = v1;
+  // links across tile borders may only cover part of the edge
+  if (link.side != 0xff && (link.bmin != 0 || link.bmax != 255)) {
+    const float s = 1.0f / 255.0f;
+    left = v0 + (v1 - v0) * (link.bmin * s);
+    right = v0 + (v1 - v0) * (link.bmax * s);
+  }
 }
-//! (flag | flag) operator wrapper for function pointers
-inline ushort orFlag(ushort curFlags, ushort flag) {
-  return curFlags | flag;
+
+//! Closest point to @p pt on the segment between @p a and @p b
+vec3f closestPointOnSegment(const vec3f& pt, const vec3f& a, const vec3f& b) {
+  const vec3f ab = b - a;
+  const float lengthSqr = ab.squaredNorm();
+  if (lengthSqr <= 0.0f)
+    return a;
+  const float t =
+      std::min(std::max((pt - a).dot(ab) / lengthSqr, 0.0f), 1.0f);
+  return a + t * ab;
 }
+}  // namespace
 
+namespace impl {
 // Runs connected component analysis on the navmesh to figure out which polygons
 // are connected This gives O(1) lookup for if a path between two polygons
 // exists or not
 // Takes O(npolys) to construct
 class IslandSystem {
  public:
-  IslandSystem(const dtNavMesh* navMesh, const dtQueryFilter* filter) {
-    std::vector<vec3f> islandVerts;
-
-    // Iterate over all tiles
-    for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
-      const dtMeshTile* tile = navMesh->getTile(iTile);
-      if (!tile)
-        continue;
-
-      // Iterate over all polygons in a tile
-      for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
-        // Get the polygon reference from the tile and polygon id
-        dtPolyRef startRef = navMesh->encodePolyId(tile->salt, iTile, jPoly);
-
-        // If the polygon ref is valid, and we haven't seen it yet,
-        // start connected component analysis from this polygon
-        if (navMesh->isValidPolyRef(startRef) &&
-            (polyToIsland_.find(startRef) == polyToIsland_.end())) {
-          uint32_t newIslandId = islandRadius_.size();
-          expandFrom(navMesh, filter, newIslandId, startRef, islandVerts);
-
-          // The radius is calculated as the max deviation from the mean for all
-          // points in the island
-          vec3f centroid = vec3f::Zero();
-          for (auto& v : islandVerts) {
-            centroid += v;
-          }
-          centroid /= islandVerts.size();
-
-          float maxRadius = 0.0;
-          for (auto& v : islandVerts) {
-            maxRadius = std::max(maxRadius, (v - centroid).norm());
-          }
-
-          islandRadius_.emplace_back(maxRadius);
-        }
-      }
-    }
+  IslandSystem(dtNavMesh* navMesh, const dtQueryFilter* filter)
+      : navMesh_{navMesh} {
+    layoutPolys();
+    disableUnassignedZeroAreaPolys(navMesh);
+    floodUnassignedPolys(filter);
   }
 
   inline bool hasConnection(dtPolyRef startRef, dtPolyRef endRef) const {
     // If both polygons are on the same island, there must be a path between
     // them
-    auto itStart = polyToIsland_.find(startRef);
-    if (itStart == polyToIsland_.end())
+    const int startIsland = getPolyIsland(startRef);
+    if (startIsland == ID_UNDEFINED)
       return false;
 
-    auto itEnd = polyToIsland_.find(endRef);
-    if (itEnd == polyToIsland_.end())
-      return false;
-
-    return itStart->second == itEnd->second;
+    return startIsland == getPolyIsland(endRef);
   }
 
   //! check that island index is valid. indexOptional allows ID_UNDEFINED as
   //! valid.
-  inline void assertValidIsland(int islandIndex, bool indexOptional = true) {
+  inline void assertValidIsland(int islandIndex,
+                                bool indexOptional = true) const {
     if (indexOptional && islandIndex == ID_UNDEFINED) {
       return;
     }
@@ -226,24 +275,25 @@ class IslandSystem {
         islandIndex << " not a valid index for this island system.", );
   }
 
-  inline float islandRadius(int islandIndex) {
+  inline float islandRadius(int islandIndex) const {
     assertValidIsland(islandIndex, /*indexOptional*/ false);
     return islandRadius_[islandIndex];
   }
 
   inline float polyIslandRadius(dtPolyRef ref) const {
-    auto itRef = polyToIsland_.find(ref);
-    if (itRef == polyToIsland_.end())
+    const int island = getPolyIsland(ref);
+    if (island == ID_UNDEFINED)
       return 0.0;
 
-    return islandRadius_[itRef->second];
+    return islandRadius_[island];
   }
 
   //! Get the area of an island.
   //! islandIndex=ID_UNDEFINED specifies the full NavMesh area.
-  inline float getNavigableArea(int islandIndex) {
+  inline float getNavigableArea(int islandIndex) const {
     assertValidIsland(islandIndex);
-    return islandsToArea_[islandIndex];
+    auto itArea = islandsToArea_.find(islandIndex);
+    return itArea == islandsToArea_.end() ? 0.0f : itArea->second;
   }
 
   inline int numIslands() const {
@@ -251,82 +301,262 @@ class IslandSystem {
     return islandRadius_.size();
   }
 
+  // Some polygons have zero area for some reason.  When we navigate into a zero
+  // area polygon, things crash.  So we find all zero area polygons and mark
+  // them as disabled/not navigable.
+  // Also compute the NavMesh areas for later query.
+  void removeZeroAreaPolys(dtNavMesh* navMesh) {
+    islandsToArea_.clear();
+    islandSamplers_.clear();
+    computeIslandAreas(navMesh, 0);
+  }
+
   /**
-   * @brief Sets a specified poly flag for all polys specified by the
-   * islandIndex.
+   * @brief Islands with polygons in the given tiles or in the tiles around
+   * them.
+   *
+   * Those are all the islands which can change when the given tiles are
+   * replaced.
    *
-   * @param[in] navMesh The navmesh to operate on.
-   * @param[in] flag The flag to set or clear.
-   * @param[in] islandIndex Specify the island. islandIndex == ID_UNDEFINED
-   * specifies all islands.
-   * @param[in] setFlag If true, set the flag(currentFlags OR newFlag),
-   * otherwise clear the flag(currentFlags AND ~newFlag).
-   * @param[in] invert If true, set or clear the flag for all islands except the
-   * specified one. Has no effect if islandIndex == ID_UNDEFINED.
+   * @param[in] tiles (x, z) coordinates of tiles in the tile grid.
    */
-  inline void setPolyFlagForIsland(dtNavMesh* navMesh,
-                                   ushort flag,
-                                   int islandIndex = ID_UNDEFINED,
-                                   bool setFlag = true,
-                                   bool invert = false) {
-    assertValidIsland(islandIndex);
-    CORRADE_ASSERT(navMesh != nullptr, "invalid navMesh pointer", );
-    std::vector<int> islands;
-
-    if (islandIndex == ID_UNDEFINED) {
-      // all islands
-      islands.reserve(islandsToPolys_.size());
-      for (auto& itr : islandsToPolys_) {
-        islands.push_back(itr.first);
+  std::vector<int> islandsNearTiles(
+      const std::vector<std::pair<int, int>>& tiles) const;
+
+  /**
+   * @brief Update the islands after tiles of the navmesh were replaced.
+   *
+   * Islands not in @p dirtyIslands keep their polygons, area and sampler and
+   * are only renumbered. Polygons of the dirty islands and of the new tiles
+   * are flood filled into new islands the same way a full build does, so
+   * disabled and zero area polygons don't get islands of their own.
+   *
+   * @param[in] dirtyIslands Islands which may have changed, collected with
+   * @ref islandsNearTiles before the tiles were replaced.
+   */
+  void update(dtNavMesh* navMesh,
+              const dtQueryFilter* filter,
+              const std::vector<int>& dirtyIslands);
+
+  //! return the island for a navmesh polygon or ID_UNDEFINED if the polygon
+  //! isn't part of any island. Constant time and safe to call concurrently.
+  inline int getPolyIsland(dtPolyRef polyRef) const {
+    const int index = polyIndex(polyRef);
+    return index == ID_UNDEFINED ? ID_UNDEFINED : polyIsland_[index];
+  }
+
+  /**
+   * @brief Draw a point uniformly distributed over the area of an island in
+   * constant time.
+   *
+   * @param[in] islandIndex The island to sample. ID_UNDEFINED samples the full
+   * NavMesh.
+   * @param[in] rng The random generator to sample with.
+   * @param[out] polyRef If not null, set to the polygon containing the point.
+   *
+   * @return The sampled point or NAN if the island has no navigable area.
+   */
+  vec3f sampleNavigablePoint(int islandIndex,
+                             core::Random& rng,
+                             dtPolyRef* polyRef = nullptr) const {
+    auto itSampler = islandSamplers_.find(islandIndex);
+    if (itSampler == islandSamplers_.end() || itSampler->second.empty()) {
+      return vec3f::Constant(Mn::Constants::nan());
+    }
+    return itSampler->second.sample(rng, polyRef);
+  }
+
+  //! index of a polygon in the flat table of all polygons of the navmesh, or
+  //! ID_UNDEFINED for invalid refs
+  inline int polyIndex(dtPolyRef polyRef) const {
+    if (polyRef == 0)
+      return ID_UNDEFINED;
+    const unsigned int iTile = navMesh_->decodePolyIdTile(polyRef);
+    const unsigned int iPoly = navMesh_->decodePolyIdPoly(polyRef);
+    if (iTile >= tilePolyBase_.size())
+      return ID_UNDEFINED;
+    const dtMeshTile* tile = navMesh_->getTile(iTile);
+    if (!tile || !tile->header || iPoly >= tile->header->polyCount)
+      return ID_UNDEFINED;
+    return tilePolyBase_[iTile] + iPoly;
+  }
+
+  //! number of polygons in the flat table of all polygons of the navmesh
+  inline int numPolys() const { return polyIsland_.size(); }
+
+ private:
+  /**
+   * @brief Area weighted sampler over the detail triangles of one island.
+   *
+   * Triangles are selected with Walker's alias method, so sampling costs
+   * O(1) regardless of the number of polygons.
+   */
+  struct AreaSampler {
+    //! polygon of each triangle
+    std::vector<dtPolyRef> triPolys;
+    //! area of each triangle
+    std::vector<float> triAreas;
+    //! vertices of each triangle, 3 consecutive per triangle
+    std::vector<vec3f> triVerts;
+    //! probability of keeping the selected column of the alias table
+    std::vector<float> aliasProbs;
+    //! triangle to use instead if the selected column isn't kept
+    std::vector<int> aliasIndices;
+
+    bool empty() const { return aliasProbs.empty(); }
+
+    //! Adds the triangles of another sampler. Needs a new alias table.
+    void append(const AreaSampler& other) {
+      triPolys.insert(triPolys.end(), other.triPolys.begin(),
+                      other.triPolys.end());
+      triAreas.insert(triAreas.end(), other.triAreas.begin(),
+                      other.triAreas.end());
+      triVerts.insert(triVerts.end(), other.triVerts.begin(),
+                      other.triVerts.end());
+    }
+
+    void addTriangle(dtPolyRef polyRef,
+                     float area,
+                     const vec3f& a,
+                     const vec3f& b,
+                     const vec3f& c) {
+      triPolys.push_back(polyRef);
+      triAreas.push_back(area);
+      triVerts.push_back(a);
+      triVerts.push_back(b);
+      triVerts.push_back(c);
+    }
+
+    //! Builds the alias table from triAreas (Vose's algorithm)
+    void buildAliasTable() {
+      const int numTris = triAreas.size();
+      aliasProbs.assign(numTris, 1.0f);
+      aliasIndices.resize(numTris);
+      std::iota(aliasIndices.begin(), aliasIndices.end(), 0);
+      const double totalArea =
+          std::accumulate(triAreas.begin(), triAreas.end(), 0.0);
+      if (numTris == 0 || totalArea <= 0.0) {
+        aliasProbs.clear();
+        return;
       }
-    } else if (invert) {
-      // all but a single island
-      islands.reserve(islandsToPolys_.size());
-      for (auto& itr : islandsToPolys_) {
-        if (itr.first != islandIndex) {
-          islands.push_back(itr.first);
-        }
+
+      std::vector<double> scaled(numTris);
+      std::vector<int> small, large;
+      for (int i = 0; i < numTris; ++i) {
+        scaled[i] = triAreas[i] * numTris / totalArea;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
       }
-    } else {
-      // a single island
-      islands.push_back(islandIndex);
-    }
-
-    // Pull this check and adjustment logic outside of the main loop
-    ushort (*op)(ushort, ushort) = nullptr;
-    op = setFlag ? orFlag : andFlag;
-    ushort modFlag = setFlag ? flag : ~flag;
-
-    // for each island
-    for (int island : islands) {
-      // for each poly
-      for (auto& polyRef : islandsToPolys_[island]) {
-        // get current flags
-        ushort f = 0;
-        navMesh->getPolyFlags(polyRef, &f);
-        // set the modified flags
-        navMesh->setPolyFlags(polyRef, op(f, modFlag));
+      while (!small.empty() && !large.empty()) {
+        const int s = small.back();
+        small.pop_back();
+        const int l = large.back();
+        large.pop_back();
+        aliasProbs[s] = scaled[s];
+        aliasIndices[s] = l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        (scaled[l] < 1.0 ? small : large).push_back(l);
       }
+      // whatever remains is 1 up to round-off and keeps its own column
     }
-  }
 
-  // Some polygons have zero area for some reason.  When we navigate into a zero
-  // area polygon, things crash.  So we find all zero area polygons and mark
-  // them as disabled/not navigable.
-  // Also compute the NavMesh areas for later query.
-  void removeZeroAreaPolys(dtNavMesh* navMesh);
+    vec3f sample(core::Random& rng, dtPolyRef* polyRef) const {
+      int tri = static_cast<int>(
+          rng.uniform_uint(static_cast<uint32_t>(aliasProbs.size())));
+      if (rng.uniform_float_01() >= aliasProbs[tri]) {
+        tri = aliasIndices[tri];
+      }
+      if (polyRef) {
+        *polyRef = triPolys[tri];
+      }
 
-  //! return the island for a navmesh polygon
-  inline int getPolyIsland(dtPolyRef polyRef) { return polyToIsland_[polyRef]; }
+      // uniform barycentric coordinates
+      const float r1 = std::sqrt(rng.uniform_float_01());
+      const float r2 = rng.uniform_float_01();
+      const vec3f* v = &triVerts[3 * static_cast<size_t>(tri)];
+      return (1.0f - r1) * v[0] + (r1 * (1.0f - r2)) * v[1] + (r1 * r2) * v[2];
+    }
+  };
 
- private:
+  //! The navmesh the island system was computed for. Not owned.
+  const dtNavMesh* navMesh_;
   //! map islands to area for quick query
-  std::unordered_map<uint32_t, float> islandsToArea_;
+  std::unordered_map<int, float> islandsToArea_;
   //! map islands to lists of polys for quick query and enumeration
   std::unordered_map<uint32_t, std::vector<dtPolyRef>> islandsToPolys_;
-  //! map polygons to their island for quick look-up
-  std::unordered_map<dtPolyRef, uint32_t> polyToIsland_;
+  //! offset of the first polygon of each tile in polyIsland_
+  std::vector<int> tilePolyBase_;
+  //! island of each polygon of the navmesh, flattened over all tiles
+  std::vector<int> polyIsland_;
   std::vector<float> islandRadius_;
+  //! map islands to their area sampler. ID_UNDEFINED samples the full NavMesh.
+  std::unordered_map<int, AreaSampler> islandSamplers_;
+
+  //! Lay out all polygons of all tiles in one flat table, none of them on an
+  //! island yet
+  void layoutPolys() {
+    tilePolyBase_.assign(navMesh_->getMaxTiles(), 0);
+    int numPolys = 0;
+    for (int iTile = 0; iTile < navMesh_->getMaxTiles(); ++iTile) {
+      const dtMeshTile* tile = navMesh_->getTile(iTile);
+      if (!tile || !tile->header)
+        continue;
+      tilePolyBase_[iTile] = numPolys;
+      numPolys += tile->header->polyCount;
+    }
+    polyIsland_.assign(numPolys, ID_UNDEFINED);
+  }
+
+  //! Disable the zero area polygons which aren't on an island yet, so they
+  //! are left out of the islands flood filled next
+  void disableUnassignedZeroAreaPolys(dtNavMesh* navMesh);
+
+  //! Flood fill all polygons which aren't on an island yet and pass
+  //! @p filter into new islands
+  void floodUnassignedPolys(const dtQueryFilter* filter) {
+    std::vector<vec3f> islandVerts;
+
+    // Iterate over all tiles
+    for (int iTile = 0; iTile < navMesh_->getMaxTiles(); ++iTile) {
+      const dtMeshTile* tile = navMesh_->getTile(iTile);
+      if (!tile || !tile->header)
+        continue;
+
+      // Iterate over all polygons in a tile
+      for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+        // Get the polygon reference from the tile and polygon id
+        dtPolyRef startRef = navMesh_->encodePolyId(tile->salt, iTile, jPoly);
+
+        // If the polygon ref is valid, walkable, and we haven't seen it yet,
+        // start connected component analysis from this polygon
+        if (navMesh_->isValidPolyRef(startRef) &&
+            (getPolyIsland(startRef) == ID_UNDEFINED) &&
+            filter->passFilter(startRef, tile, &tile->polys[jPoly])) {
+          uint32_t newIslandId = islandRadius_.size();
+          expandFrom(navMesh_, filter, newIslandId, startRef, islandVerts);
+
+          // The radius is calculated as the max deviation from the mean for all
+          // points in the island
+          vec3f centroid = vec3f::Zero();
+          for (auto& v : islandVerts) {
+            centroid += v;
+          }
+          centroid /= islandVerts.size();
+
+          float maxRadius = 0.0;
+          for (auto& v : islandVerts) {
+            maxRadius = std::max(maxRadius, (v - centroid).norm());
+          }
+
+          islandRadius_.emplace_back(maxRadius);
+        }
+      }
+    }
+  }
+
+  //! Compute the areas and samplers of the islands starting at
+  //! @p firstIsland, disabling their zero area polygons, then those of the
+  //! full NavMesh.
+  void computeIslandAreas(dtNavMesh* navMesh, int firstIsland);
 
   void expandFrom(const dtNavMesh* navMesh,
                   const dtQueryFilter* filter,
@@ -334,7 +564,7 @@ class IslandSystem {
                   const dtPolyRef& startRef,
                   std::vector<vec3f>& islandVerts) {
     islandsToPolys_[newIslandId].push_back(startRef);
-    polyToIsland_.emplace(startRef, newIslandId);
+    polyIsland_[polyIndex(startRef)] = newIslandId;
     islandVerts.clear();
 
     // Force std::stack to be implemented via an std::vector as linked
@@ -361,7 +591,9 @@ class IslandSystem {
            iLink = tile->links[iLink].next) {
         dtPolyRef neighbourRef = tile->links[iLink].ref;
         // If we've already visited this poly, skip it!
-        if (polyToIsland_.find(neighbourRef) != polyToIsland_.end())
+        const int neighbourIndex = polyIndex(neighbourRef);
+        if (neighbourIndex == ID_UNDEFINED ||
+            polyIsland_[neighbourIndex] != ID_UNDEFINED)
           continue;
 
         const dtMeshTile* neighbourTile = nullptr;
@@ -373,13 +605,305 @@ class IslandSystem {
         if (!filter->passFilter(neighbourRef, neighbourTile, neighbourPoly))
           continue;
 
-        polyToIsland_.emplace(neighbourRef, newIslandId);
+        polyIsland_[neighbourIndex] = newIslandId;
         islandsToPolys_[newIslandId].push_back(neighbourRef);
         stack.push(neighbourRef);
       }
     }
   }
 };
+
+/**
+ * @brief Query filter which additionally restricts queries to the polygons of
+ * a single island.
+ *
+ * Constructed per query on the stack, so island specific queries no longer
+ * need to modify the poly flags of the shared navmesh.
+ */
+class IslandQueryFilter : public dtQueryFilter {
+ public:
+  IslandQueryFilter(const dtQueryFilter& filter,
+                    const IslandSystem& islandSystem,
+                    int islandIndex)
+      : dtQueryFilter{filter},
+        islandSystem_{islandSystem},
+        islandIndex_{islandIndex} {}
+
+  bool passFilter(const dtPolyRef ref,
+                  const dtMeshTile* tile,
+                  const dtPoly* poly) const override {
+    return dtQueryFilter::passFilter(ref, tile, poly) &&
+           islandSystem_.getPolyIsland(ref) == islandIndex_;
+  }
+
+ private:
+  const IslandSystem& islandSystem_;
+  const int islandIndex_;
+};
+
+/**
+ * @brief Distances from a few landmark polygons to every polygon of the
+ * navmesh (ALT).
+ *
+ * By the triangle inequality |d(L, a) - d(L, b)| <= d(a, b) for every
+ * landmark L, so the table bounds the distance between any two polygons in
+ * O(numLandmarks). Distances are measured on the polygon graph, from polygon
+ * centers through the midpoints of shared edges. The bound holds for that
+ * graph distance only. It approximates the length of the straightened path
+ * but may exceed it, so it is not an admissible A* heuristic for
+ * @ref PathFinder::findPath and is only used to order work.
+ *
+ * Polygons are addressed by their @ref IslandSystem::polyIndex, so the index
+ * is only valid for the island system it was built with.
+ */
+class LandmarkIndex {
+ public:
+  /**
+   * @brief Select landmarks by farthest point sampling on the largest island
+   * and compute their distances to all polygons.
+   *
+   * Fewer landmarks are selected if the island runs out of distinct far away
+   * polygons.
+   */
+  LandmarkIndex(const dtNavMesh* navMesh,
+                const dtQueryFilter* filter,
+                const IslandSystem& islandSystem,
+                int numLandmarks);
+
+  //! Wrap previously computed distances, @p numLandmarks per polygon
+  LandmarkIndex(int numLandmarks, std::vector<float> distances)
+      : numLandmarks_{numLandmarks}, distances_{std::move(distances)} {}
+
+  int numLandmarks() const { return numLandmarks_; }
+
+  int numPolys() const { return distances_.size() / numLandmarks_; }
+
+  //! Distances of all polygons to all landmarks, polygon major
+  const std::vector<float>& distances() const { return distances_; }
+
+  /**
+   * @brief Lower bound of the polygon graph distance between two polygons.
+   *
+   * Only an estimate of the straightened path length, see the class
+   * documentation.
+   *
+   * @param[in] indexA, indexB Polygon indices from
+   * @ref IslandSystem::polyIndex.
+   *
+   * @return The bound, or 0 if neither polygon was reached from a landmark.
+   */
+  float estimate(int indexA, int indexB) const {
+    if (indexA == ID_UNDEFINED || indexB == ID_UNDEFINED)
+      return 0.0f;
+    const float* distA = &distances_[size_t(indexA) * numLandmarks_];
+    const float* distB = &distances_[size_t(indexB) * numLandmarks_];
+    float bound = 0.0f;
+    for (int k = 0; k < numLandmarks_; ++k) {
+      // both infinite if the landmark is on another island
+      if (std::isfinite(distA[k]) && std::isfinite(distB[k]))
+        bound = std::max(bound, std::abs(distA[k] - distB[k]));
+    }
+    return bound;
+  }
+
+ private:
+  int numLandmarks_;
+  std::vector<float> distances_;
+};
+
+LandmarkIndex::LandmarkIndex(const dtNavMesh* navMesh,
+                             const dtQueryFilter* filter,
+                             const IslandSystem& islandSystem,
+                             int numLandmarks)
+    : numLandmarks_{numLandmarks} {
+  const int numPolys = islandSystem.numPolys();
+  distances_.assign(size_t(numPolys) * numLandmarks_,
+                    std::numeric_limits<float>::infinity());
+
+  // Centers of all walkable polygons, 0 refs for the others
+  std::vector<dtPolyRef> refs(numPolys, 0);
+  std::vector<vec3f> centers(numPolys, vec3f::Zero());
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+    const dtPolyRef base = navMesh->getPolyRefBase(tile);
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPoly* poly = &tile->polys[jPoly];
+      const dtPolyRef ref = base | static_cast<dtPolyRef>(jPoly);
+      if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION ||
+          !filter->passFilter(ref, tile, poly))
+        continue;
+      const int index = islandSystem.polyIndex(ref);
+      refs[index] = ref;
+      for (int iVert = 0; iVert < poly->vertCount; ++iVert) {
+        centers[index] += Eigen::Map<const vec3f>(
+            &tile->verts[static_cast<size_t>(poly->verts[iVert]) * 3]);
+      }
+      centers[index] /= poly->vertCount;
+    }
+  }
+
+  // Polygon graph in compressed sparse row layout. Edges go from the center of
+  // a polygon through the midpoint of the shared edge to the neighbour center.
+  std::vector<int> edgeOffsets(numPolys + 1, 0);
+  std::vector<int> edgeTargets;
+  std::vector<float> edgeWeights;
+  for (int index = 0; index < numPolys; ++index) {
+    edgeOffsets[index] = edgeTargets.size();
+    if (refs[index] == 0)
+      continue;
+    const dtMeshTile* tile = nullptr;
+    const dtPoly* poly = nullptr;
+    navMesh->getTileAndPolyByRefUnsafe(refs[index], &tile, &poly);
+    for (unsigned int iLink = poly->firstLink; iLink != DT_NULL_LINK;
+         iLink = tile->links[iLink].next) {
+      const dtLink& link = tile->links[iLink];
+      const int neighbour = islandSystem.polyIndex(link.ref);
+      if (neighbour == ID_UNDEFINED || refs[neighbour] == 0)
+        continue;
+      vec3f left, right;
+      portalSegment(tile, poly, link, left, right);
+      const vec3f portal = 0.5f * (left + right);
+      edgeTargets.push_back(neighbour);
+      edgeWeights.push_back((portal - centers[index]).norm() +
+                            (centers[neighbour] - portal).norm());
+    }
+  }
+  edgeOffsets[numPolys] = edgeTargets.size();
+
+  std::vector<float> dist(numPolys);
+  const auto shortestDistances = [&](int source) {
+    std::fill(dist.begin(), dist.end(),
+              std::numeric_limits<float>::infinity());
+    using Entry = std::pair<float, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    dist[source] = 0.0f;
+    queue.emplace(0.0f, source);
+    while (!queue.empty()) {
+      const Entry top = queue.top();
+      queue.pop();
+      if (top.first > dist[top.second])
+        continue;
+      for (int e = edgeOffsets[top.second]; e < edgeOffsets[top.second + 1];
+           ++e) {
+        const float d = top.first + edgeWeights[e];
+        if (d < dist[edgeTargets[e]]) {
+          dist[edgeTargets[e]] = d;
+          queue.emplace(d, edgeTargets[e]);
+        }
+      }
+    }
+  };
+  // Reached polygon farthest from all landmarks so far, ID_UNDEFINED if all
+  // of them coincide with a landmark
+  const auto farthest = [numPolys](const std::vector<float>& d) {
+    int best = ID_UNDEFINED;
+    float bestDist = 0.0f;
+    for (int index = 0; index < numPolys; ++index) {
+      if (std::isfinite(d[index]) && d[index] > bestDist) {
+        best = index;
+        bestDist = d[index];
+      }
+    }
+    return best;
+  };
+
+  // Start from a polygon of the largest island, the first landmark is the
+  // polygon farthest from it
+  int seed = ID_UNDEFINED;
+  float seedIslandArea = 0.0f;
+  for (int index = 0; index < numPolys; ++index) {
+    const int island = islandSystem.getPolyIsland(refs[index]);
+    if (island != ID_UNDEFINED &&
+        islandSystem.getNavigableArea(island) > seedIslandArea) {
+      seed = index;
+      seedIslandArea = islandSystem.getNavigableArea(island);
+    }
+  }
+  if (seed == ID_UNDEFINED)
+    return;
+  shortestDistances(seed);
+  int landmark = farthest(dist);
+
+  std::vector<float> minDist(numPolys, std::numeric_limits<float>::infinity());
+  for (int k = 0; k < numLandmarks_ && landmark != ID_UNDEFINED; ++k) {
+    shortestDistances(landmark);
+    for (int index = 0; index < numPolys; ++index) {
+      distances_[size_t(index) * numLandmarks_ + k] = dist[index];
+      minDist[index] = std::min(minDist[index], dist[index]);
+    }
+    landmark = farthest(minDist);
+  }
+}
+
+/**
+ * @brief Distance to the closest obstacle sampled on a regular xz grid over
+ * each navmesh polygon.
+ *
+ * The grids are per polygon so overlapping floors never share samples. Grid
+ * nodes outside a polygon sample the closest point of the polygon. The
+ * distance to the closest obstacle changes by at most the distance moved, so
+ * bilinear interpolation between samples is off by at most
+ * @f$ \sqrt{2} @f$ times the grid spacing.
+ */
+class ClearanceField {
+ public:
+  //! Layout of the samples of a polygon
+  struct PolyGrid {
+    float originX = 0.0f;
+    float originZ = 0.0f;
+    //! Number of samples along x and z, 0 for polygons without samples
+    int cols = 0;
+    int rows = 0;
+    //! Index of the first sample of the polygon in the sample array
+    size_t offset = 0;
+  };
+
+  ClearanceField(float spacing, float maxRadius)
+      : spacing_{spacing}, maxRadius_{maxRadius} {}
+
+  float spacing() const { return spacing_; }
+
+  //! Largest search radius the samples were computed with
+  float maxRadius() const { return maxRadius_; }
+
+  std::vector<PolyGrid>& grids() { return grids_; }
+
+  std::vector<float>& samples() { return samples_; }
+
+  /**
+   * @brief Interpolated distance to the closest obstacle at a point on a
+   * polygon.
+   *
+   * @param[in] polyIndex Polygon index from @ref IslandSystem::polyIndex.
+   *
+   * @return The distance, or NAN if the polygon has no samples.
+   */
+  float lookup(int polyIndex, const vec3f& pt) const {
+    if (polyIndex == ID_UNDEFINED || grids_[polyIndex].cols == 0)
+      return Mn::Constants::nan();
+    const PolyGrid& grid = grids_[polyIndex];
+    const float fx = Mn::Math::clamp((pt[0] - grid.originX) / spacing_, 0.0f,
+                                     float(grid.cols - 1));
+    const float fz = Mn::Math::clamp((pt[2] - grid.originZ) / spacing_, 0.0f,
+                                     float(grid.rows - 1));
+    const int col = std::min(int(fx), grid.cols - 2);
+    const int row = std::min(int(fz), grid.rows - 2);
+    const float tx = fx - col;
+    const float tz = fz - row;
+    const float* s = &samples_[grid.offset + size_t(row) * grid.cols + col];
+    return Mn::Math::lerp(Mn::Math::lerp(s[0], s[1], tx),
+                          Mn::Math::lerp(s[grid.cols], s[grid.cols + 1], tx),
+                          tz);
+  }
+
+ private:
+  float spacing_;
+  float maxRadius_;
+  std::vector<PolyGrid> grids_;
+  std::vector<float> samples_;
+};
 }  // namespace impl
 
 struct PathFinder::Impl {
@@ -395,29 +919,98 @@ struct PathFinder::Impl {
              const float* bmax);
   bool build(const NavMeshSettings& bs, const esp::assets::MeshData& mesh);
 
+  bool rebuildRegions(const esp::assets::MeshData& mesh,
+                      const std::vector<std::pair<vec3f, vec3f>>& regions);
+
   vec3f getRandomNavigablePoint(int maxTries,
-                                int islandIndex /*= ID_UNDEFINED*/);
+                                int islandIndex /*= ID_UNDEFINED*/) {
+    return getRandomNavigablePoint(random_, maxTries, islandIndex);
+  }
+  vec3f getRandomNavigablePoint(core::Random& rng,
+                                int maxTries,
+                                int islandIndex /*= ID_UNDEFINED*/) const;
+  std::vector<vec3f> getRandomNavigablePoints(int numPoints,
+                                              int islandIndex) {
+    return getRandomNavigablePoints(random_, numPoints, islandIndex);
+  }
+  std::vector<vec3f> getRandomNavigablePoints(
+      core::Random& rng,
+      int numPoints,
+      int islandIndex /*= ID_UNDEFINED*/) const;
   vec3f getRandomNavigablePointAroundSphere(const vec3f& circleCenter,
                                             float radius,
                                             int maxTries,
-                                            int islandIndex /*= ID_UNDEFINED*/);
+                                            int islandIndex) {
+    return getRandomNavigablePointAroundSphere(random_, circleCenter, radius,
+                                               maxTries, islandIndex);
+  }
+  vec3f getRandomNavigablePointAroundSphere(
+      core::Random& rng,
+      const vec3f& circleCenter,
+      float radius,
+      int maxTries,
+      int islandIndex /*= ID_UNDEFINED*/) const;
 
-  bool findPath(ShortestPath& path);
-  bool findPath(MultiGoalShortestPath& path);
+  bool findPath(ShortestPath& path) const;
+  bool findPath(MultiGoalShortestPath& path) const;
+
+  int findPaths(Cr::Containers::ArrayView<const vec3f> starts,
+                Cr::Containers::ArrayView<const vec3f> ends,
+                Cr::Containers::ArrayView<float> distances,
+                std::vector<std::vector<vec3f>>* points,
+                int numThreads) const;
+
+  float distanceToGoals(GoalDistanceField& field, const vec3f& pt) const;
 
   template <typename T>
-  T tryStep(const T& start, const T& end, bool allowSliding);
+  T tryStep(const T& start, const T& end, bool allowSliding) const;
+
+  NavLocation tryStep(const NavLocation& start,
+                      const vec3f& end,
+                      bool allowSliding) const;
+
+  NavLocation locate(const vec3f& pt, const NavLocation& hint) const;
+
+  bool findPath(const NavLocation& start,
+                const NavLocation& end,
+                ShortestPath& path) const;
+
+  int getIsland(const NavLocation& location) const;
+
+  float distanceToClosestObstacle(const NavLocation& location,
+                                  float maxSearchRadius) const;
+
+  void trySteps(Cr::Containers::ArrayView<const vec3f> starts,
+                Cr::Containers::ArrayView<const vec3f> ends,
+                Cr::Containers::ArrayView<vec3f> results,
+                Cr::Containers::ArrayView<std::uint64_t> polyRefs,
+                bool allowSliding,
+                int numThreads) const;
 
   template <typename T>
-  T snapPoint(const T& pt, int islandIndex = ID_UNDEFINED);
+  T snapPoint(const T& pt, int islandIndex = ID_UNDEFINED) const;
 
   template <typename T>
   int getIsland(const T& pt) const;
 
-  bool loadNavMesh(const std::string& path);
+  bool loadNavMesh(const std::string& path, bool memoryMap);
 
   bool saveNavMesh(const std::string& path);
 
+  bool buildLandmarkIndex(int numLandmarks);
+
+  bool hasLandmarkIndex() const { return landmarkIndex_ != nullptr; }
+
+  bool loadLandmarkIndex(const std::string& path);
+
+  bool saveLandmarkIndex(const std::string& path) const;
+
+  float estimateGeodesicDistance(const vec3f& start, const vec3f& end) const;
+
+  bool buildClearanceField(float tolerance, float maxSearchRadius);
+
+  bool hasClearanceField() const { return clearanceField_ != nullptr; }
+
   bool isLoaded() const { return navMesh_ != nullptr; };
 
   float getNavigableArea(int islandIndex /*= ID_UNDEFINED*/) const {
@@ -461,31 +1054,180 @@ struct PathFinder::Impl {
     void operator()(dtNavMeshQuery* query) { dtFreeNavMeshQuery(query); }
   };
 
+  //! A .navmesh file mapped copy-on-write into memory. The pages Detour never
+  //! writes to stay shared with every other process mapping the same file.
+  struct MappedFile {
+    unsigned char* data = nullptr;
+    size_t size = 0;
+
+    ~MappedFile() {
+#ifndef _WIN32
+      if (data) {
+        munmap(data, size);
+      }
+#endif
+    }
+  };
+
+  //! Detour query object and scratch buffers of a single thread. Reused
+  //! between queries to avoid per-call allocations.
+  struct QueryWorkspace {
+    std::unique_ptr<dtNavMeshQuery, NavQueryDeleter> navQuery = nullptr;
+    //! Polygon corridor found by A*
+    dtPolyRef polys[MAX_POLYS]{};
+    //! Straight path points, valid up to numPoints
+    std::vector<vec3f> points = std::vector<vec3f>(MAX_POLYS);
+    int numPoints = 0;
+  };
+
+  //! Backs the tiles of a memory mapped navmesh, so declared before navMesh_
+  //! to outlive it
+  std::unique_ptr<MappedFile> navMeshFile_ = nullptr;
   std::unique_ptr<dtNavMesh, NavMeshDeleter> navMesh_ = nullptr;
-  std::unique_ptr<dtNavMeshQuery, NavQueryDeleter> navQuery_ = nullptr;
   std::unique_ptr<dtQueryFilter> filter_ = nullptr;
   std::unique_ptr<impl::IslandSystem> islandSystem_ = nullptr;
+  //! Landmark distances for the current navmesh and island system, if built
+  //! or loaded. Reset whenever either changes.
+  std::unique_ptr<impl::LandmarkIndex> landmarkIndex_ = nullptr;
+  //! Sampled distances to the closest obstacle, if built. Reset whenever the
+  //! navmesh changes.
+  std::unique_ptr<impl::ClearanceField> clearanceField_ = nullptr;
+
+  //! Query workspaces of every thread which queried the current navmesh,
+  //! created on first use. Reset in initNavQuery. Only looked up under the
+  //! mutex on the first query of a thread after the generation changes.
+  mutable std::unordered_map<std::thread::id, std::unique_ptr<QueryWorkspace>>
+      workspaces_;
+  mutable std::mutex workspacesMutex_;
+
+  //! Random generator for point sampling queries which aren't passed one.
+  core::Random random_;
 
   //! Holds triangulated geom/topo. Generated when queried. Reset with
-  //! navQuery_.
+  //! the query workspaces.
   std::unordered_map<int, assets::MeshData::ptr> islandMeshData_;
   Cr::Containers::Optional<NavMeshSettings> navMeshSettings_;
 
   std::pair<vec3f, vec3f> bounds_;
 
+  //! Changes whenever the navmesh changes, to detect stale goal distance
+  //! fields and locations. 0 until a navmesh is built or loaded.
+  int navMeshGeneration_ = 0;
+
   bool initNavQuery();
 
-  Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>>
-  findPathInternal(const vec3f& start,
-                   dtPolyRef startRef,
-                   const vec3f& pathStart,
-                   const vec3f& end,
-                   dtPolyRef endRef,
-                   const vec3f& pathEnd);
+  bool loadNavMeshMapped(const std::string& path);
+
+  /**
+   * @brief Get the query workspace of the calling thread, creating it if
+   * needed.
+   */
+  QueryWorkspace& getWorkspace() const;
+
+  /**
+   * @brief Get the query filter for a query optionally restricted to an
+   * island.
+   *
+   * @param[in] islandFilter Storage for the island filter, only used if
+   * @p islandIndex is not ID_UNDEFINED.
+   */
+  const dtQueryFilter* getFilter(
+      int islandIndex,
+      Cr::Containers::Optional<impl::IslandQueryFilter>& islandFilter) const;
+
+  /**
+   * @brief Finds the path between two points already projected to the navmesh
+   * using the query and scratch buffers of @p ws.
+   *
+   * @return The path length, or NullOpt if there is no path. On success the
+   * path points are left in `ws.points[0, ws.numPoints)`.
+   */
+  Cr::Containers::Optional<float> findPathInternal(QueryWorkspace& ws,
+                                                   const vec3f& start,
+                                                   dtPolyRef startRef,
+                                                   const vec3f& pathStart,
+                                                   const vec3f& end,
+                                                   dtPolyRef endRef,
+                                                   const vec3f& pathEnd) const;
 
   bool findPathSetup(MultiGoalShortestPath& path,
                      dtPolyRef& startRef,
-                     vec3f& pathStart);
+                     vec3f& pathStart) const;
+
+  /**
+   * @brief Whether @p pt is over polygon @p ref of the current navmesh and
+   * within climb height of it.
+   *
+   * Rejects refs whose tile was replaced or whose polygon isn't on an
+   * island, so refs kept from before the navmesh changed are safe to pass.
+   *
+   * @param[out] closest Set to the point of the polygon closest to @p pt.
+   */
+  bool isOverPoly(dtPolyRef ref,
+                  const vec3f& pt,
+                  const dtNavMeshQuery* navQuery,
+                  vec3f& closest) const;
+
+  /**
+   * @brief Same as projectToPoly() but keeps the polygon of @p hint while
+   * @p pt is over it and within climb height, which is what Detour's nearest
+   * polygon query would prefer as well.
+   *
+   * Falls back to projecting @p pt if the hint is for another navmesh or its
+   * polygon doesn't contain @p pt anymore.
+   */
+  std::tuple<dtStatus, dtPolyRef, vec3f> projectToPolyNear(
+      const vec3f& pt,
+      const NavLocation& hint,
+      const dtNavMeshQuery* navQuery) const;
+
+  //! Closest obstacle to a point already projected to polygon @p ref
+  HitRecord closestObstacleSurfacePoint(dtNavMeshQuery* navQuery,
+                                        dtPolyRef ref,
+                                        const vec3f& polyPt,
+                                        float maxSearchRadius) const;
+
+  /**
+   * @brief Implementation of @ref tryStep using the query and scratch buffers
+   * of @p ws.
+   *
+   * @param[in] startRef The polygon containing @p start if known, which skips
+   * projecting it, or 0. Projected anyway if @ref isOverPoly rejects it.
+   * @param[out] endPolyRef If not null, set to the polygon containing the
+   * returned point, or 0 if the start point isn't on the navmesh.
+   */
+  template <typename T>
+  T tryStepInternal(QueryWorkspace& ws,
+                    const T& start,
+                    dtPolyRef startRef,
+                    const T& end,
+                    bool allowSliding,
+                    dtPolyRef* endPolyRef) const;
+
+  /**
+   * @brief Computes the distances of all polygons to the goals of @p field
+   * with a multi-source Dijkstra search over the polygon graph.
+   *
+   * Polygons are entered at the point of the shared edge closest to the point
+   * the previous polygon was entered at, so each distance is the length of a
+   * valid path and at least the geodesic distance.
+   */
+  void computeGoalDistanceField(GoalDistanceField& field) const;
+
+  /**
+   * @brief Polygon each pixel of a top-down view is navigable on according to
+   * @ref isNavigable, 0 where it isn't, row major.
+   *
+   * Scan converts the navmesh polygons into the pixel grid instead of
+   * projecting every pixel. Only pixels close to the boundary of a polygon or
+   * where Detour's choice of the nearest polygon isn't obvious fall back to
+   * the Detour query, so the result matches the per pixel queries.
+   */
+  std::vector<dtPolyRef> rasterizeTopDownView(float metersPerPixel,
+                                              float height,
+                                              float eps,
+                                              int& xResolution,
+                                              int& zResolution) const;
 };
 
 namespace {
@@ -513,33 +1255,11 @@ enum PolyFlags {
   POLYFLAGS_WALK = 0x01,      // walkable
   POLYFLAGS_DOOR = 0x02,      // ability to move through doors
   POLYFLAGS_DISABLED = 0x04,  // disabled polygon
-  POLYFLAGS_OFF_ISLAND =
-      0x08,               // dynamically set to filter all but a specific island
-  POLYFLAGS_ALL = 0xffff  // all abilities
+  POLYFLAGS_ALL = 0xffff      // all abilities
 };
-}  // namespace
 
-PathFinder::Impl::Impl() {
-  filter_ = std::make_unique<dtQueryFilter>();
-  filter_->setIncludeFlags(POLYFLAGS_WALK);
-  filter_->setExcludeFlags(0);
-}
-
-bool PathFinder::Impl::build(const NavMeshSettings& bs,
-                             const float* verts,
-                             const int nverts,
-                             const int* tris,
-                             const int ntris,
-                             const float* bmin,
-                             const float* bmax) {
-  Workspace ws;
-  rcContext ctx;
-
-  //
-  // Step 1. Initialize build config.
-  //
-
-  // Init build configuration from GUI
+//! Recast configuration for @p bs, without the bounds of the build
+rcConfig makeRecastConfig(const NavMeshSettings& bs) {
   rcConfig cfg{};
   memset(&cfg, 0, sizeof(cfg));
   cfg.cs = bs.cellSize;
@@ -558,15 +1278,69 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
   cfg.detailSampleDist =
       bs.detailSampleDist < 0.9f ? 0 : bs.cellSize * bs.detailSampleDist;
   cfg.detailSampleMaxError = bs.cellHeight * bs.detailSampleMaxError;
+  return cfg;
+}
 
-  // Set the area where the navigation will be build.
-  // Here the bounds of the input mesh are used, but the
-  // area could be specified by an user defined box, etc.
-  rcVcopy(cfg.bmin, bmin);
-  rcVcopy(cfg.bmax, bmax);
-  rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
-  ESP_DEBUG() << "Building navmesh with" << cfg.width << "x" << cfg.height
-              << "cells";
+//! Padding of the tile heightfields in cells, so that polygons of neighbouring
+//! tiles line up
+int tileBorderSize(const rcConfig& cfg) {
+  return cfg.walkableRadius + 3;
+}
+
+/**
+ * @brief Recast configuration of a single tile of a tiled build.
+ *
+ * @param[in] cfg Configuration of the full build, with its bounds set.
+ */
+rcConfig makeTileConfig(const rcConfig& cfg,
+                        const int tileSize,
+                        const int tileX,
+                        const int tileZ) {
+  rcConfig tileCfg = cfg;
+  tileCfg.tileSize = tileSize;
+  tileCfg.borderSize = tileBorderSize(cfg);
+  tileCfg.width = tileSize + 2 * tileCfg.borderSize;
+  tileCfg.height = tileSize + 2 * tileCfg.borderSize;
+
+  const float tileWorldSize = tileSize * cfg.cs;
+  const float borderWorldSize = tileCfg.borderSize * cfg.cs;
+  tileCfg.bmin[0] = cfg.bmin[0] + tileX * tileWorldSize - borderWorldSize;
+  tileCfg.bmin[2] = cfg.bmin[2] + tileZ * tileWorldSize - borderWorldSize;
+  tileCfg.bmax[0] = cfg.bmin[0] + (tileX + 1) * tileWorldSize + borderWorldSize;
+  tileCfg.bmax[2] = cfg.bmin[2] + (tileZ + 1) * tileWorldSize + borderWorldSize;
+  return tileCfg;
+}
+
+//! Detour data of a single navmesh tile
+struct TileData {
+  //! Allocated with dtAlloc, null if the tile has no polygons
+  unsigned char* data = nullptr;
+  int dataSize = 0;
+  int numVerts = 0;
+  int numPolys = 0;
+};
+
+/**
+ * @brief Runs the Recast pipeline over the bounds of @p cfg and converts the
+ * resulting poly mesh to Detour navmesh data.
+ *
+ * Only uses its arguments, so several tiles can be built concurrently.
+ *
+ * @param[out] tileData The Detour data of the tile. Left empty if the tile has
+ * no walkable area.
+ * @return false if any step of the pipeline failed.
+ */
+bool buildTileData(rcContext& ctx,
+                   const NavMeshSettings& bs,
+                   const rcConfig& cfg,
+                   const float* verts,
+                   const int nverts,
+                   const int* tris,
+                   const int ntris,
+                   const int tileX,
+                   const int tileZ,
+                   TileData& tileData) {
+  Workspace ws;
 
   //
   // Step 2. Rasterize input polygon soup.
@@ -690,7 +1464,7 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
     return false;
   }
   // Partition the walkable surface into simple regions without holes.
-  if (!rcBuildRegions(&ctx, *ws.chf, 0, cfg.minRegionArea,
+  if (!rcBuildRegions(&ctx, *ws.chf, cfg.borderSize, cfg.minRegionArea,
                       cfg.mergeRegionArea)) {
     ESP_ERROR() << "Could not build watershed regions";
     return false;
@@ -755,106 +1529,342 @@ bool PathFinder::Impl::build(const NavMeshSettings& bs,
   // access the data.
 
   //
-  // (Optional) Step 8. Create Detour data from Recast poly mesh.
+  // Step 8. Create Detour data from Recast poly mesh.
   //
 
-  // The GUI may allow more max points per polygon than Detour can handle.
-  // Only build the detour navmesh if we do not exceed the limit.
-  if (cfg.maxVertsPerPoly <= DT_VERTS_PER_POLYGON) {
-    unsigned char* navData = nullptr;
-    int navDataSize = 0;
-
-    // Update poly flags from areas.
-    for (int i = 0; i < ws.pmesh->npolys; ++i) {
-      if (ws.pmesh->areas[i] == RC_WALKABLE_AREA) {
-        ws.pmesh->areas[i] = POLYAREA_GROUND;
-      }
-      if (ws.pmesh->areas[i] == POLYAREA_GROUND) {
-        ws.pmesh->flags[i] = POLYFLAGS_WALK;
-      } else if (ws.pmesh->areas[i] == POLYAREA_DOOR) {
-        ws.pmesh->flags[i] = POLYFLAGS_WALK | POLYFLAGS_DOOR;
+  // Nothing walkable in this tile
+  if (ws.pmesh->nverts == 0 || ws.pmesh->npolys == 0) {
+    return true;
+  }
+
+  // Update poly flags from areas.
+  for (int i = 0; i < ws.pmesh->npolys; ++i) {
+    if (ws.pmesh->areas[i] == RC_WALKABLE_AREA) {
+      ws.pmesh->areas[i] = POLYAREA_GROUND;
+    }
+    if (ws.pmesh->areas[i] == POLYAREA_GROUND) {
+      ws.pmesh->flags[i] = POLYFLAGS_WALK;
+    } else if (ws.pmesh->areas[i] == POLYAREA_DOOR) {
+      ws.pmesh->flags[i] = POLYFLAGS_WALK | POLYFLAGS_DOOR;
+    }
+  }
+
+  dtNavMeshCreateParams params{};
+  memset(&params, 0, sizeof(params));
+  params.verts = ws.pmesh->verts;
+  params.vertCount = ws.pmesh->nverts;
+  params.polys = ws.pmesh->polys;
+  params.polyAreas = ws.pmesh->areas;
+  params.polyFlags = ws.pmesh->flags;
+  params.polyCount = ws.pmesh->npolys;
+  params.nvp = ws.pmesh->nvp;
+  params.detailMeshes = ws.dmesh->meshes;
+  params.detailVerts = ws.dmesh->verts;
+  params.detailVertsCount = ws.dmesh->nverts;
+  params.detailTris = ws.dmesh->tris;
+  params.detailTriCount = ws.dmesh->ntris;
+  // params.offMeshConVerts = geom->getOffMeshConnectionVerts();
+  // params.offMeshConRad = geom->getOffMeshConnectionRads();
+  // params.offMeshConDir = geom->getOffMeshConnectionDirs();
+  // params.offMeshConAreas = geom->getOffMeshConnectionAreas();
+  // params.offMeshConFlags = geom->getOffMeshConnectionFlags();
+  // params.offMeshConUserID = geom->getOffMeshConnectionId();
+  // params.offMeshConCount = geom->getOffMeshConnectionCount();
+  params.walkableHeight = bs.agentHeight;
+  params.walkableRadius = bs.agentRadius;
+  params.walkableClimb = bs.agentMaxClimb;
+  params.tileX = tileX;
+  params.tileY = tileZ;
+  params.tileLayer = 0;
+  rcVcopy(params.bmin, ws.pmesh->bmin);
+  rcVcopy(params.bmax, ws.pmesh->bmax);
+  params.cs = cfg.cs;
+  params.ch = cfg.ch;
+  params.buildBvTree = true;
+
+  if (!dtCreateNavMeshData(&params, &tileData.data, &tileData.dataSize)) {
+    ESP_ERROR() << "Could not build Detour navmesh";
+    return false;
+  }
+  tileData.numVerts = ws.pmesh->nverts;
+  tileData.numPolys = ws.pmesh->npolys;
+  return true;
+}
+
+//! Index of the tile containing world coordinate @p coord along one axis of
+//! the tile grid, clamped to the grid
+int worldToTile(const float coord,
+                const float orig,
+                const float tileWorldSize,
+                const int numTiles) {
+  const int tile = static_cast<int>(floorf((coord - orig) / tileWorldSize));
+  return std::min(std::max(tile, 0), numTiles - 1);
+}
+
+/**
+ * @brief Bucket triangles into every tile their XZ bounds overlap, including
+ * the tile borders.
+ *
+ * @return The vertex indices of the triangles of each tile, tiles in row-major
+ * order.
+ */
+std::vector<std::vector<int>> bucketTrianglesByTile(const rcConfig& cfg,
+                                                    const int tileSize,
+                                                    const int tilesX,
+                                                    const int tilesZ,
+                                                    const float* verts,
+                                                    const int* tris,
+                                                    const int ntris) {
+  const float tileWorldSize = tileSize * cfg.cs;
+  const float borderWorldSize = tileBorderSize(cfg) * cfg.cs;
+  std::vector<std::vector<int>> tileTris(tilesX * tilesZ);
+  for (int i = 0; i < ntris; ++i) {
+    const int* tri = &tris[3 * i];
+    float triMin[2] = {verts[3 * tri[0]], verts[3 * tri[0] + 2]};
+    float triMax[2] = {triMin[0], triMin[1]};
+    for (int j = 1; j < 3; ++j) {
+      const float* v = &verts[3 * tri[j]];
+      triMin[0] = std::min(triMin[0], v[0]);
+      triMin[1] = std::min(triMin[1], v[2]);
+      triMax[0] = std::max(triMax[0], v[0]);
+      triMax[1] = std::max(triMax[1], v[2]);
+    }
+    const int x0 = worldToTile(triMin[0] - borderWorldSize, cfg.bmin[0],
+                               tileWorldSize, tilesX);
+    const int x1 = worldToTile(triMax[0] + borderWorldSize, cfg.bmin[0],
+                               tileWorldSize, tilesX);
+    const int z0 = worldToTile(triMin[1] - borderWorldSize, cfg.bmin[2],
+                               tileWorldSize, tilesZ);
+    const int z1 = worldToTile(triMax[1] + borderWorldSize, cfg.bmin[2],
+                               tileWorldSize, tilesZ);
+    for (int z = z0; z <= z1; ++z) {
+      for (int x = x0; x <= x1; ++x) {
+        std::vector<int>& bucket = tileTris[z * tilesX + x];
+        bucket.insert(bucket.end(), tri, tri + 3);
       }
     }
+  }
+  return tileTris;
+}
+
+/**
+ * @brief Runs the Recast pipeline of several tiles concurrently.
+ *
+ * @param[in] tileTris Triangles of each tile from @ref bucketTrianglesByTile.
+ * @param[in] tileIndices Row-major indices of the tiles to build.
+ * @param[out] tiles The Detour data of each tile in @p tileIndices.
+ * @return false if any tile failed to build, in which case no data is
+ * returned.
+ */
+bool buildTiles(const NavMeshSettings& bs,
+                const rcConfig& cfg,
+                const int tileSize,
+                const int tilesX,
+                const float* verts,
+                const int nverts,
+                const std::vector<std::vector<int>>& tileTris,
+                const std::vector<int>& tileIndices,
+                std::vector<TileData>& tiles) {
+  tiles.assign(tileIndices.size(), TileData{});
+  const int numTiles = tileIndices.size();
+  int numFailed = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+ : numFailed)
+  for (int i = 0; i < numTiles; ++i) {
+    const std::vector<int>& tris = tileTris[tileIndices[i]];
+    if (tris.empty()) {
+      continue;
+    }
+    const int tileX = tileIndices[i] % tilesX;
+    const int tileZ = tileIndices[i] / tilesX;
+    rcContext ctx;
+    if (!buildTileData(ctx, bs, makeTileConfig(cfg, tileSize, tileX, tileZ),
+                       verts, nverts, tris.data(),
+                       static_cast<int>(tris.size() / 3), tileX, tileZ,
+                       tiles[i])) {
+      ++numFailed;
+    }
+  }
 
-    dtNavMeshCreateParams params{};
-    memset(&params, 0, sizeof(params));
-    params.verts = ws.pmesh->verts;
-    params.vertCount = ws.pmesh->nverts;
-    params.polys = ws.pmesh->polys;
-    params.polyAreas = ws.pmesh->areas;
-    params.polyFlags = ws.pmesh->flags;
-    params.polyCount = ws.pmesh->npolys;
-    params.nvp = ws.pmesh->nvp;
-    params.detailMeshes = ws.dmesh->meshes;
-    params.detailVerts = ws.dmesh->verts;
-    params.detailVertsCount = ws.dmesh->nverts;
-    params.detailTris = ws.dmesh->tris;
-    params.detailTriCount = ws.dmesh->ntris;
-    // params.offMeshConVerts = geom->getOffMeshConnectionVerts();
-    // params.offMeshConRad = geom->getOffMeshConnectionRads();
-    // params.offMeshConDir = geom->getOffMeshConnectionDirs();
-    // params.offMeshConAreas = geom->getOffMeshConnectionAreas();
-    // params.offMeshConFlags = geom->getOffMeshConnectionFlags();
-    // params.offMeshConUserID = geom->getOffMeshConnectionId();
-    // params.offMeshConCount = geom->getOffMeshConnectionCount();
-    params.walkableHeight = bs.agentHeight;
-    params.walkableRadius = bs.agentRadius;
-    params.walkableClimb = bs.agentMaxClimb;
-    rcVcopy(params.bmin, ws.pmesh->bmin);
-    rcVcopy(params.bmax, ws.pmesh->bmax);
-    params.cs = cfg.cs;
-    params.ch = cfg.ch;
-    params.buildBvTree = true;
-
-    if (!dtCreateNavMeshData(&params, &navData, &navDataSize)) {
+  if (numFailed > 0) {
+    for (TileData& tileData : tiles) {
+      dtFree(tileData.data);
+    }
+    tiles.clear();
+    return false;
+  }
+  return true;
+}
+}  // namespace
+
+PathFinder::Impl::Impl() {
+  filter_ = std::make_unique<dtQueryFilter>();
+  filter_->setIncludeFlags(POLYFLAGS_WALK);
+  filter_->setExcludeFlags(0);
+}
+
+bool PathFinder::Impl::build(const NavMeshSettings& bs,
+                             const float* verts,
+                             const int nverts,
+                             const int* tris,
+                             const int ntris,
+                             const float* bmin,
+                             const float* bmax) {
+  //
+  // Step 1. Initialize build config.
+  //
+
+  // Init build configuration from GUI
+  rcConfig cfg = makeRecastConfig(bs);
+
+  // The GUI may allow more max points per polygon than Detour can handle.
+  // Only build the detour navmesh if we do not exceed the limit.
+  if (cfg.maxVertsPerPoly > DT_VERTS_PER_POLYGON) {
+    ESP_ERROR() << "cfg.maxVertsPerPoly(" << cfg.maxVertsPerPoly
+                << ") > DT_VERTS_PER_POLYGON(" << DT_VERTS_PER_POLYGON
+                << "), so cannot build the Detour NavMesh. Aborting NavMesh "
+                   "construction.";
+    return false;
+  }
+
+  // Set the area where the navigation will be build.
+  // Here the bounds of the input mesh are used, but the
+  // area could be specified by an user defined box, etc.
+  rcVcopy(cfg.bmin, bmin);
+  rcVcopy(cfg.bmax, bmax);
+  rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
+  ESP_DEBUG() << "Building navmesh with" << cfg.width << "x" << cfg.height
+              << "cells";
+
+  std::unique_ptr<dtNavMesh, NavMeshDeleter> navMesh{dtAllocNavMesh()};
+  if (!navMesh) {
+    ESP_ERROR() << "Could not allocate Detour navmesh";
+    return false;
+  }
+
+  int numVerts = 0;
+  int numPolys = 0;
+  if (bs.tileSize <= 0) {
+    rcContext ctx;
+    TileData tileData;
+    if (!buildTileData(ctx, bs, cfg, verts, nverts, tris, ntris, 0, 0,
+                       tileData)) {
+      return false;
+    }
+    if (!tileData.data) {
       ESP_ERROR() << "Could not build Detour navmesh";
       return false;
     }
 
-    navMesh_.reset(dtAllocNavMesh());
-    if (!navMesh_) {
-      dtFree(navData);
-      ESP_ERROR() << "Could not allocate Detour navmesh";
+    dtStatus status =
+        navMesh->init(tileData.data, tileData.dataSize, DT_TILE_FREE_DATA);
+    if (dtStatusFailed(status)) {
+      dtFree(tileData.data);
+      ESP_ERROR() << "Could not init Detour navmesh";
+      return false;
+    }
+    numVerts = tileData.numVerts;
+    numPolys = tileData.numPolys;
+  } else {
+    const int tileSize = bs.tileSize;
+    const int tilesX = (cfg.width + tileSize - 1) / tileSize;
+    const int tilesZ = (cfg.height + tileSize - 1) / tileSize;
+    const int numTiles = tilesX * tilesZ;
+    ESP_DEBUG() << "Partitioning navmesh into" << tilesX << "x" << tilesZ
+                << "tiles";
+
+    // Tile and polygon ids share the bits of a dtPolyRef with the salt
+    const int tileBits = dtIlog2(dtNextPow2(numTiles));
+    if (tileBits > 14) {
+      ESP_ERROR() << "Too many navmesh tiles (" << numTiles
+                  << "), increase NavMeshSettings::tileSize";
       return false;
     }
 
-    dtStatus status = 0;
-    status = navMesh_->init(navData, navDataSize, DT_TILE_FREE_DATA);
+    dtNavMeshParams params{};
+    rcVcopy(params.orig, cfg.bmin);
+    params.tileWidth = tileSize * cfg.cs;
+    params.tileHeight = tileSize * cfg.cs;
+    params.maxTiles = 1 << tileBits;
+    params.maxPolys = 1 << (22 - tileBits);
+    dtStatus status = navMesh->init(&params);
     if (dtStatusFailed(status)) {
-      dtFree(navData);
       ESP_ERROR() << "Could not init Detour navmesh";
       return false;
     }
-    if (!initNavQuery()) {
+
+    const std::vector<std::vector<int>> tileTris = bucketTrianglesByTile(
+        cfg, tileSize, tilesX, tilesZ, verts, tris, ntris);
+    std::vector<int> tileIndices(numTiles);
+    std::iota(tileIndices.begin(), tileIndices.end(), 0);
+    std::vector<TileData> tiles;
+    if (!buildTiles(bs, cfg, tileSize, tilesX, verts, nverts, tileTris,
+                    tileIndices, tiles)) {
+      return false;
+    }
+
+    // Hand the tiles over to the navmesh, which frees them from then on
+    bool addFailed = false;
+    for (TileData& tileData : tiles) {
+      if (!tileData.data) {
+        continue;
+      }
+      if (!addFailed) {
+        status = navMesh->addTile(tileData.data, tileData.dataSize,
+                                  DT_TILE_FREE_DATA, 0, nullptr);
+        if (dtStatusSucceed(status)) {
+          numVerts += tileData.numVerts;
+          numPolys += tileData.numPolys;
+          continue;
+        }
+        ESP_ERROR() << "Could not add tile to Detour navmesh";
+        addFailed = true;
+      }
+      dtFree(tileData.data);
+    }
+    if (addFailed) {
+      return false;
+    }
+    if (numPolys == 0) {
+      ESP_ERROR() << "Could not build Detour navmesh";
       return false;
     }
-    navMeshSettings_ = {bs};
-  } else {
-    ESP_ERROR() << "cfg.maxVertsPerPoly(" << cfg.maxVertsPerPoly
-                << ") > DT_VERTS_PER_POLYGON(" << DT_VERTS_PER_POLYGON
-                << "), so cannot build the Detour NavMesh. Aborting NavMesh "
-                   "construction.";
-    return false;
   }
 
+  navMesh_ = std::move(navMesh);
+  navMeshFile_ = nullptr;
+  if (!initNavQuery()) {
+    return false;
+  }
+  navMeshSettings_ = {bs};
   bounds_ = std::make_pair(vec3f(bmin), vec3f(bmax));
 
-  ESP_DEBUG() << "Created navmesh with" << ws.pmesh->nverts << "vertices"
-              << ws.pmesh->npolys << "polygons";
+  ESP_DEBUG() << "Created navmesh with" << numVerts << "vertices" << numPolys
+              << "polygons";
 
   return true;
 }
 
 bool PathFinder::Impl::initNavQuery() {
-  // if we are reinitializing the NavQuery, then also reset the MeshData
+  // if we are reinitializing the NavQuery, then also reset the MeshData and
+  // the landmarks of the previous navmesh
   islandMeshData_.clear();
-
-  navQuery_.reset(dtAllocNavMeshQuery());
-  dtStatus status = navQuery_->init(navMesh_.get(), 2048);
+  landmarkIndex_ = nullptr;
+  clearanceField_ = nullptr;
+  navMeshGeneration_ = newNavMeshGeneration();
+
+  {
+    // queries of all threads are bound to the old navmesh
+    std::lock_guard<std::mutex> lock(workspacesMutex_);
+    workspaces_.clear();
+  }
+  auto workspace = std::make_unique<QueryWorkspace>();
+  workspace->navQuery.reset(dtAllocNavMeshQuery());
+  dtStatus status = workspace->navQuery->init(navMesh_.get(), 2048);
   if (dtStatusFailed(status)) {
     ESP_ERROR() << "Could not init Detour navmesh query";
     return false;
   }
+  workspaces_.emplace(std::this_thread::get_id(), std::move(workspace));
 
   islandSystem_ =
       std::make_unique<impl::IslandSystem>(navMesh_.get(), filter_.get());
@@ -865,34 +1875,194 @@ bool PathFinder::Impl::initNavQuery() {
   return true;
 }
 
+PathFinder::Impl::QueryWorkspace& PathFinder::Impl::getWorkspace() const {
+  // Workspace the calling thread used last. Generations are unique over all
+  // PathFinders and workspaces are only freed along with their generation, so
+  // a matching generation is enough to skip the lock on repeated queries.
+  struct CachedWorkspace {
+    int generation = 0;
+    QueryWorkspace* workspace = nullptr;
+  };
+  static thread_local CachedWorkspace cached;
+  if (navMeshGeneration_ != 0 && cached.generation == navMeshGeneration_) {
+    return *cached.workspace;
+  }
+
+  std::lock_guard<std::mutex> lock(workspacesMutex_);
+  std::unique_ptr<QueryWorkspace>& workspace =
+      workspaces_[std::this_thread::get_id()];
+  if (!workspace) {
+    workspace = std::make_unique<QueryWorkspace>();
+    workspace->navQuery.reset(dtAllocNavMeshQuery());
+    ESP_CHECK(workspace->navQuery &&
+                  dtStatusSucceed(
+                      workspace->navQuery->init(navMesh_.get(), 2048)),
+              "Could not init Detour navmesh query for a new thread");
+  }
+  cached.generation = navMeshGeneration_;
+  cached.workspace = workspace.get();
+  return *workspace;
+}
+
+const dtQueryFilter* PathFinder::Impl::getFilter(
+    const int islandIndex,
+    Cr::Containers::Optional<impl::IslandQueryFilter>& islandFilter) const {
+  if (islandIndex == ID_UNDEFINED) {
+    return filter_.get();
+  }
+  islandFilter.emplace(*filter_, *islandSystem_, islandIndex);
+  return &*islandFilter;
+}
+
+namespace {
+//! Bounds and indices of a mesh in the form the Recast pipeline takes them
+struct RecastInput {
+  explicit RecastInput(const esp::assets::MeshData& mesh)
+      : indices(mesh.ibo.begin(), mesh.ibo.end()) {
+    const float mf = std::numeric_limits<float>::max();
+    bmin = vec3f(mf, mf, mf);
+    bmax = vec3f(-mf, -mf, -mf);
+    for (const vec3f& p : mesh.vbo) {
+      bmin = bmin.cwiseMin(p);
+      bmax = bmax.cwiseMax(p);
+    }
+  }
+
+  std::vector<int> indices;
+  vec3f bmin, bmax;
+};
+}  // namespace
+
 bool PathFinder::Impl::build(const NavMeshSettings& bs,
                              const esp::assets::MeshData& mesh) {
-  const int numVerts = mesh.vbo.size();
-  const int numIndices = mesh.ibo.size();
-  const float mf = std::numeric_limits<float>::max();
-  vec3f bmin(mf, mf, mf);
-  vec3f bmax(-mf, -mf, -mf);
+  const RecastInput input{mesh};
+  return build(bs, mesh.vbo[0].data(), static_cast<int>(mesh.vbo.size()),
+               input.indices.data(),
+               static_cast<int>(input.indices.size() / 3), input.bmin.data(),
+               input.bmax.data());
+}
 
-  for (int i = 0; i < numVerts; ++i) {
-    const vec3f& p = mesh.vbo[i];
-    bmin = bmin.cwiseMin(p);
-    bmax = bmax.cwiseMax(p);
+bool PathFinder::Impl::rebuildRegions(
+    const esp::assets::MeshData& mesh,
+    const std::vector<std::pair<vec3f, vec3f>>& regions) {
+  if (!navMesh_ || !navMeshSettings_ || navMeshSettings_->tileSize <= 0) {
+    ESP_ERROR() << "Only a tiled navmesh can be rebuilt in place";
+    return false;
+  }
+  if (regions.empty()) {
+    return true;
+  }
+  const NavMeshSettings& bs = *navMeshSettings_;
+  const dtNavMeshParams& params = *navMesh_->getParams();
+  const RecastInput input{mesh};
+  const float* verts = mesh.vbo[0].data();
+  const int nverts = mesh.vbo.size();
+
+  // The tile grid of the navmesh starts at its origin, so geometry before it
+  // can't be covered without a full rebuild
+  rcConfig cfg = makeRecastConfig(bs);
+  if (input.bmin[0] < params.orig[0] - cfg.cs ||
+      input.bmin[2] < params.orig[2] - cfg.cs) {
+    ESP_ERROR() << "Mesh extends beyond the navmesh tile grid";
+    return false;
+  }
+  rcVcopy(cfg.bmin, input.bmin.data());
+  rcVcopy(cfg.bmax, input.bmax.data());
+  cfg.bmin[0] = params.orig[0];
+  cfg.bmin[2] = params.orig[2];
+  rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
+  const int tileSize = bs.tileSize;
+  const int tilesX = (cfg.width + tileSize - 1) / tileSize;
+  const int tilesZ = (cfg.height + tileSize - 1) / tileSize;
+
+  // Every tile whose heightfield, including its border, overlaps a region
+  const float tileWorldSize = tileSize * cfg.cs;
+  const float borderWorldSize = tileBorderSize(cfg) * cfg.cs;
+  std::vector<bool> isDirty(tilesX * tilesZ, false);
+  for (const std::pair<vec3f, vec3f>& region : regions) {
+    const int x0 = worldToTile(region.first[0] - borderWorldSize, cfg.bmin[0],
+                               tileWorldSize, tilesX);
+    const int x1 = worldToTile(region.second[0] + borderWorldSize, cfg.bmin[0],
+                               tileWorldSize, tilesX);
+    const int z0 = worldToTile(region.first[2] - borderWorldSize, cfg.bmin[2],
+                               tileWorldSize, tilesZ);
+    const int z1 = worldToTile(region.second[2] + borderWorldSize, cfg.bmin[2],
+                               tileWorldSize, tilesZ);
+    for (int z = z0; z <= z1; ++z) {
+      for (int x = x0; x <= x1; ++x) {
+        isDirty[z * tilesX + x] = true;
+      }
+    }
+  }
+  std::vector<int> tileIndices;
+  std::vector<std::pair<int, int>> tileCoords;
+  for (int i = 0; i < tilesX * tilesZ; ++i) {
+    if (isDirty[i]) {
+      tileIndices.push_back(i);
+      tileCoords.emplace_back(i % tilesX, i / tilesX);
+    }
+  }
+  ESP_DEBUG() << "Rebuilding" << tileIndices.size() << "of" << tilesX * tilesZ
+              << "navmesh tiles";
+
+  const std::vector<std::vector<int>> tileTris = bucketTrianglesByTile(
+      cfg, tileSize, tilesX, tilesZ, verts, input.indices.data(),
+      static_cast<int>(input.indices.size() / 3));
+  std::vector<TileData> tiles;
+  if (!buildTiles(bs, cfg, tileSize, tilesX, verts, nverts, tileTris,
+                  tileIndices, tiles)) {
+    return false;
   }
 
-  int* indices = new int[numIndices];
-  for (int i = 0; i < numIndices; ++i) {
-    indices[i] = static_cast<int>(mesh.ibo[i]);
+  // Collected while the old tiles are still there
+  const std::vector<int> dirtyIslands =
+      islandSystem_->islandsNearTiles(tileCoords);
+
+  // Swap the tiles. The navmesh reuses the slot of a removed tile with a new
+  // salt, so references to the old polygons become invalid.
+  bool addFailed = false;
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    const dtMeshTile* oldTile =
+        navMesh_->getTileAt(tileCoords[i].first, tileCoords[i].second, 0);
+    if (oldTile && oldTile->header) {
+      navMesh_->removeTile(navMesh_->getTileRef(oldTile), nullptr, nullptr);
+    }
+    TileData& tileData = tiles[i];
+    if (!tileData.data) {
+      continue;
+    }
+    if (!addFailed) {
+      dtTileRef tileRef = 0;
+      dtStatus status = navMesh_->addTile(tileData.data, tileData.dataSize,
+                                          DT_TILE_FREE_DATA, 0, &tileRef);
+      if (dtStatusSucceed(status)) {
+        const dtMeshTile* tile = navMesh_->getTileByRef(tileRef);
+        bounds_.first =
+            bounds_.first.array().min(Eigen::Array3f{tile->header->bmin});
+        bounds_.second =
+            bounds_.second.array().max(Eigen::Array3f{tile->header->bmax});
+        continue;
+      }
+      ESP_ERROR() << "Could not add tile to Detour navmesh";
+      addFailed = true;
+    }
+    dtFree(tileData.data);
   }
 
-  const bool success = build(bs, mesh.vbo[0].data(), numVerts, indices,
-                             numIndices / 3, bmin.data(), bmax.data());
-  delete[] indices;
-  return success;
+  islandMeshData_.clear();
+  // polygons were added and removed, so the landmark, goal and obstacle
+  // distances are stale
+  landmarkIndex_ = nullptr;
+  clearanceField_ = nullptr;
+  navMeshGeneration_ = newNavMeshGeneration();
+  islandSystem_->update(navMesh_.get(), filter_.get(), dirtyIslands);
+  return !addFailed;
 }
 
 namespace {
 const int NAVMESHSET_MAGIC = 'M' << 24 | 'S' << 16 | 'E' << 8 | 'T';  //'MSET';
-const int NAVMESHSET_VERSION = 2;
+// Version 3 appended NavMeshSettings::tileSize to the serialized settings
+const int NAVMESHSET_VERSION = 3;
 
 struct NavMeshSetHeader {
   int magic;
@@ -906,6 +2076,18 @@ struct NavMeshTileHeader {
   int dataSize;
 };
 
+//! Size of the NavMeshSettings serialized in a file of the given version
+size_t navMeshSettingsSize(const int version) {
+  if (version >= 3) {
+    return sizeof(NavMeshSettings);
+  }
+  // Version 2 settings end before tileSize and were always single tile
+  if (version == 2) {
+    return offsetof(NavMeshSettings, tileSize);
+  }
+  return 0;
+}
+
 struct Triangle {
   std::vector<vec3f> v;
   Triangle() { v.resize(3); }
@@ -954,57 +2136,155 @@ float polyArea(const dtPoly* poly, const dtMeshTile* tile) {
 }
 }  // namespace
 
-// Some polygons have zero area for some reason.  When we navigate into a zero
-// area polygon, things crash.  So we find all zero area polygons and mark
-// them as disabled/not navigable.
-// Also compute the NavMesh areas for later query.
-void impl::IslandSystem::removeZeroAreaPolys(dtNavMesh* navMesh) {
-  islandsToArea_ = std::unordered_map<uint32_t, float>();
-  islandsToArea_.reserve(islandsToPolys_.size());
-  // initialize the area cache.
-  for (auto& itr : islandsToPolys_) {
-    islandsToArea_[itr.first] = 0.0;
-  }
-  // Iterate over all tiles
-  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
-    const dtMeshTile* tile =
-        const_cast<const dtNavMesh*>(navMesh)->getTile(iTile);
-    if (!tile)
-      continue;
+void impl::IslandSystem::computeIslandAreas(dtNavMesh* navMesh,
+                                            const int firstIsland) {
+  for (int island = firstIsland; island < numIslands(); ++island) {
+    float& islandArea = islandsToArea_[island];
+    islandArea = 0.0;
+    AreaSampler& islandSampler = islandSamplers_[island];
+    islandSampler = AreaSampler{};
 
-    // Iterate over all polygons in a tile
-    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
-      // Get the polygon reference from the tile and polygon id
-      dtPolyRef polyRef = navMesh->encodePolyId(tile->salt, iTile, jPoly);
+    for (const dtPolyRef polyRef : islandsToPolys_[island]) {
       const dtPoly* poly = nullptr;
-      const dtMeshTile* tmp = nullptr;
-      navMesh->getTileAndPolyByRefUnsafe(polyRef, &tmp, &poly);
+      const dtMeshTile* tile = nullptr;
+      navMesh->getTileAndPolyByRefUnsafe(polyRef, &tile, &poly);
 
       CORRADE_INTERNAL_ASSERT(poly != nullptr);
-      CORRADE_INTERNAL_ASSERT(tmp != nullptr);
+      CORRADE_INTERNAL_ASSERT(tile != nullptr);
 
       float polygonArea = polyArea(poly, tile);
       if (polygonArea < 1e-5) {
         navMesh->setPolyFlags(polyRef, POLYFLAGS_DISABLED);
       } else if ((poly->flags & POLYFLAGS_WALK) != 0) {
-        islandsToArea_[polyToIsland_[polyRef]] += polygonArea;
+        islandArea += polygonArea;
+        for (const Triangle& tri : getPolygonTriangles(poly, tile)) {
+          const float triArea =
+              0.5f * (tri.v[1] - tri.v[0]).cross(tri.v[2] - tri.v[1]).norm();
+          islandSampler.addTriangle(polyRef, triArea, tri.v[0], tri.v[1],
+                                    tri.v[2]);
+        }
       }
     }
+    islandSampler.buildAliasTable();
   }
 
-  // total of all island areas
+  // The full NavMesh is the union of all islands
   float totalArea = 0;
-  for (auto& itr : islandsToArea_) {
-    totalArea += itr.second;
+  AreaSampler& navMeshSampler = islandSamplers_[ID_UNDEFINED];
+  navMeshSampler = AreaSampler{};
+  for (int island = 0; island < numIslands(); ++island) {
+    totalArea += islandsToArea_[island];
+    navMeshSampler.append(islandSamplers_[island]);
   }
   islandsToArea_[ID_UNDEFINED] = totalArea;
+  navMeshSampler.buildAliasTable();
+}
+
+void impl::IslandSystem::disableUnassignedZeroAreaPolys(dtNavMesh* navMesh) {
+  for (int iTile = 0; iTile < navMesh->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+    const dtPolyRef base = navMesh->getPolyRefBase(tile);
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPolyRef polyRef = base | static_cast<dtPolyRef>(jPoly);
+      if (getPolyIsland(polyRef) == ID_UNDEFINED &&
+          polyArea(&tile->polys[jPoly], tile) < 1e-5) {
+        navMesh->setPolyFlags(polyRef, POLYFLAGS_DISABLED);
+      }
+    }
+  }
+}
+
+std::vector<int> impl::IslandSystem::islandsNearTiles(
+    const std::vector<std::pair<int, int>>& tiles) const {
+  std::vector<bool> isNear(numIslands(), false);
+  for (const std::pair<int, int>& tileCoords : tiles) {
+    for (int dz = -1; dz <= 1; ++dz) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        const dtMeshTile* tile = navMesh_->getTileAt(tileCoords.first + dx,
+                                                     tileCoords.second + dz, 0);
+        if (!tile || !tile->header)
+          continue;
+        const dtPolyRef base = navMesh_->getPolyRefBase(tile);
+        for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+          const int island =
+              getPolyIsland(base | static_cast<dtPolyRef>(jPoly));
+          if (island != ID_UNDEFINED) {
+            isNear[island] = true;
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<int> islands;
+  for (int island = 0; island < numIslands(); ++island) {
+    if (isNear[island]) {
+      islands.push_back(island);
+    }
+  }
+  return islands;
+}
+
+void impl::IslandSystem::update(dtNavMesh* navMesh,
+                                const dtQueryFilter* filter,
+                                const std::vector<int>& dirtyIslands) {
+  std::vector<bool> isDirty(numIslands(), false);
+  for (const int island : dirtyIslands) {
+    isDirty[island] = true;
+  }
+
+  // Keep the clean islands, renumbered so island indices stay dense
+  std::unordered_map<int, float> islandsToArea;
+  std::unordered_map<uint32_t, std::vector<dtPolyRef>> islandsToPolys;
+  std::unordered_map<int, AreaSampler> islandSamplers;
+  std::vector<float> islandRadius;
+  for (int island = 0; island < numIslands(); ++island) {
+    if (isDirty[island])
+      continue;
+    const int newIsland = islandRadius.size();
+    islandRadius.push_back(islandRadius_[island]);
+    islandsToArea[newIsland] = islandsToArea_[island];
+    islandsToPolys[newIsland] = std::move(islandsToPolys_[island]);
+    islandSamplers[newIsland] = std::move(islandSamplers_[island]);
+  }
+  islandsToArea_ = std::move(islandsToArea);
+  islandsToPolys_ = std::move(islandsToPolys);
+  islandSamplers_ = std::move(islandSamplers);
+  islandRadius_ = std::move(islandRadius);
+
+  // Tiles were added and removed, so the flat polygon table is laid out anew.
+  // The clean islands don't have polygons in the replaced tiles, so their
+  // references are still valid.
+  layoutPolys();
+  for (const auto& itr : islandsToPolys_) {
+    for (const dtPolyRef polyRef : itr.second) {
+      polyIsland_[polyIndex(polyRef)] = itr.first;
+    }
+  }
+
+  const int firstNewIsland = numIslands();
+  disableUnassignedZeroAreaPolys(navMesh);
+  floodUnassignedPolys(filter);
+  computeIslandAreas(navMesh, firstNewIsland);
 }
 
 int PathFinder::Impl::numIslands() {
   return islandSystem_->numIslands();
 }
 
-bool PathFinder::Impl::loadNavMesh(const std::string& path) {
+bool PathFinder::Impl::loadNavMesh(const std::string& path,
+                                   const bool memoryMap) {
+  if (memoryMap) {
+#ifndef _WIN32
+    return loadNavMeshMapped(path);
+#else
+    ESP_WARNING() << "Memory mapped navmesh loading isn't supported on this "
+                     "platform, reading the file instead";
+#endif
+  }
+
   FILE* fp = fopen(path.c_str(), "rb");
   if (!fp)
     return false;
@@ -1026,8 +2306,8 @@ bool PathFinder::Impl::loadNavMesh(const std::string& path) {
   }
 
   navMeshSettings_ = {NavMeshSettings{}};
-  if (header.version >= 2) {
-    fread(&(*navMeshSettings_), sizeof(NavMeshSettings), 1, fp);
+  if (const size_t settingsSize = navMeshSettingsSize(header.version)) {
+    fread(&(*navMeshSettings_), settingsSize, 1, fp);
   } else {
     ESP_DEBUG()
         << "NavMeshSettings aren't present, guessing that they are the default";
@@ -1085,9 +2365,111 @@ bool PathFinder::Impl::loadNavMesh(const std::string& path) {
   fclose(fp);
 
   navMesh_.reset(mesh);
+  navMeshFile_ = nullptr;
+  bounds_ = std::make_pair(bmin, bmax);
+
+  return initNavQuery();
+}
+
+bool PathFinder::Impl::loadNavMeshMapped(const std::string& path) {
+#ifndef _WIN32
+  auto file = std::make_unique<MappedFile>();
+  {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+      close(fd);
+      return false;
+    }
+    // Private, as Detour writes links and poly flags into the tile data
+    void* data = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+      return false;
+    file->data = static_cast<unsigned char*>(data);
+    file->size = st.st_size;
+  }
+
+  unsigned char* cursor = file->data;
+  const unsigned char* const end = file->data + file->size;
+  // Like fread, but failing instead of reading past the end of the file
+  auto read = [&cursor, end](void* out, size_t size) {
+    if (static_cast<size_t>(end - cursor) < size)
+      return false;
+    memcpy(out, cursor, size);
+    cursor += size;
+    return true;
+  };
+
+  // Read header.
+  NavMeshSetHeader header{};
+  if (!read(&header, sizeof(NavMeshSetHeader)))
+    return false;
+  if (header.magic != NAVMESHSET_MAGIC)
+    return false;
+  if (header.version < 1 || header.version > NAVMESHSET_VERSION)
+    return false;
+
+  NavMeshSettings settings;
+  if (const size_t settingsSize = navMeshSettingsSize(header.version)) {
+    if (!read(&settings, settingsSize))
+      return false;
+  } else {
+    ESP_DEBUG()
+        << "NavMeshSettings aren't present, guessing that they are the default";
+  }
+
+  std::unique_ptr<dtNavMesh, NavMeshDeleter> mesh{dtAllocNavMesh()};
+  if (!mesh)
+    return false;
+  dtStatus status = mesh->init(&header.params);
+  if (dtStatusFailed(status))
+    return false;
+
+  // Hand the tiles to Detour in place, the navmesh doesn't own them
+  vec3f bmin, bmax;
+  for (int i = 0; i < header.numTiles; ++i) {
+    NavMeshTileHeader tileHeader{};
+    if (!read(&tileHeader, sizeof(tileHeader)))
+      return false;
+
+    if ((tileHeader.tileRef == 0u) || (tileHeader.dataSize == 0))
+      break;
+
+    if (static_cast<size_t>(end - cursor) <
+            static_cast<size_t>(tileHeader.dataSize) ||
+        reinterpret_cast<std::uintptr_t>(cursor) % 4 != 0)
+      return false;
+    status = mesh->addTile(cursor, tileHeader.dataSize, 0, tileHeader.tileRef,
+                           nullptr);
+    if (dtStatusFailed(status))
+      return false;
+    cursor += tileHeader.dataSize;
+
+    const dtMeshTile* tile = mesh->getTileByRef(tileHeader.tileRef);
+    if (i == 0) {
+      bmin = vec3f(tile->header->bmin);
+      bmax = vec3f(tile->header->bmax);
+    } else {
+      bmin = bmin.array().min(Eigen::Array3f{tile->header->bmin});
+      bmax = bmax.array().max(Eigen::Array3f{tile->header->bmax});
+    }
+  }
+
+  // The old navmesh may use the old mapping, so it goes first
+  navMesh_ = std::move(mesh);
+  navMeshFile_ = std::move(file);
+  navMeshSettings_ = {settings};
   bounds_ = std::make_pair(bmin, bmax);
 
   return initNavQuery();
+#else
+  static_cast<void>(path);
+  return false;
+#endif
 }
 
 bool PathFinder::Impl::saveNavMesh(const std::string& path) {
@@ -1138,120 +2520,308 @@ bool PathFinder::Impl::saveNavMesh(const std::string& path) {
   return true;
 }
 
+namespace {
+//! 64-bit FNV-1a
+struct Fnv1a {
+  std::uint64_t hash = 14695981039346656037ull;
+
+  void add(const void* data, const std::size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+      hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+  }
+
+  template <typename T>
+  void add(const T& value) {
+    add(&value, sizeof(T));
+  }
+};
+}  // namespace
+
+std::string navMeshCacheKey(const NavMeshSettings& settings,
+                            const esp::assets::MeshData& mesh) {
+  Fnv1a fnv;
+  fnv.add(NAVMESHSET_VERSION);
+
+  // Field by field, as the padding of NavMeshSettings is indeterminate
+  fnv.add(settings.cellSize);
+  fnv.add(settings.cellHeight);
+  fnv.add(settings.agentHeight);
+  fnv.add(settings.agentRadius);
+  fnv.add(settings.agentMaxClimb);
+  fnv.add(settings.agentMaxSlope);
+  fnv.add(settings.regionMinSize);
+  fnv.add(settings.regionMergeSize);
+  fnv.add(settings.edgeMaxLen);
+  fnv.add(settings.edgeMaxError);
+  fnv.add(settings.vertsPerPoly);
+  fnv.add(settings.detailSampleDist);
+  fnv.add(settings.detailSampleMaxError);
+  fnv.add(settings.filterLowHangingObstacles);
+  fnv.add(settings.filterLedgeSpans);
+  fnv.add(settings.filterWalkableLowHeightSpans);
+  fnv.add(settings.tileSize);
+
+  const std::uint64_t numVerts = mesh.vbo.size();
+  const std::uint64_t numIndices = mesh.ibo.size();
+  fnv.add(numVerts);
+  for (const vec3f& vert : mesh.vbo) {
+    fnv.add(vert.data(), 3 * sizeof(float));
+  }
+  fnv.add(numIndices);
+  fnv.add(mesh.ibo.data(), numIndices * sizeof(uint32_t));
+
+  char key[17];
+  std::snprintf(key, sizeof(key), "%016llx",
+                static_cast<unsigned long long>(fnv.hash));
+  return key;
+}
+
 void PathFinder::Impl::seed(uint32_t newSeed) {
-  // TODO: this should be using core::Random instead, but passing function
-  // to navQuery_->findRandomPoint needs to be figured out first
-  srand(newSeed);
+  random_.seed(newSeed);
+}
+
+bool PathFinder::Impl::buildLandmarkIndex(int numLandmarks) {
+  if (!navMesh_ || numLandmarks <= 0)
+    return false;
+  landmarkIndex_ = std::make_unique<impl::LandmarkIndex>(
+      navMesh_.get(), filter_.get(), *islandSystem_, numLandmarks);
+  return true;
+}
+
+namespace {
+const int LANDMARKS_MAGIC = 'L' << 24 | 'M' << 16 | 'R' << 8 | 'K';  //'LMRK';
+// Version 2 added the checksum of the navmesh the index was built for
+const int LANDMARKS_VERSION = 2;
+
+struct LandmarkIndexHeader {
+  int magic;
+  int version;
+  int numPolys;
+  int numLandmarks;
+  std::uint64_t navMeshChecksum;
+};
+
+//! Hash of the polygon layout and vertices of all tiles of a navmesh. Poly
+//! flags are left out, as they change with zero area polygon removal.
+std::uint64_t navMeshChecksum(const dtNavMesh& navMesh) {
+  Fnv1a fnv;
+  for (int iTile = 0; iTile < navMesh.getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh.getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+    const dtMeshHeader& header = *tile->header;
+    fnv.add(iTile);
+    fnv.add(header.polyCount);
+    fnv.add(header.vertCount);
+    fnv.add(tile->verts, sizeof(float) * 3 * header.vertCount);
+    for (int jPoly = 0; jPoly < header.polyCount; ++jPoly) {
+      const dtPoly& poly = tile->polys[jPoly];
+      fnv.add(poly.vertCount);
+      fnv.add(poly.verts, sizeof(unsigned short) * poly.vertCount);
+    }
+  }
+  return fnv.hash;
 }
+}  // namespace
+
+bool PathFinder::Impl::saveLandmarkIndex(const std::string& path) const {
+  if (!landmarkIndex_) {
+    ESP_ERROR() << "No landmark index to save. Build one with "
+                   "buildLandmarkIndex() first";
+    return false;
+  }
+
+  FILE* fp = fopen(path.c_str(), "wb");
+  if (!fp)
+    return false;
+
+  LandmarkIndexHeader header{};
+  header.magic = LANDMARKS_MAGIC;
+  header.version = LANDMARKS_VERSION;
+  header.numPolys = landmarkIndex_->numPolys();
+  header.numLandmarks = landmarkIndex_->numLandmarks();
+  header.navMeshChecksum = navMeshChecksum(*navMesh_);
+  const std::vector<float>& distances = landmarkIndex_->distances();
+  const bool written =
+      fwrite(&header, sizeof(LandmarkIndexHeader), 1, fp) == 1 &&
+      fwrite(distances.data(), sizeof(float), distances.size(), fp) ==
+          distances.size();
+  fclose(fp);
+
+  return written;
+}
+
+bool PathFinder::Impl::loadLandmarkIndex(const std::string& path) {
+  if (!navMesh_) {
+    ESP_ERROR() << "Load or build the navmesh before its landmark index";
+    return false;
+  }
+
+  FILE* fp = fopen(path.c_str(), "rb");
+  if (!fp) {
+    ESP_ERROR() << "Could not open file" << path;
+    return false;
+  }
+
+  LandmarkIndexHeader header{};
+  if (fread(&header, sizeof(LandmarkIndexHeader), 1, fp) != 1 ||
+      header.magic != LANDMARKS_MAGIC || header.version != LANDMARKS_VERSION) {
+    ESP_ERROR() << path << "is not a landmark index file";
+    fclose(fp);
+    return false;
+  }
+  if (header.numPolys != islandSystem_->numPolys() ||
+      header.numLandmarks <= 0) {
+    ESP_ERROR() << "Landmark index" << path << "was built for a navmesh with"
+                << header.numPolys << "polygons but the current one has"
+                << islandSystem_->numPolys();
+    fclose(fp);
+    return false;
+  }
+  if (header.navMeshChecksum != navMeshChecksum(*navMesh_)) {
+    ESP_ERROR() << "Landmark index" << path
+                << "was built for a different navmesh";
+    fclose(fp);
+    return false;
+  }
+
+  std::vector<float> distances(size_t(header.numPolys) * header.numLandmarks);
+  const size_t numRead =
+      fread(distances.data(), sizeof(float), distances.size(), fp);
+  fclose(fp);
+  if (numRead != distances.size()) {
+    ESP_ERROR() << "Landmark index" << path << "is truncated";
+    return false;
+  }
+
+  landmarkIndex_ = std::make_unique<impl::LandmarkIndex>(header.numLandmarks,
+                                                         std::move(distances));
+  return true;
+}
+
+float PathFinder::Impl::estimateGeodesicDistance(const vec3f& start,
+                                                 const vec3f& end) const {
+  if (!navMesh_)
+    return std::numeric_limits<float>::infinity();
+  const dtNavMeshQuery* navQuery = getWorkspace().navQuery.get();
+  dtStatus status = 0;
+  dtPolyRef startRef = 0, endRef = 0;
+  vec3f pathStart, pathEnd;
+  std::tie(status, startRef, pathStart) =
+      projectToPoly(start, navQuery, filter_.get());
+  if (status != DT_SUCCESS || startRef == 0)
+    return std::numeric_limits<float>::infinity();
+  std::tie(status, endRef, pathEnd) =
+      projectToPoly(end, navQuery, filter_.get());
+  if (status != DT_SUCCESS || endRef == 0 ||
+      !islandSystem_->hasConnection(startRef, endRef))
+    return std::numeric_limits<float>::infinity();
+
+  float estimate = (pathEnd - pathStart).norm();
+  if (landmarkIndex_) {
+    estimate = std::max(
+        estimate, landmarkIndex_->estimate(islandSystem_->polyIndex(startRef),
+                                           islandSystem_->polyIndex(endRef)));
+  }
+  return estimate;
+}
+
+namespace {
+// Detour samples points through a plain function pointer, so the generator of
+// the current query is handed to frand() through a thread local.
+thread_local core::Random* queryRandom = nullptr;
 
-// Returns a random number [0..1]
-static float frand() {
-  return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+// Returns a random number [0..1)
+float frand() {
+  return queryRandom->uniform_float_01();
 }
 
+//! Binds a generator to frand() for the lifetime of a query
+struct QueryRandomScope {
+  explicit QueryRandomScope(core::Random& rng) : previous{queryRandom} {
+    queryRandom = &rng;
+  }
+  ~QueryRandomScope() { queryRandom = previous; }
+  core::Random* previous;
+};
+}  // namespace
+
 vec3f PathFinder::Impl::getRandomNavigablePoint(
+    core::Random& rng,
     const int maxTries /*= 10*/,
-    int islandIndex /*= ID_UNDEFINED*/) {
+    int islandIndex /*= ID_UNDEFINED*/) const {
   islandSystem_->assertValidIsland(islandIndex);
   if (getNavigableArea(islandIndex) <= 0.0)
     throw std::runtime_error(
         "NavMesh has no navigable area, this indicates an issue with the "
         "NavMesh");
 
-  // If this query should be island specific
-  if (islandIndex != ID_UNDEFINED) {
-    // set the poly flag to identify polys not on the target island
-    islandSystem_->setPolyFlagForIsland(
-        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
-        /*setFlag=*/true, /*invert=*/true);
-    filter_->setExcludeFlags(filter_->getExcludeFlags() |
-                             PolyFlags::POLYFLAGS_OFF_ISLAND);
-  }
-
-  vec3f pt;
-  int i = 0;
-  for (i = 0; i < maxTries; ++i) {
-    dtPolyRef ref = 0;
-    dtStatus status =
-        navQuery_->findRandomPoint(filter_.get(), frand, &ref, pt.data());
-    if (dtStatusSucceed(status))
-      break;
-  }
+  // Sampling from the precomputed alias tables can't fail, so maxTries is
+  // only kept for API compatibility.
+  static_cast<void>(maxTries);
+  return islandSystem_->sampleNavigablePoint(islandIndex, rng);
+}
 
-  // Clean up if this query was island specific
-  if (islandIndex != ID_UNDEFINED) {
-    // reset the poly flag identifing polys off the target island
-    islandSystem_->setPolyFlagForIsland(
-        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
-        /*setFlag=*/false, /*invert=*/true);
-    filter_->setExcludeFlags(filter_->getExcludeFlags() &
-                             ~PolyFlags::POLYFLAGS_OFF_ISLAND);
-  }
+std::vector<vec3f> PathFinder::Impl::getRandomNavigablePoints(
+    core::Random& rng,
+    const int numPoints,
+    int islandIndex /*= ID_UNDEFINED*/) const {
+  islandSystem_->assertValidIsland(islandIndex);
+  if (getNavigableArea(islandIndex) <= 0.0)
+    throw std::runtime_error(
+        "NavMesh has no navigable area, this indicates an issue with the "
+        "NavMesh");
 
-  if (i == maxTries) {
-    ESP_ERROR() << "Failed to getRandomNavigablePoint.  Try increasing max "
-                   "tries if the navmesh is fine but just hard to sample from";
-    return vec3f::Constant(Mn::Constants::nan());
+  std::vector<vec3f> points;
+  points.reserve(numPoints);
+  for (int i = 0; i < numPoints; ++i) {
+    points.emplace_back(islandSystem_->sampleNavigablePoint(islandIndex, rng));
   }
-  return pt;
+  return points;
 }
 
 vec3f PathFinder::Impl::getRandomNavigablePointAroundSphere(
+    core::Random& rng,
     const vec3f& circleCenter,
     const float radius,
     const int maxTries,
-    int islandIndex) {
+    int islandIndex) const {
   islandSystem_->assertValidIsland(islandIndex);
   if (getNavigableArea(islandIndex) <= 0.0)
     throw std::runtime_error(
         "NavMesh has no navigable area, this indicates an issue with the "
         "NavMesh");
 
-  // If this query should be island specific
-  if (islandIndex != ID_UNDEFINED) {
-    // set the poly flag to identify polys not on the target island
-    islandSystem_->setPolyFlagForIsland(
-        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
-        /*setFlag=*/true, /*invert=*/true);
-    filter_->setExcludeFlags(filter_->getExcludeFlags() |
-                             PolyFlags::POLYFLAGS_OFF_ISLAND);
-  }
+  // If this query should be island specific, restrict it with a filter
+  Cr::Containers::Optional<impl::IslandQueryFilter> islandFilter;
+  const dtQueryFilter* filter = getFilter(islandIndex, islandFilter);
+  dtNavMeshQuery* navQuery = getWorkspace().navQuery.get();
+  QueryRandomScope randomScope{rng};
 
   vec3f pt = vec3f::Constant(Mn::Constants::nan());
   dtPolyRef start_ref = 0;  // ID to start our search
-  dtStatus status = navQuery_->findNearestPoly(
-      circleCenter.data(), vec3f{radius, radius, radius}.data(), filter_.get(),
+  dtStatus status = navQuery->findNearestPoly(
+      circleCenter.data(), vec3f{radius, radius, radius}.data(), filter,
       &start_ref, pt.data());
 
-  // cache and handle later to unify required clean-up
-  bool failedAndAborting = (!dtStatusSucceed(status) || std::isnan(pt[0]));
-
-  int i = 0;
-  if (!failedAndAborting) {
-    for (; i < maxTries; ++i) {
-      dtPolyRef rand_ref = 0;
-      status = navQuery_->findRandomPointAroundCircle(
-          start_ref, circleCenter.data(), radius, filter_.get(), frand,
-          &rand_ref, pt.data());
-      if (dtStatusSucceed(status) && (pt - circleCenter).norm() <= radius) {
-        break;
-      }
-    }
-  }
-  // Clean up if this query was island specific
-  if (islandIndex != ID_UNDEFINED) {
-    // reset the poly flag identifing polys off the target island
-    islandSystem_->setPolyFlagForIsland(
-        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
-        /*setFlag=*/false, /*invert=*/true);
-    filter_->setExcludeFlags(filter_->getExcludeFlags() &
-                             ~PolyFlags::POLYFLAGS_OFF_ISLAND);
-  }
-  if (failedAndAborting) {
+  if (!dtStatusSucceed(status) || std::isnan(pt[0])) {
     ESP_ERROR()
         << "Failed to getRandomNavigablePoint. No polygon found within radius";
     return vec3f::Constant(Mn::Constants::nan());
   }
+
+  int i = 0;
+  for (; i < maxTries; ++i) {
+    dtPolyRef rand_ref = 0;
+    status = navQuery->findRandomPointAroundCircle(
+        start_ref, circleCenter.data(), radius, filter, frand, &rand_ref,
+        pt.data());
+    if (dtStatusSucceed(status) && (pt - circleCenter).norm() <= radius) {
+      break;
+    }
+  }
   if (i == maxTries) {
     ESP_ERROR() << "Failed to getRandomNavigablePoint.  Try increasing max "
                    "tries if the navmesh is fine but just hard to sample from";
@@ -1261,7 +2831,7 @@ vec3f PathFinder::Impl::getRandomNavigablePointAroundSphere(
 }
 
 namespace {
-float pathLength(const std::vector<vec3f>& points) {
+float pathLength(Cr::Containers::ArrayView<const vec3f> points) {
   CORRADE_INTERNAL_ASSERT(points.size() > 0);
 
   float length = 0;
@@ -1275,7 +2845,7 @@ float pathLength(const std::vector<vec3f>& points) {
 }
 }  // namespace
 
-bool PathFinder::Impl::findPath(ShortestPath& path) {
+bool PathFinder::Impl::findPath(ShortestPath& path) const {
   MultiGoalShortestPath tmp;
   tmp.requestedStart = path.requestedStart;
   tmp.setRequestedEnds({path.requestedEnd});
@@ -1287,16 +2857,20 @@ bool PathFinder::Impl::findPath(ShortestPath& path) {
   return status;
 }
 
-Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>>
-PathFinder::Impl::findPathInternal(const vec3f& start,
-                                   dtPolyRef startRef,
-                                   const vec3f& pathStart,
-                                   const vec3f& end,
-                                   dtPolyRef endRef,
-                                   const vec3f& pathEnd) {
+Cr::Containers::Optional<float> PathFinder::Impl::findPathInternal(
+    QueryWorkspace& ws,
+    const vec3f& start,
+    dtPolyRef startRef,
+    const vec3f& pathStart,
+    const vec3f& end,
+    dtPolyRef endRef,
+    const vec3f& pathEnd) const {
   // check if trivial path (start is same as end) and early return
   if (pathStart.isApprox(pathEnd)) {
-    return std::make_tuple(0.0f, std::vector<vec3f>{pathStart, pathEnd});
+    ws.points[0] = pathStart;
+    ws.points[1] = pathEnd;
+    ws.numPoints = 2;
+    return 0.0f;
   }
 
   // Check if there is a path between the start and any of the ends
@@ -1304,43 +2878,37 @@ PathFinder::Impl::findPathInternal(const vec3f& start,
     return Cr::Containers::NullOpt;
   }
 
-  static const int MAX_POLYS = 256;
-  dtPolyRef polys[MAX_POLYS];
-
   int numPolys = 0;
-  dtStatus status =
-      navQuery_->findPath(startRef, endRef, pathStart.data(), pathEnd.data(),
-                          filter_.get(), polys, &numPolys, MAX_POLYS);
+  dtStatus status = ws.navQuery->findPath(startRef, endRef, pathStart.data(),
+                                          pathEnd.data(), filter_.get(),
+                                          ws.polys, &numPolys, MAX_POLYS);
   if (status != DT_SUCCESS || numPolys == 0) {
     return Cr::Containers::NullOpt;
   }
 
-  int numPoints = 0;
-  std::vector<vec3f> points(MAX_POLYS);
-  status = navQuery_->findStraightPath(start.data(), end.data(), polys,
-                                       numPolys, points[0].data(), nullptr,
-                                       nullptr, &numPoints, MAX_POLYS);
-  if (status != DT_SUCCESS || numPoints == 0) {
+  ws.numPoints = 0;
+  status = ws.navQuery->findStraightPath(
+      start.data(), end.data(), ws.polys, numPolys, ws.points[0].data(),
+      nullptr, nullptr, &ws.numPoints, MAX_POLYS);
+  if (status != DT_SUCCESS || ws.numPoints == 0) {
     return Corrade::Containers::NullOpt;
   }
 
-  points.resize(numPoints);
-
-  const float length = pathLength(points);
-
-  return std::make_tuple(length, std::move(points));
+  return pathLength({ws.points.data(), std::size_t(ws.numPoints)});
 }
 
 bool PathFinder::Impl::findPathSetup(MultiGoalShortestPath& path,
                                      dtPolyRef& startRef,
-                                     vec3f& pathStart) {
+                                     vec3f& pathStart) const {
   path.geodesicDistance = std::numeric_limits<float>::infinity();
   path.points.clear();
 
+  const dtNavMeshQuery* navQuery = getWorkspace().navQuery.get();
+
   // find nearest polys and path
   dtStatus status = 0;
   std::tie(status, startRef, pathStart) =
-      projectToPoly(path.requestedStart, navQuery_.get(), filter_.get());
+      projectToPoly(path.requestedStart, navQuery, filter_.get());
 
   if (status != DT_SUCCESS || startRef == 0) {
     return false;
@@ -1353,7 +2921,7 @@ bool PathFinder::Impl::findPathSetup(MultiGoalShortestPath& path,
     dtPolyRef endRef = 0;
     vec3f pathEnd;
     std::tie(status, endRef, pathEnd) =
-        projectToPoly(rqEnd, navQuery_.get(), filter_.get());
+        projectToPoly(rqEnd, navQuery, filter_.get());
 
     if (status != DT_SUCCESS || endRef == 0) {
       return false;
@@ -1366,7 +2934,7 @@ bool PathFinder::Impl::findPathSetup(MultiGoalShortestPath& path,
   return true;
 }
 
-bool PathFinder::Impl::findPath(MultiGoalShortestPath& path) {
+bool PathFinder::Impl::findPath(MultiGoalShortestPath& path) const {
   dtPolyRef startRef = 0;
   vec3f pathStart;
   if (!findPathSetup(path, startRef, pathStart))
@@ -1389,50 +2957,282 @@ bool PathFinder::Impl::findPath(MultiGoalShortestPath& path) {
           (path.pimpl_->requestedEnds[i] - path.requestedStart).norm());
     }
 
-    path.pimpl_->prevRequestedStart = path.requestedStart;
+    path.pimpl_->prevRequestedStart = path.requestedStart;
+  }
+
+  // Explore possible goal points by their minimum theoretical distance. The
+  // landmark estimates are closer to the real distances, so with a landmark
+  // index the nearest goal tends to be found first and more goals are pruned.
+  // They aren't guaranteed lower bounds though, so only the theoretical
+  // distance is used for pruning.
+  std::vector<float> priority = path.pimpl_->minTheoreticalDist;
+  if (landmarkIndex_) {
+    const int startIndex = islandSystem_->polyIndex(startRef);
+    for (size_t i = 0; i < priority.size(); ++i) {
+      priority[i] = std::max(
+          priority[i],
+          landmarkIndex_->estimate(
+              startIndex, islandSystem_->polyIndex(path.pimpl_->endRefs[i])));
+    }
+  }
+  std::vector<size_t> ordering(path.pimpl_->requestedEnds.size());
+  std::iota(ordering.begin(), ordering.end(), 0);
+  std::sort(ordering.begin(), ordering.end(),
+            [&priority](const size_t a, const size_t b) -> bool {
+              return priority[a] < priority[b];
+            });
+
+  QueryWorkspace& ws = getWorkspace();
+  for (size_t i : ordering) {
+    if (path.pimpl_->minTheoreticalDist[i] > path.geodesicDistance)
+      continue;
+
+    const Cr::Containers::Optional<float> findResult =
+        findPathInternal(ws, path.requestedStart, startRef, pathStart,
+                         path.pimpl_->requestedEnds[i], path.pimpl_->endRefs[i],
+                         path.pimpl_->pathEnds[i]);
+
+    if (findResult && *findResult < path.geodesicDistance) {
+      path.pimpl_->minTheoreticalDist[i] = *findResult;
+      path.geodesicDistance = *findResult;
+      path.points.assign(ws.points.begin(), ws.points.begin() + ws.numPoints);
+    }
+  }
+
+  return path.geodesicDistance < std::numeric_limits<float>::infinity();
+}
+
+void PathFinder::Impl::computeGoalDistanceField(
+    GoalDistanceField& field) const {
+  GoalDistanceField::Impl& f = *field.pimpl_;
+  const int numPolys = islandSystem_->numPolys();
+  f.owner = this;
+  f.generation = navMeshGeneration_;
+  f.polyDistances.assign(numPolys, std::numeric_limits<float>::infinity());
+  f.polyEntries.assign(numPolys, vec3f::Zero());
+  f.polyGoals.clear();
+
+  using Entry = std::pair<float, dtPolyRef>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+  // Enters the neighbours of a polygon from a point in it at distance dist
+  const auto relax = [&](dtPolyRef ref, const vec3f& from, float dist) {
+    const dtMeshTile* tile = nullptr;
+    const dtPoly* poly = nullptr;
+    navMesh_->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+    for (unsigned int iLink = poly->firstLink; iLink != DT_NULL_LINK;
+         iLink = tile->links[iLink].next) {
+      const dtLink& link = tile->links[iLink];
+      const int neighbour = islandSystem_->polyIndex(link.ref);
+      if (neighbour == ID_UNDEFINED)
+        continue;
+
+      const dtMeshTile* neighbourTile = nullptr;
+      const dtPoly* neighbourPoly = nullptr;
+      navMesh_->getTileAndPolyByRefUnsafe(link.ref, &neighbourTile,
+                                          &neighbourPoly);
+      if (neighbourPoly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION ||
+          !filter_->passFilter(link.ref, neighbourTile, neighbourPoly))
+        continue;
+
+      vec3f left, right;
+      portalSegment(tile, poly, link, left, right);
+      const vec3f entry = closestPointOnSegment(from, left, right);
+      const float entryDist = dist + (entry - from).norm();
+      if (entryDist < f.polyDistances[neighbour]) {
+        f.polyDistances[neighbour] = entryDist;
+        f.polyEntries[neighbour] = entry;
+        queue.emplace(entryDist, link.ref);
+      }
+    }
+  };
+
+  // Every goal enters the neighbours of its polygon, so several goals in one
+  // polygon are all accounted for
+  const dtNavMeshQuery* navQuery = getWorkspace().navQuery.get();
+  for (const vec3f& goal : f.goals) {
+    dtStatus status = 0;
+    dtPolyRef goalRef = 0;
+    vec3f goalPt;
+    std::tie(status, goalRef, goalPt) =
+        projectToPoly(goal, navQuery, filter_.get());
+    if (status != DT_SUCCESS || goalRef == 0)
+      continue;
+
+    const int goalIndex = islandSystem_->polyIndex(goalRef);
+    f.polyGoals.emplace_back(goalIndex, goalPt);
+    if (f.polyDistances[goalIndex] > 0.0f) {
+      f.polyDistances[goalIndex] = 0.0f;
+      f.polyEntries[goalIndex] = goalPt;
+    }
+    relax(goalRef, goalPt, 0.0f);
+  }
+  std::sort(f.polyGoals.begin(), f.polyGoals.end(),
+            [](const std::pair<int, vec3f>& a, const std::pair<int, vec3f>& b) {
+              return a.first < b.first;
+            });
+
+  while (!queue.empty()) {
+    const Entry top = queue.top();
+    queue.pop();
+    const int index = islandSystem_->polyIndex(top.second);
+    if (top.first > f.polyDistances[index])
+      continue;
+    relax(top.second, f.polyEntries[index], top.first);
+  }
+}
+
+float PathFinder::Impl::distanceToGoals(GoalDistanceField& field,
+                                        const vec3f& pt) const {
+  if (!navMesh_)
+    return std::numeric_limits<float>::infinity();
+  GoalDistanceField::Impl& f = *field.pimpl_;
+  if (f.owner != this || f.generation != navMeshGeneration_)
+    computeGoalDistanceField(field);
+
+  dtStatus status = 0;
+  dtPolyRef ref = 0;
+  vec3f pathPt;
+  std::tie(status, ref, pathPt) =
+      projectToPoly(pt, getWorkspace().navQuery.get(), filter_.get());
+  if (status != DT_SUCCESS || ref == 0)
+    return std::numeric_limits<float>::infinity();
+
+  // Polygons are convex, so straight to the entry point of the polygon or to
+  // a goal in it
+  const int index = islandSystem_->polyIndex(ref);
+  float distance =
+      f.polyDistances[index] + (f.polyEntries[index] - pathPt).norm();
+  auto itGoal = std::lower_bound(
+      f.polyGoals.begin(), f.polyGoals.end(), index,
+      [](const std::pair<int, vec3f>& goal, int i) { return goal.first < i; });
+  for (; itGoal != f.polyGoals.end() && itGoal->first == index; ++itGoal) {
+    distance = std::min(distance, (itGoal->second - pathPt).norm());
+  }
+
+  // or through a shared edge to the entry point of a neighbour
+  const dtMeshTile* tile = nullptr;
+  const dtPoly* poly = nullptr;
+  navMesh_->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+  for (unsigned int iLink = poly->firstLink; iLink != DT_NULL_LINK;
+       iLink = tile->links[iLink].next) {
+    const dtLink& link = tile->links[iLink];
+    const int neighbour = islandSystem_->polyIndex(link.ref);
+    if (neighbour == ID_UNDEFINED ||
+        !std::isfinite(f.polyDistances[neighbour]))
+      continue;
+    vec3f left, right;
+    portalSegment(tile, poly, link, left, right);
+    const vec3f exit = closestPointOnSegment(pathPt, left, right);
+    distance = std::min(distance, (exit - pathPt).norm() +
+                                      (f.polyEntries[neighbour] - exit).norm() +
+                                      f.polyDistances[neighbour]);
   }
+  return distance;
+}
 
-  // Explore possible goal points by their minimum theoretical distance.
-  std::vector<size_t> ordering(path.pimpl_->requestedEnds.size());
-  std::iota(ordering.begin(), ordering.end(), 0);
-  std::sort(ordering.begin(), ordering.end(),
-            [&path](const size_t a, const size_t b) -> bool {
-              return path.pimpl_->minTheoreticalDist[a] <
-                     path.pimpl_->minTheoreticalDist[b];
-            });
+int PathFinder::Impl::findPaths(Cr::Containers::ArrayView<const vec3f> starts,
+                                Cr::Containers::ArrayView<const vec3f> ends,
+                                Cr::Containers::ArrayView<float> distances,
+                                std::vector<std::vector<vec3f>>* points,
+                                int numThreads) const {
+  CORRADE_ASSERT(starts.size() == ends.size() &&
+                     starts.size() == distances.size(),
+                 "PathFinder::findPaths(): expected the same number of "
+                 "starts, ends and distances but got"
+                     << starts.size() << ends.size() << distances.size(),
+                 0);
+  const int numQueries = starts.size();
+  if (points) {
+    points->resize(numQueries);
+  }
 
-  for (size_t i : ordering) {
-    if (path.pimpl_->minTheoreticalDist[i] > path.geodesicDistance)
-      continue;
+#ifdef _OPENMP
+  if (numThreads <= 0) {
+    numThreads = omp_get_max_threads();
+  }
+#else
+  numThreads = 1;
+#endif
+  numThreads = std::max(1, std::min(numThreads, numQueries));
+
+  int numFound = 0;
+#pragma omp parallel num_threads(numThreads) reduction(+ : numFound)
+  {
+    // Each worker thread uses its own Detour query and scratch buffers
+    QueryWorkspace& ws = getWorkspace();
+
+#pragma omp for schedule(dynamic, 16)
+    for (int i = 0; i < numQueries; ++i) {
+      distances[i] = std::numeric_limits<float>::infinity();
+      if (points) {
+        (*points)[i].clear();
+      }
+
+      dtStatus startStatus = 0, endStatus = 0;
+      dtPolyRef startRef = 0, endRef = 0;
+      vec3f pathStart, pathEnd;
+      std::tie(startStatus, startRef, pathStart) =
+          projectToPoly(starts[i], ws.navQuery.get(), filter_.get());
+      std::tie(endStatus, endRef, pathEnd) =
+          projectToPoly(ends[i], ws.navQuery.get(), filter_.get());
+      if (startStatus != DT_SUCCESS || startRef == 0 ||
+          endStatus != DT_SUCCESS || endRef == 0) {
+        continue;
+      }
 
-    const Cr::Containers::Optional<std::tuple<float, std::vector<vec3f>>>
-        findResult =
-            findPathInternal(path.requestedStart, startRef, pathStart,
-                             path.pimpl_->requestedEnds[i],
-                             path.pimpl_->endRefs[i], path.pimpl_->pathEnds[i]);
+      const Cr::Containers::Optional<float> findResult = findPathInternal(
+          ws, starts[i], startRef, pathStart, ends[i], endRef, pathEnd);
+      if (!findResult) {
+        continue;
+      }
 
-    if (findResult && std::get<0>(*findResult) < path.geodesicDistance) {
-      path.pimpl_->minTheoreticalDist[i] = std::get<0>(*findResult);
-      path.geodesicDistance = std::get<0>(*findResult);
-      path.points = std::get<1>(*findResult);
+      distances[i] = *findResult;
+      // distance-only queries never copy the points out of the workspace
+      if (points) {
+        (*points)[i].assign(ws.points.begin(),
+                            ws.points.begin() + ws.numPoints);
+      }
+      ++numFound;
     }
   }
 
-  return path.geodesicDistance < std::numeric_limits<float>::infinity();
+  return numFound;
 }
 
 template <typename T>
-T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
-  static const int MAX_POLYS = 256;
-  dtPolyRef polys[MAX_POLYS];
+T PathFinder::Impl::tryStep(const T& start,
+                            const T& end,
+                            bool allowSliding) const {
+  return tryStepInternal(getWorkspace(), start, 0, end, allowSliding, nullptr);
+}
 
-  dtStatus startStatus = 0, endStatus = 0;
-  dtPolyRef startRef = 0, endRef = 0;
+template <typename T>
+T PathFinder::Impl::tryStepInternal(QueryWorkspace& ws,
+                                    const T& start,
+                                    dtPolyRef startRef,
+                                    const T& end,
+                                    bool allowSliding,
+                                    dtPolyRef* endPolyRef) const {
+  dtNavMeshQuery* navQuery = ws.navQuery.get();
+  dtPolyRef* polys = ws.polys;
+
+  dtStatus startStatus = DT_SUCCESS, endStatus = 0;
+  dtPolyRef endRef = 0;
   vec3f pathStart;
-  std::tie(startStatus, startRef, pathStart) =
-      projectToPoly(start, navQuery_.get(), filter_.get());
+  // A start polygon from the previous step saves projecting the start point,
+  // unless it went stale with the navmesh or doesn't contain the start
+  if (startRef == 0 ||
+      !isOverPoly(startRef, Eigen::Map<const vec3f>(start.data()), navQuery,
+                  pathStart)) {
+    std::tie(startStatus, startRef, pathStart) =
+        projectToPoly(start, navQuery, filter_.get());
+  }
   std::tie(endStatus, endRef, std::ignore) =
-      projectToPoly(end, navQuery_.get(), filter_.get());
+      projectToPoly(end, navQuery, filter_.get());
+
+  if (endPolyRef) {
+    *endPolyRef = dtStatusFailed(startStatus) ? 0 : startRef;
+  }
 
   if (dtStatusFailed(startStatus) || dtStatusFailed(endStatus)) {
     return start;
@@ -1444,9 +3244,9 @@ T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
 
   vec3f endPoint;
   int numPolys = 0;
-  navQuery_->moveAlongSurface(startRef, pathStart.data(), end.data(),
-                              filter_.get(), endPoint.data(), polys, &numPolys,
-                              MAX_POLYS, allowSliding);
+  navQuery->moveAlongSurface(startRef, pathStart.data(), end.data(),
+                             filter_.get(), endPoint.data(), polys, &numPolys,
+                             MAX_POLYS, allowSliding);
   // If there isn't any possible path between start and end, just return
   // start, that is cleanest
   if (numPolys == 0) {
@@ -1461,7 +3261,10 @@ T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
   // surface at the endPoint and set its height to that.
   // Note, this will never fail as endPoint is always within in the poly
   // polys[numPolys - 1]
-  navQuery_->getPolyHeight(polys[numPolys - 1], endPoint.data(), &endPoint[1]);
+  navQuery->getPolyHeight(polys[numPolys - 1], endPoint.data(), &endPoint[1]);
+  if (endPolyRef) {
+    *endPolyRef = polys[numPolys - 1];
+  }
 
   // Hack to deal with infinitely thin walls in recast allowing you to
   // transition between two different connected components
@@ -1469,7 +3272,7 @@ T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
   // is in the same connected component as the startRef according to
   // findNearestPoly
   std::tie(std::ignore, endRef, std::ignore) =
-      projectToPoly(endPoint, navQuery_.get(), filter_.get());
+      projectToPoly(endPoint, navQuery, filter_.get());
   if (!this->islandSystem_->hasConnection(startRef, endRef)) {
     // There isn't a connection!  This happens when endPoint is on an edge
     // shared between two different connected components (aka infinitely thin
@@ -1497,34 +3300,178 @@ T PathFinder::Impl::tryStep(const T& start, const T& end, bool allowSliding) {
   return T{std::move(endPoint)};
 }
 
+std::tuple<dtStatus, dtPolyRef, vec3f> PathFinder::Impl::projectToPolyNear(
+    const vec3f& pt,
+    const NavLocation& hint,
+    const dtNavMeshQuery* navQuery) const {
+  const dtPolyRef hintRef = static_cast<dtPolyRef>(hint.polyRef);
+  if (hint.generation == navMeshGeneration_ && hintRef != 0 &&
+      islandSystem_->getPolyIsland(hintRef) != ID_UNDEFINED) {
+    if (pt == hint.position) {
+      return std::make_tuple(DT_SUCCESS, hintRef, hint.position);
+    }
+
+    vec3f closest;
+    if (isOverPoly(hintRef, pt, navQuery, closest)) {
+      return std::make_tuple(DT_SUCCESS, hintRef, closest);
+    }
+  }
+  return projectToPoly(pt, navQuery, filter_.get());
+}
+
+bool PathFinder::Impl::isOverPoly(const dtPolyRef ref,
+                                  const vec3f& pt,
+                                  const dtNavMeshQuery* navQuery,
+                                  vec3f& closest) const {
+  if (!navMesh_->isValidPolyRef(ref) ||
+      islandSystem_->getPolyIsland(ref) == ID_UNDEFINED) {
+    return false;
+  }
+  const dtMeshTile* tile = nullptr;
+  const dtPoly* poly = nullptr;
+  navMesh_->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+  bool posOverPoly = false;
+  return dtStatusSucceed(navQuery->closestPointOnPoly(
+             ref, pt.data(), closest.data(), &posOverPoly)) &&
+         posOverPoly &&
+         std::abs(closest[1] - pt[1]) <= tile->header->walkableClimb;
+}
+
+NavLocation PathFinder::Impl::locate(const vec3f& pt,
+                                     const NavLocation& hint) const {
+  dtStatus status = 0;
+  dtPolyRef ref = 0;
+  vec3f polyPt;
+  std::tie(status, ref, polyPt) =
+      projectToPolyNear(pt, hint, getWorkspace().navQuery.get());
+
+  NavLocation location;
+  location.generation = navMeshGeneration_;
+  if (status != DT_SUCCESS || ref == 0) {
+    location.position = pt;
+    return location;
+  }
+  location.position = polyPt;
+  location.polyRef = ref;
+  return location;
+}
+
+NavLocation PathFinder::Impl::tryStep(const NavLocation& start,
+                                      const vec3f& end,
+                                      bool allowSliding) const {
+  const dtPolyRef startRef = start.generation == navMeshGeneration_
+                                 ? static_cast<dtPolyRef>(start.polyRef)
+                                 : 0;
+  dtPolyRef endRef = 0;
+  NavLocation result;
+  result.position = tryStepInternal(getWorkspace(), start.position, startRef,
+                                    end, allowSliding, &endRef);
+  result.polyRef = endRef;
+  result.generation = navMeshGeneration_;
+  return result;
+}
+
+bool PathFinder::Impl::findPath(const NavLocation& start,
+                                const NavLocation& end,
+                                ShortestPath& path) const {
+  path.requestedStart = start.position;
+  path.requestedEnd = end.position;
+  path.geodesicDistance = std::numeric_limits<float>::infinity();
+  path.points.clear();
+
+  QueryWorkspace& ws = getWorkspace();
+  dtStatus startStatus = 0, endStatus = 0;
+  dtPolyRef startRef = 0, endRef = 0;
+  vec3f pathStart, pathEnd;
+  std::tie(startStatus, startRef, pathStart) =
+      projectToPolyNear(start.position, start, ws.navQuery.get());
+  std::tie(endStatus, endRef, pathEnd) =
+      projectToPolyNear(end.position, end, ws.navQuery.get());
+  if (startStatus != DT_SUCCESS || startRef == 0 || endStatus != DT_SUCCESS ||
+      endRef == 0) {
+    return false;
+  }
+
+  const Cr::Containers::Optional<float> findResult =
+      findPathInternal(ws, start.position, startRef, pathStart, end.position,
+                       endRef, pathEnd);
+  if (!findResult) {
+    return false;
+  }
+  path.geodesicDistance = *findResult;
+  path.points.assign(ws.points.begin(), ws.points.begin() + ws.numPoints);
+  return true;
+}
+
+int PathFinder::Impl::getIsland(const NavLocation& location) const {
+  dtStatus status = 0;
+  dtPolyRef polyRef = 0;
+  std::tie(status, polyRef, std::ignore) = projectToPolyNear(
+      location.position, location, getWorkspace().navQuery.get());
+
+  if (dtStatusSucceed(status)) {
+    return islandSystem_->getPolyIsland(polyRef);
+  }
+  return ID_UNDEFINED;
+}
+
+void PathFinder::Impl::trySteps(
+    Cr::Containers::ArrayView<const vec3f> starts,
+    Cr::Containers::ArrayView<const vec3f> ends,
+    Cr::Containers::ArrayView<vec3f> results,
+    Cr::Containers::ArrayView<std::uint64_t> polyRefs,
+    bool allowSliding,
+    int numThreads) const {
+  CORRADE_ASSERT(starts.size() == ends.size() &&
+                     starts.size() == results.size() &&
+                     (polyRefs.empty() || polyRefs.size() == starts.size()),
+                 "PathFinder::trySteps(): expected the same number of "
+                 "starts, ends, results and poly refs but got"
+                     << starts.size() << ends.size() << results.size()
+                     << polyRefs.size(), );
+  const int numSteps = starts.size();
+
+#ifdef _OPENMP
+  if (numThreads <= 0) {
+    numThreads = omp_get_max_threads();
+  }
+#else
+  numThreads = 1;
+#endif
+  numThreads = std::max(1, std::min(numThreads, numSteps));
+
+#pragma omp parallel num_threads(numThreads)
+  {
+    // Each worker thread uses its own Detour query and scratch buffers
+    QueryWorkspace& ws = getWorkspace();
+
+#pragma omp for schedule(dynamic, 16)
+    for (int i = 0; i < numSteps; ++i) {
+      const dtPolyRef startRef =
+          polyRefs.empty() ? 0 : static_cast<dtPolyRef>(polyRefs[i]);
+      dtPolyRef endRef = 0;
+      results[i] = tryStepInternal(ws, starts[i], startRef, ends[i],
+                                   allowSliding, &endRef);
+      if (!polyRefs.empty()) {
+        polyRefs[i] = endRef;
+      }
+    }
+  }
+}
+
 template <typename T>
-T PathFinder::Impl::snapPoint(const T& pt, int islandIndex /*=ID_UNDEFINED*/) {
+T PathFinder::Impl::snapPoint(const T& pt,
+                              int islandIndex /*=ID_UNDEFINED*/) const {
   islandSystem_->assertValidIsland(islandIndex);
 
-  // If this query should be island specific
-  if (islandIndex != ID_UNDEFINED) {
-    // set the poly flag to identify polys not on the target island
-    islandSystem_->setPolyFlagForIsland(
-        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
-        /*setFlag=*/true, /*invert=*/true);
-    filter_->setExcludeFlags(filter_->getExcludeFlags() |
-                             PolyFlags::POLYFLAGS_OFF_ISLAND);
-  }
+  // If this query should be island specific, restrict it with a filter
+  Cr::Containers::Optional<impl::IslandQueryFilter> islandFilter;
+  const dtQueryFilter* filter = getFilter(islandIndex, islandFilter);
 
   dtStatus status = 0;
   vec3f projectedPt;
   std::tie(status, std::ignore, projectedPt) =
-      projectToPoly(pt, navQuery_.get(), filter_.get());
-
-  // Clean up if this query was island specific
-  if (islandIndex != ID_UNDEFINED) {
-    // reset the poly flag identifing polys off the target island
-    islandSystem_->setPolyFlagForIsland(
-        navMesh_.get(), PolyFlags::POLYFLAGS_OFF_ISLAND, islandIndex,
-        /*setFlag=*/false, /*invert=*/true);
-    filter_->setExcludeFlags(filter_->getExcludeFlags() &
-                             ~PolyFlags::POLYFLAGS_OFF_ISLAND);
-  }
+      projectToPoly(pt, getWorkspace().navQuery.get(), filter);
 
   if (dtStatusSucceed(status)) {
     return T{std::move(projectedPt)};
@@ -1538,7 +3485,7 @@ int PathFinder::Impl::getIsland(const T& pt) const {
   vec3f projectedPt;
   dtPolyRef polyRef = 0;
   std::tie(status, polyRef, projectedPt) =
-      projectToPoly(pt, navQuery_.get(), filter_.get());
+      projectToPoly(pt, getWorkspace().navQuery.get(), filter_.get());
 
   if (dtStatusSucceed(status)) {
     return islandSystem_->getPolyIsland(polyRef);
@@ -1554,7 +3501,7 @@ float PathFinder::Impl::islandRadius(const vec3f& pt) const {
   dtPolyRef ptRef = 0;
   dtStatus status = 0;
   std::tie(status, ptRef, std::ignore) =
-      projectToPoly(pt, navQuery_.get(), filter_.get());
+      projectToPoly(pt, getWorkspace().navQuery.get(), filter_.get());
   if (status != DT_SUCCESS || ptRef == 0) {
     return 0.0;
   }
@@ -1564,36 +3511,168 @@ float PathFinder::Impl::islandRadius(const vec3f& pt) const {
 float PathFinder::Impl::distanceToClosestObstacle(
     const vec3f& pt,
     const float maxSearchRadius /*= 2.0*/) const {
+  if (clearanceField_ && maxSearchRadius <= clearanceField_->maxRadius()) {
+    NavLocation location;
+    location.position = pt;
+    return distanceToClosestObstacle(location, maxSearchRadius);
+  }
   return closestObstacleSurfacePoint(pt, maxSearchRadius).hitDist;
 }
 
 HitRecord PathFinder::Impl::closestObstacleSurfacePoint(
     const vec3f& pt,
     const float maxSearchRadius /*= 2.0*/) const {
+  dtNavMeshQuery* navQuery = getWorkspace().navQuery.get();
   dtPolyRef ptRef = 0;
   dtStatus status = 0;
   vec3f polyPt;
-  std::tie(status, ptRef, polyPt) =
-      projectToPoly(pt, navQuery_.get(), filter_.get());
+  std::tie(status, ptRef, polyPt) = projectToPoly(pt, navQuery, filter_.get());
   if (status != DT_SUCCESS || ptRef == 0) {
     return {vec3f(0, 0, 0), vec3f(0, 0, 0),
             std::numeric_limits<float>::infinity()};
   }
+  return closestObstacleSurfacePoint(navQuery, ptRef, polyPt, maxSearchRadius);
+}
+
+HitRecord PathFinder::Impl::closestObstacleSurfacePoint(
+    dtNavMeshQuery* navQuery,
+    dtPolyRef ref,
+    const vec3f& polyPt,
+    const float maxSearchRadius) const {
   vec3f hitPos, hitNormal;
   float hitDist = Mn::Constants::nan();
-  navQuery_->findDistanceToWall(ptRef, polyPt.data(), maxSearchRadius,
-                                filter_.get(), &hitDist, hitPos.data(),
-                                hitNormal.data());
+  navQuery->findDistanceToWall(ref, polyPt.data(), maxSearchRadius,
+                               filter_.get(), &hitDist, hitPos.data(),
+                               hitNormal.data());
   return {std::move(hitPos), std::move(hitNormal), hitDist};
 }
 
+float PathFinder::Impl::distanceToClosestObstacle(
+    const NavLocation& location,
+    const float maxSearchRadius) const {
+  dtNavMeshQuery* navQuery = getWorkspace().navQuery.get();
+  dtPolyRef ptRef = 0;
+  dtStatus status = 0;
+  vec3f polyPt;
+  std::tie(status, ptRef, polyPt) =
+      projectToPolyNear(location.position, location, navQuery);
+  if (status != DT_SUCCESS || ptRef == 0) {
+    return std::numeric_limits<float>::infinity();
+  }
+  if (clearanceField_ && maxSearchRadius <= clearanceField_->maxRadius()) {
+    const float distance =
+        clearanceField_->lookup(islandSystem_->polyIndex(ptRef), polyPt);
+    if (!std::isnan(distance)) {
+      return std::min(distance, maxSearchRadius);
+    }
+  }
+  return closestObstacleSurfacePoint(navQuery, ptRef, polyPt, maxSearchRadius)
+      .hitDist;
+}
+
+bool PathFinder::Impl::buildClearanceField(const float tolerance,
+                                           const float maxSearchRadius) {
+  if (!navMesh_ || tolerance <= 0.0f || maxSearchRadius <= 0.0f)
+    return false;
+
+  // Interpolation is off by at most sqrt(2) times the spacing
+  auto field = std::make_unique<impl::ClearanceField>(
+      tolerance / Mn::Constants::sqrt2(), maxSearchRadius);
+  const float spacing = field->spacing();
+  std::vector<impl::ClearanceField::PolyGrid>& grids = field->grids();
+  grids.resize(islandSystem_->numPolys());
+
+  // Lay out a grid over the xz bounds of every walkable polygon
+  std::vector<dtPolyRef> refs;
+  size_t numSamples = 0;
+  for (int iTile = 0; iTile < navMesh_->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh_->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+    const dtPolyRef base = navMesh_->getPolyRefBase(tile);
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPoly* poly = &tile->polys[jPoly];
+      const dtPolyRef ref = base | static_cast<dtPolyRef>(jPoly);
+      if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION ||
+          !filter_->passFilter(ref, tile, poly))
+        continue;
+
+      float xmin = std::numeric_limits<float>::infinity(), xmax = -xmin;
+      float zmin = xmin, zmax = -xmin;
+      for (int iVert = 0; iVert < poly->vertCount; ++iVert) {
+        const float* v = &tile->verts[static_cast<size_t>(poly->verts[iVert]) *
+                                      3];
+        xmin = std::min(xmin, v[0]);
+        xmax = std::max(xmax, v[0]);
+        zmin = std::min(zmin, v[2]);
+        zmax = std::max(zmax, v[2]);
+      }
+      impl::ClearanceField::PolyGrid& grid =
+          grids[islandSystem_->polyIndex(ref)];
+      grid.originX = xmin;
+      grid.originZ = zmin;
+      grid.cols = std::max(2, int(std::ceil((xmax - xmin) / spacing)) + 1);
+      grid.rows = std::max(2, int(std::ceil((zmax - zmin) / spacing)) + 1);
+      grid.offset = numSamples;
+      numSamples += size_t(grid.cols) * grid.rows;
+      refs.push_back(ref);
+    }
+  }
+
+  std::vector<float>& samples = field->samples();
+  samples.resize(numSamples);
+  const int numRefs = refs.size();
+#pragma omp parallel
+  {
+    // Each worker thread uses its own Detour query
+    dtNavMeshQuery* navQuery = getWorkspace().navQuery.get();
+
+#pragma omp for schedule(dynamic, 16)
+    for (int i = 0; i < numRefs; ++i) {
+      const dtMeshTile* tile = nullptr;
+      const dtPoly* poly = nullptr;
+      navMesh_->getTileAndPolyByRefUnsafe(refs[i], &tile, &poly);
+      vec3f polyCenter = vec3f::Zero();
+      for (int iVert = 0; iVert < poly->vertCount; ++iVert) {
+        polyCenter += Eigen::Map<const vec3f>(
+            &tile->verts[static_cast<size_t>(poly->verts[iVert]) * 3]);
+      }
+      polyCenter /= poly->vertCount;
+
+      const impl::ClearanceField::PolyGrid& grid =
+          grids[islandSystem_->polyIndex(refs[i])];
+      for (int row = 0; row < grid.rows; ++row) {
+        for (int col = 0; col < grid.cols; ++col) {
+          // Sample the closest point of the polygon to the grid node
+          const vec3f node{grid.originX + col * spacing, polyCenter[1],
+                           grid.originZ + row * spacing};
+          vec3f polyPt;
+          navQuery->closestPointOnPoly(refs[i], node.data(), polyPt.data(),
+                                       nullptr);
+          vec3f hitPos, hitNormal;
+          float hitDist = maxSearchRadius;
+          navQuery->findDistanceToWall(refs[i], polyPt.data(), maxSearchRadius,
+                                       filter_.get(), &hitDist, hitPos.data(),
+                                       hitNormal.data());
+          samples[grid.offset + size_t(row) * grid.cols + col] = hitDist;
+        }
+      }
+    }
+  }
+
+  ESP_DEBUG() << "Sampled the distance to the closest obstacle at"
+              << numSamples << "points";
+  clearanceField_ = std::move(field);
+  return true;
+}
+
 bool PathFinder::Impl::isNavigable(const vec3f& pt,
                                    const float maxYDelta /*= 0.5*/) const {
   dtPolyRef ptRef = 0;
   dtStatus status = 0;
   vec3f polyPt;
   std::tie(status, ptRef, polyPt) =
-      projectToPoly(pt, navQuery_.get(), filter_.get());
+      projectToPoly(pt, getWorkspace().navQuery.get(), filter_.get());
 
   if (status != DT_SUCCESS || ptRef == 0)
     return false;
@@ -1606,34 +3685,298 @@ bool PathFinder::Impl::isNavigable(const vec3f& pt,
   return true;
 }
 
-typedef Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> MatrixXb;
+namespace {
+// isNavigable() accepts points within this xz distance of their projection to
+// the navmesh, plus some slack for round-off
+constexpr float TOPDOWN_XZ_TOLERANCE = 1e-2f + 1e-4f;
+// Rows of the top-down view rasterized together by one thread
+constexpr int TOPDOWN_BLOCK_ROWS = 32;
+
+//! A navmesh polygon scan converted into the top-down view
+struct RasterPoly {
+  dtPolyRef ref;
+  //! walkableClimb of the tile, see dtFindNearestPolyQuery
+  float climb;
+  //! Whether the polygon reaches within climb height of the view, so the
+  //! nearest polygon query may prefer it when over it
+  bool withinClimb;
+  //! xz outline, counter clockwise
+  std::vector<Mn::Vector2> outline;
+  std::vector<Triangle> triangles;
+  Mn::Range2D xzBounds;
+};
 
-Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>
-PathFinder::Impl::getTopDownView(const float metersPerPixel,
-                                 const float height,
-                                 const float eps) const {
+//! Smallest signed distance of a point to the edges of a counter clockwise
+//! convex outline, positive inside
+float signedDistanceToOutline(const std::vector<Mn::Vector2>& outline,
+                              const Mn::Vector2& pt) {
+  float minDist = std::numeric_limits<float>::infinity();
+  for (size_t i = 0; i < outline.size(); ++i) {
+    const Mn::Vector2& a = outline[i];
+    const Mn::Vector2 edge = outline[(i + 1) % outline.size()] - a;
+    if (edge.isZero())
+      continue;
+    minDist = std::min(minDist, Mn::Math::cross(edge, pt - a) / edge.length());
+  }
+  return minDist;
+}
+
+//! Height of the detail surface of a polygon above an xz point inside it
+bool polyHeightAt(const RasterPoly& poly, const Mn::Vector2& pt, float& h) {
+  for (const Triangle& tri : poly.triangles) {
+    const Mn::Vector2 a{tri.v[0][0], tri.v[0][2]};
+    const Mn::Vector2 b{tri.v[1][0], tri.v[1][2]};
+    const Mn::Vector2 c{tri.v[2][0], tri.v[2][2]};
+    const float area = Mn::Math::cross(b - a, c - a);
+    if (std::abs(area) < 1e-12f)
+      continue;
+    const float wa = Mn::Math::cross(c - b, pt - b) / area;
+    const float wb = Mn::Math::cross(a - c, pt - c) / area;
+    const float wc = 1.0f - wa - wb;
+    constexpr float eps = -1e-4f;
+    if (wa >= eps && wb >= eps && wc >= eps) {
+      h = wa * tri.v[0][1] + wb * tri.v[1][1] + wc * tri.v[2][1];
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+std::vector<dtPolyRef> PathFinder::Impl::rasterizeTopDownView(
+    const float metersPerPixel,
+    const float height,
+    const float eps,
+    int& xResolution,
+    int& zResolution) const {
   std::pair<vec3f, vec3f> mapBounds = bounds();
   vec3f bound1 = std::move(mapBounds.first);
   vec3f bound2 = std::move(mapBounds.second);
 
   float xspan = std::abs(bound1[0] - bound2[0]);
   float zspan = std::abs(bound1[2] - bound2[2]);
-  int xResolution = xspan / metersPerPixel;
-  int zResolution = zspan / metersPerPixel;
+  xResolution = xspan / metersPerPixel;
+  zResolution = zspan / metersPerPixel;
   float startx = fmin(bound1[0], bound2[0]);
   float startz = fmin(bound1[2], bound2[2]);
-  MatrixXb topdownMap(zResolution, xResolution);
-
-  float curz = startz;
+  std::vector<dtPolyRef> refs(size_t(std::max(xResolution, 0)) *
+                                  std::max(zResolution, 0),
+                              0);
+  if (refs.empty())
+    return refs;
+
+  // Pixel positions, accumulated like the per pixel queries always did
+  std::vector<float> xs(xResolution), zs(zResolution);
   float curx = startx;
+  for (int w = 0; w < xResolution; ++w) {
+    xs[w] = curx;
+    curx = curx + metersPerPixel;
+  }
+  float curz = startz;
+  for (int h = 0; h < zResolution; ++h) {
+    zs[h] = curz;
+    curz = curz + metersPerPixel;
+  }
+
+  // Polygons which the nearest polygon query could find or prefer at this
+  // height
+  std::vector<RasterPoly> polys;
+  for (int iTile = 0; iTile < navMesh_->getMaxTiles(); ++iTile) {
+    const dtMeshTile* tile = navMesh_->getTile(iTile);
+    if (!tile || !tile->header)
+      continue;
+    const float climb = tile->header->walkableClimb;
+    const float yRange = std::max({polyPickExt[1], eps, climb}) + 1e-3f;
+    const dtPolyRef base = navMesh_->getPolyRefBase(tile);
+    for (int jPoly = 0; jPoly < tile->header->polyCount; ++jPoly) {
+      const dtPoly* poly = &tile->polys[jPoly];
+      const dtPolyRef ref = base | static_cast<dtPolyRef>(jPoly);
+      if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION ||
+          !filter_->passFilter(ref, tile, poly))
+        continue;
+
+      RasterPoly rasterPoly{
+          ref, climb, false, {}, getPolygonTriangles(poly, tile), {}};
+      float ymin = std::numeric_limits<float>::infinity();
+      float ymax = -ymin;
+      for (const Triangle& tri : rasterPoly.triangles) {
+        for (const vec3f& v : tri.v) {
+          ymin = std::min(ymin, v[1]);
+          ymax = std::max(ymax, v[1]);
+        }
+      }
+      if (ymin > height + yRange || ymax < height - yRange)
+        continue;
+      rasterPoly.withinClimb = ymin <= height + climb + 1e-3f &&
+                               ymax >= height - climb - 1e-3f;
+
+      float area = 0.0f;
+      for (int iVert = 0; iVert < poly->vertCount; ++iVert) {
+        const float* v = &tile->verts[static_cast<size_t>(poly->verts[iVert]) *
+                                      3];
+        rasterPoly.outline.emplace_back(v[0], v[2]);
+      }
+      for (size_t i = 0; i < rasterPoly.outline.size(); ++i) {
+        area += Mn::Math::cross(
+            rasterPoly.outline[i],
+            rasterPoly.outline[(i + 1) % rasterPoly.outline.size()]);
+      }
+      if (area < 0.0f) {
+        std::reverse(rasterPoly.outline.begin(), rasterPoly.outline.end());
+      }
+      Mn::Vector2 xzMin{std::numeric_limits<float>::infinity()};
+      Mn::Vector2 xzMax{-std::numeric_limits<float>::infinity()};
+      for (const Mn::Vector2& v : rasterPoly.outline) {
+        xzMin = Mn::Math::min(xzMin, v);
+        xzMax = Mn::Math::max(xzMax, v);
+      }
+      rasterPoly.xzBounds = Mn::Range2D{xzMin, xzMax}.padded(
+          Mn::Vector2{TOPDOWN_XZ_TOLERANCE});
+      polys.emplace_back(std::move(rasterPoly));
+    }
+  }
+
+  // Bucket the polygons by the blocks of rows they overlap
+  const int numBlocks =
+      (zResolution + TOPDOWN_BLOCK_ROWS - 1) / TOPDOWN_BLOCK_ROWS;
+  std::vector<std::vector<int>> blockPolys(numBlocks);
+  for (int i = 0; i < int(polys.size()); ++i) {
+    const Mn::Range2D& b = polys[i].xzBounds;
+    const int firstRow =
+        std::lower_bound(zs.begin(), zs.end(), b.min().y()) - zs.begin();
+    const int lastRow =
+        std::upper_bound(zs.begin(), zs.end(), b.max().y()) - zs.begin() - 1;
+    if (firstRow > lastRow)
+      continue;
+    for (int block = firstRow / TOPDOWN_BLOCK_ROWS;
+         block <= lastRow / TOPDOWN_BLOCK_ROWS; ++block) {
+      blockPolys[block].push_back(i);
+    }
+  }
+
+#pragma omp parallel
+  {
+    // Each thread uses its own Detour query for the pixels which need one
+    const dtNavMeshQuery* navQuery = getWorkspace().navQuery.get();
+    // Number of polygons within the xz tolerance of each pixel of a block and
+    // the polygon the pixel is inside of by more than it, if any. Separately
+    // for the polygons within climb height.
+    std::vector<int> coverage, interior, climbCoverage, climbInterior;
+
+#pragma omp for schedule(dynamic)
+    for (int block = 0; block < numBlocks; ++block) {
+      const int firstRow = block * TOPDOWN_BLOCK_ROWS;
+      const int numRows =
+          std::min(TOPDOWN_BLOCK_ROWS, zResolution - firstRow);
+      coverage.assign(size_t(numRows) * xResolution, 0);
+      interior.assign(size_t(numRows) * xResolution, ID_UNDEFINED);
+      climbCoverage.assign(size_t(numRows) * xResolution, 0);
+      climbInterior.assign(size_t(numRows) * xResolution, ID_UNDEFINED);
+
+      for (int i : blockPolys[block]) {
+        const RasterPoly& poly = polys[i];
+        const int firstCol = std::lower_bound(xs.begin(), xs.end(),
+                                              poly.xzBounds.min().x()) -
+                             xs.begin();
+        const int lastCol = std::upper_bound(xs.begin(), xs.end(),
+                                             poly.xzBounds.max().x()) -
+                            xs.begin() - 1;
+        const int rowBegin = std::max<int>(
+            firstRow, std::lower_bound(zs.begin(), zs.end(),
+                                       poly.xzBounds.min().y()) -
+                          zs.begin());
+        const int rowEnd = std::min<int>(
+            firstRow + numRows, std::upper_bound(zs.begin(), zs.end(),
+                                                 poly.xzBounds.max().y()) -
+                                    zs.begin());
+        for (int h = rowBegin; h < rowEnd; ++h) {
+          for (int w = firstCol; w <= lastCol; ++w) {
+            const float dist =
+                signedDistanceToOutline(poly.outline, {xs[w], zs[h]});
+            if (dist < -TOPDOWN_XZ_TOLERANCE)
+              continue;
+            const size_t pixel = size_t(h - firstRow) * xResolution + w;
+            ++coverage[pixel];
+            if (dist > TOPDOWN_XZ_TOLERANCE)
+              interior[pixel] = i;
+            if (poly.withinClimb) {
+              ++climbCoverage[pixel];
+              if (dist > TOPDOWN_XZ_TOLERANCE)
+                climbInterior[pixel] = i;
+            }
+          }
+        }
+      }
+
+      for (int h = firstRow; h < firstRow + numRows; ++h) {
+        for (int w = 0; w < xResolution; ++w) {
+          const size_t pixel = size_t(h - firstRow) * xResolution + w;
+          dtPolyRef& ref = refs[size_t(h) * xResolution + w];
+          // No polygon close enough for the projection to be accepted
+          if (coverage[pixel] == 0)
+            continue;
+
+          // Detour picks a polygon the point is over if it's within climb
+          // height and no other polygon within climb height is close enough
+          // to tie with it
+          float polyHeight = 0.0f;
+          if (climbCoverage[pixel] == 1 &&
+              climbInterior[pixel] != ID_UNDEFINED &&
+              polyHeightAt(polys[climbInterior[pixel]], {xs[w], zs[h]},
+                           polyHeight)) {
+            const RasterPoly& poly = polys[climbInterior[pixel]];
+            const float dy = std::abs(polyHeight - height);
+            if (dy <= poly.climb) {
+              ref = dy <= eps ? poly.ref : 0;
+              continue;
+            }
+          }
+          // With a single polygon around which is too low or high, any other
+          // polygon the query could pick instead is too far away in xz
+          if (coverage[pixel] == 1 && interior[pixel] != ID_UNDEFINED &&
+              polyHeightAt(polys[interior[pixel]], {xs[w], zs[h]},
+                           polyHeight)) {
+            const float dy = std::abs(polyHeight - height);
+            if (dy > polys[interior[pixel]].climb && dy > eps)
+              continue;
+          }
+
+          // Otherwise ask Detour, exactly like isNavigable()
+          const vec3f point(xs[w], height, zs[h]);
+          dtStatus status = 0;
+          dtPolyRef ptRef = 0;
+          vec3f polyPt;
+          std::tie(status, ptRef, polyPt) =
+              projectToPoly(point, navQuery, filter_.get());
+          if (status != DT_SUCCESS || ptRef == 0 ||
+              std::abs(polyPt[1] - point[1]) > eps ||
+              (Eigen::Vector2f(point[0], point[2]) -
+               Eigen::Vector2f(polyPt[0], polyPt[2]))
+                      .norm() > 1e-2)
+            continue;
+          ref = ptRef;
+        }
+      }
+    }
+  }
+
+  return refs;
+}
+
+typedef Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> MatrixXb;
+
+Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>
+PathFinder::Impl::getTopDownView(const float metersPerPixel,
+                                 const float height,
+                                 const float eps) const {
+  int xResolution = 0, zResolution = 0;
+  const std::vector<dtPolyRef> refs = rasterizeTopDownView(
+      metersPerPixel, height, eps, xResolution, zResolution);
+  MatrixXb topdownMap(zResolution, xResolution);
   for (int h = 0; h < zResolution; ++h) {
     for (int w = 0; w < xResolution; ++w) {
-      vec3f point = vec3f(curx, height, curz);
-      topdownMap(h, w) = isNavigable(point, eps);
-      curx = curx + metersPerPixel;
+      topdownMap(h, w) = refs[size_t(h) * xResolution + w] != 0;
     }
-    curz = curz + metersPerPixel;
-    curx = startx;
   }
 
   return topdownMap;
@@ -1644,33 +3987,16 @@ typedef Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic> MatrixXi;
 MatrixXi PathFinder::Impl::getTopDownIslandView(const float metersPerPixel,
                                                 const float height,
                                                 const float eps) const {
-  std::pair<vec3f, vec3f> mapBounds = bounds();
-  vec3f bound1 = std::move(mapBounds.first);
-  vec3f bound2 = std::move(mapBounds.second);
-
-  float xspan = std::abs(bound1[0] - bound2[0]);
-  float zspan = std::abs(bound1[2] - bound2[2]);
-  int xResolution = xspan / metersPerPixel;
-  int zResolution = zspan / metersPerPixel;
-  float startx = fmin(bound1[0], bound2[0]);
-  float startz = fmin(bound1[2], bound2[2]);
+  int xResolution = 0, zResolution = 0;
+  const std::vector<dtPolyRef> refs = rasterizeTopDownView(
+      metersPerPixel, height, eps, xResolution, zResolution);
   MatrixXi topdownMap(zResolution, xResolution);
-
-  float curz = startz;
-  float curx = startx;
   for (int h = 0; h < zResolution; ++h) {
     for (int w = 0; w < xResolution; ++w) {
-      vec3f point = vec3f(curx, height, curz);
-      if (isNavigable(point, eps)) {
-        // get the island
-        topdownMap(h, w) = getIsland(point);
-      } else {
-        topdownMap(h, w) = -1;
-      }
-      curx = curx + metersPerPixel;
+      const dtPolyRef ref = refs[size_t(h) * xResolution + w];
+      topdownMap(h, w) =
+          ref != 0 ? islandSystem_->getPolyIsland(ref) : ID_UNDEFINED;
     }
-    curz = curz + metersPerPixel;
-    curx = startx;
   }
 
   return topdownMap;
@@ -1743,11 +4069,37 @@ bool PathFinder::build(const NavMeshSettings& bs,
   return pimpl_->build(bs, mesh);
 }
 
+bool PathFinder::rebuildRegions(
+    const esp::assets::MeshData& mesh,
+    const std::vector<std::pair<vec3f, vec3f>>& regions) {
+  return pimpl_->rebuildRegions(mesh, regions);
+}
+
 vec3f PathFinder::getRandomNavigablePoint(const int maxTries /*= 10*/,
                                           int islandIndex /*= ID_UNDEFINED*/) {
   return pimpl_->getRandomNavigablePoint(maxTries, islandIndex);
 }
 
+vec3f PathFinder::getRandomNavigablePoint(
+    core::Random& rng,
+    const int maxTries /*= 10*/,
+    int islandIndex /*= ID_UNDEFINED*/) const {
+  return pimpl_->getRandomNavigablePoint(rng, maxTries, islandIndex);
+}
+
+std::vector<vec3f> PathFinder::getRandomNavigablePoints(
+    const int numPoints,
+    int islandIndex /*= ID_UNDEFINED*/) {
+  return pimpl_->getRandomNavigablePoints(numPoints, islandIndex);
+}
+
+std::vector<vec3f> PathFinder::getRandomNavigablePoints(
+    core::Random& rng,
+    const int numPoints,
+    int islandIndex /*= ID_UNDEFINED*/) const {
+  return pimpl_->getRandomNavigablePoints(rng, numPoints, islandIndex);
+}
+
 vec3f PathFinder::getRandomNavigablePointAroundSphere(
     const vec3f& circleCenter,
     const float radius,
@@ -1757,6 +4109,16 @@ vec3f PathFinder::getRandomNavigablePointAroundSphere(
                                                      maxTries, islandIndex);
 }
 
+vec3f PathFinder::getRandomNavigablePointAroundSphere(
+    core::Random& rng,
+    const vec3f& circleCenter,
+    const float radius,
+    const int maxTries,
+    int islandIndex /*= ID_UNDEFINED*/) const {
+  return pimpl_->getRandomNavigablePointAroundSphere(rng, circleCenter, radius,
+                                                     maxTries, islandIndex);
+}
+
 bool PathFinder::findPath(ShortestPath& path) {
   return pimpl_->findPath(path);
 }
@@ -1765,6 +4127,19 @@ bool PathFinder::findPath(MultiGoalShortestPath& path) {
   return pimpl_->findPath(path);
 }
 
+int PathFinder::findPaths(Cr::Containers::ArrayView<const vec3f> starts,
+                          Cr::Containers::ArrayView<const vec3f> ends,
+                          Cr::Containers::ArrayView<float> distances,
+                          std::vector<std::vector<vec3f>>* points,
+                          int numThreads) {
+  return pimpl_->findPaths(starts, ends, distances, points, numThreads);
+}
+
+float PathFinder::distanceToGoals(GoalDistanceField& field,
+                                  const vec3f& pt) {
+  return pimpl_->distanceToGoals(field, pt);
+}
+
 template vec3f PathFinder::tryStep<vec3f>(const vec3f&, const vec3f&);
 template Mn::Vector3 PathFinder::tryStep<Mn::Vector3>(const Mn::Vector3&,
                                                       const Mn::Vector3&);
@@ -1784,6 +4159,38 @@ T PathFinder::tryStepNoSliding(const T& start, const T& end) {
   return pimpl_->tryStep(start, end, /*allowSliding=*/false);
 }
 
+NavLocation PathFinder::tryStep(const NavLocation& start, const vec3f& end) {
+  return pimpl_->tryStep(start, end, /*allowSliding=*/true);
+}
+
+NavLocation PathFinder::tryStepNoSliding(const NavLocation& start,
+                                         const vec3f& end) {
+  return pimpl_->tryStep(start, end, /*allowSliding=*/false);
+}
+
+NavLocation PathFinder::locate(const vec3f& pt, const NavLocation& hint) {
+  return pimpl_->locate(pt, hint);
+}
+
+bool PathFinder::findPath(const NavLocation& start,
+                          const NavLocation& end,
+                          ShortestPath& path) {
+  return pimpl_->findPath(start, end, path);
+}
+
+int PathFinder::getIsland(const NavLocation& location) {
+  return pimpl_->getIsland(location);
+}
+
+void PathFinder::trySteps(Cr::Containers::ArrayView<const vec3f> starts,
+                          Cr::Containers::ArrayView<const vec3f> ends,
+                          Cr::Containers::ArrayView<vec3f> results,
+                          Cr::Containers::ArrayView<std::uint64_t> polyRefs,
+                          bool allowSliding,
+                          int numThreads) {
+  pimpl_->trySteps(starts, ends, results, polyRefs, allowSliding, numThreads);
+}
+
 template vec3f PathFinder::snapPoint<vec3f>(const vec3f& pt, int islandIndex);
 template Mn::Vector3 PathFinder::snapPoint<Mn::Vector3>(const Mn::Vector3& pt,
                                                         int islandIndex);
@@ -1801,14 +4208,44 @@ int PathFinder::getIsland(const T& pt) {
   return pimpl_->getIsland(pt);
 }
 
-bool PathFinder::loadNavMesh(const std::string& path) {
-  return pimpl_->loadNavMesh(path);
+bool PathFinder::loadNavMesh(const std::string& path,
+                             const bool memoryMap /*= false*/) {
+  return pimpl_->loadNavMesh(path, memoryMap);
 }
 
 bool PathFinder::saveNavMesh(const std::string& path) {
   return pimpl_->saveNavMesh(path);
 }
 
+bool PathFinder::buildClearanceField(float tolerance, float maxSearchRadius) {
+  return pimpl_->buildClearanceField(tolerance, maxSearchRadius);
+}
+
+bool PathFinder::hasClearanceField() const {
+  return pimpl_->hasClearanceField();
+}
+
+bool PathFinder::buildLandmarkIndex(int numLandmarks) {
+  return pimpl_->buildLandmarkIndex(numLandmarks);
+}
+
+bool PathFinder::hasLandmarkIndex() const {
+  return pimpl_->hasLandmarkIndex();
+}
+
+bool PathFinder::loadLandmarkIndex(const std::string& path) {
+  return pimpl_->loadLandmarkIndex(path);
+}
+
+bool PathFinder::saveLandmarkIndex(const std::string& path) const {
+  return pimpl_->saveLandmarkIndex(path);
+}
+
+float PathFinder::estimateGeodesicDistance(const vec3f& start,
+                                           const vec3f& end) const {
+  return pimpl_->estimateGeodesicDistance(start, end);
+}
+
 bool PathFinder::isLoaded() const {
   return pimpl_->isLoaded();
 }
@@ -1834,6 +4271,11 @@ float PathFinder::distanceToClosestObstacle(const vec3f& pt,
   return pimpl_->distanceToClosestObstacle(pt, maxSearchRadius);
 }
 
+float PathFinder::distanceToClosestObstacle(const NavLocation& location,
+                                           const float maxSearchRadius) const {
+  return pimpl_->distanceToClosestObstacle(location, maxSearchRadius);
+}
+
 HitRecord PathFinder::closestObstacleSurfacePoint(
     const vec3f& pt,
     const float maxSearchRadius) const {
@@ -5,12 +5,15 @@
 #ifndef ESP_NAV_PATHFINDER_H_
 #define ESP_NAV_PATHFINDER_H_
 
+#include <Corrade/Containers/ArrayViewStl.h>
 #include <Corrade/Containers/Optional.h>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "esp/core/Esp.h"
 #include "esp/core/EspEigen.h"
+#include "esp/core/Random.h"
 
 namespace esp {
 // forward declaration
@@ -36,6 +39,31 @@ struct HitRecord {
   float hitDist{};
 };
 
+/**
+ * @brief A point on the navigation mesh together with the navmesh polygon
+ * containing it.
+ *
+ * Returned by @ref PathFinder::locate and the @ref PathFinder::tryStep
+ * overloads taking one, and accepted by other @ref PathFinder queries in place
+ * of a point. Queries reuse the cached polygon while the point stays over it,
+ * which checks a single polygon instead of searching the navmesh. A location
+ * of another PathFinder or of a navmesh which was since rebuilt or replaced
+ * is projected again.
+ */
+struct NavLocation {
+  //! The point on the navmesh
+  vec3f position;
+
+  //! Opaque navmesh polygon containing @ref position, 0 if the point isn't on
+  //! the navmesh
+  std::uint64_t polyRef{};
+
+  //! The navmesh @ref polyRef belongs to
+  int generation{};
+
+  ESP_SMART_POINTERS(NavLocation)
+};
+
 /**
  * @brief Struct for shortest path finding. Used in conjunction with @ref
  * PathFinder.findPath
@@ -110,6 +138,30 @@ struct MultiGoalShortestPath {
   ESP_SMART_POINTERS_WITH_UNIQUE_PIMPL(MultiGoalShortestPath)
 };
 
+/**
+ * @brief Geodesic distance field to a fixed set of goal points. Used in
+ * conjunction with @ref PathFinder::distanceToGoals
+ *
+ * The distances of all navmesh polygons to the closest goal are computed once
+ * by the first query, so querying the distance to the same goals from many
+ * points costs a projection to the navmesh per point instead of a path
+ * search. Recomputed when the goals or the navmesh change.
+ */
+struct GoalDistanceField {
+  GoalDistanceField();
+
+  /**
+   * @brief Set the goal points
+   */
+  void setGoals(const std::vector<vec3f>& newGoals);
+
+  const std::vector<vec3f>& getGoals() const;
+
+  friend class PathFinder;
+
+  ESP_SMART_POINTERS_WITH_UNIQUE_PIMPL(GoalDistanceField)
+};
+
 /**
  * @brief Configuration structure for NavMesh generation with recast.
  *
@@ -249,6 +301,15 @@ struct NavMeshSettings {
    */
   bool filterWalkableLowHeightSpans{};
 
+  /**
+   * @brief Width and depth of the navmesh tiles in voxels.
+   *
+   * If positive, the scene is partitioned into square tiles of this many cells
+   * which are built concurrently and assembled into a multi-tile NavMesh. Zero
+   * builds the whole scene as a single tile.
+   */
+  int tileSize{};
+
   void setDefaults() {
     cellSize = 0.05f;
     cellHeight = 0.2f;
@@ -266,6 +327,7 @@ struct NavMeshSettings {
     filterLowHangingObstacles = true;
     filterLedgeSpans = true;
     filterWalkableLowHeightSpans = true;
+    tileSize = 0;
   }
 
   //! Load the settings from a JSON file
@@ -290,6 +352,21 @@ bool operator==(const NavMeshSettings& a, const NavMeshSettings& b);
  */
 bool operator!=(const NavMeshSettings& a, const NavMeshSettings& b);
 
+/**
+ * @brief Content hash identifying the navmesh built from @p mesh with @p
+ * settings.
+ *
+ * Hashes the vertex and index buffers of the mesh, every field of the
+ * settings and the .navmesh file format version with 64-bit FNV-1a, which,
+ * unlike std::hash, is the same across processes and builds. Meant as the
+ * file name of a navmesh cache shared between processes, see @ref
+ * sim::SimulatorConfiguration::navMeshCacheDir.
+ *
+ * @return The hash as 16 lowercase hex digits
+ */
+std::string navMeshCacheKey(const NavMeshSettings& settings,
+                            const esp::assets::MeshData& mesh);
+
 /** @brief Loads and/or builds a navigation mesh and then allows point sampling,
  * path finding, collision, and island queries on that navmesh.
  *
@@ -313,6 +390,13 @@ bool operator!=(const NavMeshSettings& a, const NavMeshSettings& b);
  * surfaces of solid voxels where the cylinder would sit without intersection or
  * overhanging and respecting configured constraints such as maximum climbable
  * slope and step-height.
+ *
+ * Once a navmesh is built or loaded, queries never modify it: each calling
+ * thread gets its own Detour query object and island restricted queries use a
+ * per-call filter. Queries may therefore be issued concurrently from several
+ * threads, except for the point sampling overloads which use the
+ * PathFinder's own random generator (see @ref seed) and @ref getNavMeshData.
+ * Building or loading a navmesh must not happen concurrently with queries.
  */
 class PathFinder {
  public:
@@ -357,11 +441,35 @@ class PathFinder {
    */
   bool build(const NavMeshSettings& bs, const esp::assets::MeshData& mesh);
 
+  /**
+   * @brief Rebuild the tiles of a tiled NavMesh which overlap the given
+   * regions, leaving all other tiles untouched.
+   *
+   * Only valid for a NavMesh built or loaded with a positive
+   * @ref NavMeshSettings::tileSize, which are reused for the rebuild. Islands
+   * away from the rebuilt tiles keep their data, but island indices may change
+   * and references into the rebuilt tiles become invalid. Must not be called
+   * concurrently with queries.
+   *
+   * @param mesh The joined mesh of the whole scene after the change.
+   * @param regions World space (min, max) corners of the boxes that changed.
+   * Include both the old and new bounds of moved geometry.
+   *
+   * @return Whether or not the rebuild was successful. On failure the NavMesh
+   * may be partially updated and should be rebuilt with @ref build.
+   */
+  bool rebuildRegions(const esp::assets::MeshData& mesh,
+                      const std::vector<std::pair<vec3f, vec3f>>& regions);
+
   /**
    * @brief Returns a random navigable point.
    *
-   *  @param[in] maxTries The maximum number of tries sampling will be retried
-   * if it fails.
+   * Points are distributed uniformly over the navigable area of the island (or
+   * navmesh) and sampled in constant time from per-island alias tables
+   * precomputed when the navmesh is built or loaded.
+   *
+   *  @param[in] maxTries Unused, sampling from the precomputed tables cannot
+   * fail. Kept for API compatibility.
    *  @param[in] islandIndex Optionally specify the island from which to sample
    * the point. Default -1 queries the full navmesh.
    *
@@ -374,6 +482,38 @@ class PathFinder {
   vec3f getRandomNavigablePoint(int maxTries = 10,
                                 int islandIndex = ID_UNDEFINED);
 
+  /**
+   * @brief Same as @ref getRandomNavigablePoint but samples with the
+   * caller's random generator.
+   *
+   * Safe to call concurrently from several threads as long as each thread
+   * passes a different @p rng.
+   */
+  vec3f getRandomNavigablePoint(core::Random& rng,
+                                int maxTries = 10,
+                                int islandIndex = ID_UNDEFINED) const;
+
+  /**
+   * @brief Returns @p numPoints random navigable points in one call.
+   *
+   * Equivalent to calling @ref getRandomNavigablePoint @p numPoints times.
+   *
+   *  @param[in] numPoints The number of points to sample.
+   *  @param[in] islandIndex Optionally specify the island from which to sample
+   * the points. Default -1 queries the full navmesh.
+   */
+  std::vector<vec3f> getRandomNavigablePoints(int numPoints,
+                                              int islandIndex = ID_UNDEFINED);
+
+  /**
+   * @brief Same as @ref getRandomNavigablePoints but samples with the
+   * caller's random generator.
+   */
+  std::vector<vec3f> getRandomNavigablePoints(
+      core::Random& rng,
+      int numPoints,
+      int islandIndex = ID_UNDEFINED) const;
+
   /**
    * @brief Returns a random navigable point within a specified radius about a
    * given point.
@@ -396,6 +536,20 @@ class PathFinder {
                                             int maxTries = 10,
                                             int islandIndex = ID_UNDEFINED);
 
+  /**
+   * @brief Same as @ref getRandomNavigablePointAroundSphere but samples with
+   * the caller's random generator.
+   *
+   * Safe to call concurrently from several threads as long as each thread
+   * passes a different @p rng.
+   */
+  vec3f getRandomNavigablePointAroundSphere(
+      core::Random& rng,
+      const vec3f& circleCenter,
+      float radius,
+      int maxTries = 10,
+      int islandIndex = ID_UNDEFINED) const;
+
   /**
    * @brief Finds the shortest path between two points on the navigation mesh
    *
@@ -429,6 +583,68 @@ class PathFinder {
    */
   bool findPath(MultiGoalShortestPath& path);
 
+  /**
+   * @brief Same as @ref findPath(ShortestPath&) between two locations,
+   * reusing their cached polygons.
+   *
+   * @param[in] start The start location.
+   * @param[in] end The end location.
+   * @param[out] path Filled with the requested points, the path and its
+   * geodesic distance.
+   *
+   * @return Whether or not a path exists between the locations.
+   */
+  bool findPath(const NavLocation& start,
+                const NavLocation& end,
+                ShortestPath& path);
+
+  /**
+   * @brief Finds the shortest paths between a batch of start and end point
+   * pairs.
+   *
+   * Queries are distributed over worker threads, each with its own Detour
+   * query object and scratch buffers, so no per-query allocations are made in
+   * distance-only mode.
+   *
+   * @param[in] starts The starting point of each path.
+   * @param[in] ends The end point of each path. Must be the same size as @p
+   * starts.
+   * @param[out] distances Filled with the geodesic distance of each path or
+   * inf if no path exists. Must be the same size as @p starts.
+   * @param[out] points If not null, resized to the number of queries and
+   * filled with the points of each path (empty if no path exists). Pass
+   * nullptr to only compute distances.
+   * @param[in] numThreads The number of worker threads. Values <= 0 use the
+   * OpenMP default.
+   *
+   * @return The number of pairs for which a path exists.
+   */
+  int findPaths(Corrade::Containers::ArrayView<const vec3f> starts,
+                Corrade::Containers::ArrayView<const vec3f> ends,
+                Corrade::Containers::ArrayView<float> distances,
+                std::vector<std::vector<vec3f>>* points = nullptr,
+                int numThreads = 0);
+
+  /**
+   * @brief Geodesic distance from a point to the closest goal of a goal
+   * distance field.
+   *
+   * The first query after the goals or the navmesh changed runs one
+   * multi-source Dijkstra search from all goals over the navmesh polygons.
+   * Later queries only project @p pt to the navmesh and look at its polygon
+   * and the neighbouring ones.
+   *
+   * The distances are lengths of paths crossing each polygon edge at a single
+   * point, so they are never shorter and usually slightly longer than the
+   * distance found by @ref findPath.
+   *
+   * @param[inout] field The goals, caching their distance field.
+   * @param[in] pt The point to measure the distance from.
+   *
+   * @return The distance, or inf if no goal is reachable from @p pt.
+   */
+  float distanceToGoals(GoalDistanceField& field, const vec3f& pt);
+
   /**
    * @brief Attempts to move from @ref start to @ref end and returns the
    * navigable point closest to @ref end that is feasibly reachable from @ref
@@ -448,6 +664,58 @@ class PathFinder {
   template <typename T>
   T tryStepNoSliding(const T& start, const T& end);
 
+  /**
+   * @brief Same as @ref tryStep but starting from and returning a
+   * @ref NavLocation, so the start point is never projected to the navmesh
+   * again.
+   */
+  NavLocation tryStep(const NavLocation& start, const vec3f& end);
+
+  /**
+   * @brief Same as @ref tryStepNoSliding but starting from and returning a
+   * @ref NavLocation.
+   */
+  NavLocation tryStepNoSliding(const NavLocation& start, const vec3f& end);
+
+  /**
+   * @brief Snaps a point to the navigation mesh, keeping the polygon it is
+   * on for later queries.
+   *
+   * @param[in] pt The point to snap to the navigation mesh.
+   * @param[in] hint A nearby location, e.g. that of the point at the previous
+   * step. While @p pt is over the polygon of @p hint and within climb height
+   * of it, that polygon is used without searching the navmesh.
+   *
+   * @return The location. Its @ref NavLocation::polyRef is 0 if no navigable
+   * point was within a reasonable distance.
+   */
+  NavLocation locate(const vec3f& pt, const NavLocation& hint = {});
+
+  /**
+   * @brief Same as @ref tryStep or @ref tryStepNoSliding for a batch of
+   * agents, distributed over worker threads.
+   *
+   * @param[in] starts The starting location of each agent.
+   * @param[in] ends The desired end location of each agent. Must be the same
+   * size as @p starts.
+   * @param[out] results Filled with the found end location of each agent.
+   * Must be the same size as @p starts.
+   * @param[inout] polyRefs Optional navmesh polygon of each start location,
+   * as returned for it by the previous step, or 0 where unknown. Known
+   * polygons save projecting the start locations to the navmesh. Set to the
+   * polygon of each result, to be passed to the next step. Pass an empty view
+   * to always project the start locations.
+   * @param[in] allowSliding Whether agents may slide along walls.
+   * @param[in] numThreads The number of worker threads. Values <= 0 use the
+   * OpenMP default.
+   */
+  void trySteps(Corrade::Containers::ArrayView<const vec3f> starts,
+                Corrade::Containers::ArrayView<const vec3f> ends,
+                Corrade::Containers::ArrayView<vec3f> results,
+                Corrade::Containers::ArrayView<std::uint64_t> polyRefs = {},
+                bool allowSliding = true,
+                int numThreads = 0);
+
   /**
    * @brief Snaps a point to the navigation mesh.
    *
@@ -479,6 +747,11 @@ class PathFinder {
   template <typename T>
   int getIsland(const T& pt);
 
+  /**
+   * @brief Same as @ref getIsland for a location, reusing its cached polygon.
+   */
+  int getIsland(const NavLocation& location);
+
   /**
    * @brief Loads a navigation meshed saved by @ref saveNavMesh
    *
@@ -486,10 +759,15 @@ class PathFinder {
    *
    * @param[in] path The saved navigation mesh file, generally has extension
    * ``.navmesh``
+   * @param[in] memoryMap Map the file into memory and use its tiles in place
+   * instead of reading them into allocated copies. The pages of the file
+   * Detour doesn't modify are shared through the page cache with every other
+   * process mapping it. The file must not be modified while loaded. Falls back
+   * to reading the file where memory mapping isn't supported.
    *
    * @return Whether or not the navmesh was successfully loaded
    */
-  bool loadNavMesh(const std::string& path);
+  bool loadNavMesh(const std::string& path, bool memoryMap = false);
 
   /**
    * @brief Saves a navigation mesh to later be loaded by @ref loadNavMesh
@@ -502,6 +780,69 @@ class PathFinder {
    */
   bool saveNavMesh(const std::string& path);
 
+  /**
+   * @brief Precompute geodesic distances from a few landmark polygons to every
+   * polygon of the navmesh.
+   *
+   * Landmarks are selected by farthest point sampling on the largest island.
+   * The table gives constant time estimates of the geodesic distance between
+   * any two points through the triangle inequality, used by
+   * @ref estimateGeodesicDistance and to explore the goals of a
+   * @ref MultiGoalShortestPath nearest first. Takes O(numLandmarks * n log n)
+   * for n polygons.
+   *
+   * The index is discarded whenever the navmesh is built, loaded or rebuilt.
+   *
+   * @param[in] numLandmarks The number of landmarks. More landmarks give
+   * tighter estimates at the cost of numLandmarks floats per polygon.
+   *
+   * @return Whether or not the index was built.
+   */
+  bool buildLandmarkIndex(int numLandmarks = 8);
+
+  /**
+   * @return If a landmark index is available for the current navmesh.
+   */
+  bool hasLandmarkIndex() const;
+
+  /**
+   * @brief Loads a landmark index saved by @ref saveLandmarkIndex for the
+   * current navmesh.
+   *
+   * Fails if the file was saved for a different navmesh, detected through a
+   * checksum of the navmesh polygons stored in the file.
+   *
+   * @param[in] path The saved landmark index, generally stored next to the
+   * ``.navmesh`` file it was built for
+   *
+   * @return Whether or not the index was successfully loaded
+   */
+  bool loadLandmarkIndex(const std::string& path);
+
+  /**
+   * @brief Saves the landmark index, to be loaded by @ref loadLandmarkIndex
+   * together with the navmesh instead of being recomputed.
+   *
+   * @param[in] path The name of the file
+   *
+   * @return Whether or not the index was successfully saved
+   */
+  bool saveLandmarkIndex(const std::string& path) const;
+
+  /**
+   * @brief Estimates the geodesic distance between two points without a path
+   * search.
+   *
+   * Returns the larger of the euclidean distance between the points snapped to
+   * the navmesh and the landmark bound, if a landmark index is available. The
+   * landmark distances are measured between polygon centers, so the estimate
+   * is approximate and may slightly over- or underestimate the distance
+   * returned by @ref findPath.
+   *
+   * @return The estimate, or inf if the points aren't connected.
+   */
+  float estimateGeodesicDistance(const vec3f& start, const vec3f& end) const;
+
   /**
    * @return If a valid navigation mesh is currently loaded or not.
    */
@@ -512,7 +853,8 @@ class PathFinder {
    *
    * @param[in] newSeed The random seed
    *
-   * @note This just seeds the global c @ref rand function.
+   * @note This seeds the random generator owned by this PathFinder, which is
+   * used by the sampling overloads that aren't passed a @ref core::Random.
    */
   void seed(uint32_t newSeed);
 
@@ -558,6 +900,38 @@ class PathFinder {
   float distanceToClosestObstacle(const vec3f& pt,
                                   float maxSearchRadius = 2.0) const;
 
+  /**
+   * @brief Same as @ref distanceToClosestObstacle for a location, reusing its
+   * cached polygon.
+   */
+  float distanceToClosestObstacle(const NavLocation& location,
+                                  float maxSearchRadius = 2.0) const;
+
+  /**
+   * @brief Precompute the distance to the closest obstacle over the navmesh.
+   *
+   * Samples the distance on a regular xz grid over each navmesh polygon.
+   * Afterwards @ref distanceToClosestObstacle interpolates the samples instead
+   * of searching the navmesh for walls, for search radii up to
+   * @p maxSearchRadius. The field is discarded whenever the navmesh is built,
+   * loaded or rebuilt.
+   *
+   * @param[in] tolerance Largest difference of the interpolated distances
+   * from the searched ones. Smaller tolerances take quadratically more
+   * samples, memory and build time.
+   * @param[in] maxSearchRadius Search radius of the samples. Queries with
+   * larger radii keep searching the navmesh.
+   *
+   * @return Whether or not the field was built.
+   */
+  bool buildClearanceField(float tolerance = 0.05f,
+                           float maxSearchRadius = 2.0f);
+
+  /**
+   * @return If a clearance field is available for the current navmesh.
+   */
+  bool hasClearanceField() const;
+
   /**
    * @brief Same as @ref distanceToClosestObstacle but returns additional
    * information.
@@ -11,6 +11,8 @@
  * JointMotorType, struct @ref JointMotorSettings
  */
 
+#include <Corrade/Containers/ArrayView.h>
+
 #include "RigidBase.h"
 #include "esp/core/Esp.h"
 #include "esp/io/URDFParser.h"
@@ -498,6 +500,133 @@ class ArticulatedObject : public esp::physics::PhysicsObjectBase {
    */
   virtual std::vector<float> getJointPositions() { return {}; }
 
+  /**
+   * @brief Get the number of joint position values, i.e. the size of the
+   * array returned by @ref getJointPositions().
+   */
+  virtual int getNumJointPositions() const { return 0; }
+
+  /**
+   * @brief Get the number of joint degrees of freedom, i.e. the size of the
+   * arrays returned by @ref getJointVelocities() and @ref getJointForces().
+   */
+  virtual int getNumDoFs() const { return 0; }
+
+  /**
+   * @brief Write positions for all joints into a caller-provided buffer
+   * without allocating.
+   *
+   * @param[out] positions Of size @ref getNumJointPositions.
+   */
+  virtual void getJointPositions(
+      CORRADE_UNUSED Corrade::Containers::ArrayView<float> positions) const {}
+
+  /**
+   * @brief Set positions for all joints from a caller-provided buffer.
+   *
+   * @param positions Of size @ref getNumJointPositions.
+   */
+  virtual void setJointPositions(
+      CORRADE_UNUSED Corrade::Containers::ArrayView<const float> positions) {}
+
+  /**
+   * @brief Write velocities for all joints into a caller-provided buffer
+   * without allocating.
+   *
+   * @param[out] vels Of size @ref getNumDoFs.
+   */
+  virtual void getJointVelocities(
+      CORRADE_UNUSED Corrade::Containers::ArrayView<float> vels) const {}
+
+  /**
+   * @brief Set velocities for all joints from a caller-provided buffer.
+   *
+   * @param vels Of size @ref getNumDoFs.
+   */
+  virtual void setJointVelocities(
+      CORRADE_UNUSED Corrade::Containers::ArrayView<const float> vels) {}
+
+  /**
+   * @brief Write current forces/torques for all joints into a caller-provided
+   * buffer without allocating.
+   *
+   * @param[out] forces Of size @ref getNumDoFs.
+   */
+  virtual void getJointForces(
+      CORRADE_UNUSED Corrade::Containers::ArrayView<float> forces) const {}
+
+  /**
+   * @brief Set forces/torques for all joints from a caller-provided buffer.
+   *
+   * @param forces Of size @ref getNumDoFs.
+   */
+  virtual void setJointForces(
+      CORRADE_UNUSED Corrade::Containers::ArrayView<const float> forces) {}
+
+  /**
+   * @brief The number of root state values leading the buffer of
+   * @ref getPackedState.
+   */
+  static constexpr std::size_t PackedRootStateSize = 13;
+
+  /**
+   * @brief Get the size of the buffer filled by @ref getPackedState.
+   */
+  std::size_t getPackedStateSize() const {
+    return PackedRootStateSize + getNumJointPositions() + getNumDoFs();
+  }
+
+  /**
+   * @brief Write the full state of the object into one contiguous buffer.
+   *
+   * The layout is the root translation (3), root rotation as an (x, y, z, w)
+   * quaternion (4), root linear velocity (3), root angular velocity (3), all
+   * joint positions (@ref getNumJointPositions) and all joint velocities
+   * (@ref getNumDoFs).
+   *
+   * @param[out] state Of size @ref getPackedStateSize.
+   */
+  void getPackedState(Corrade::Containers::ArrayView<float> state) const {
+    CORRADE_ASSERT(state.size() == getPackedStateSize(),
+                   "ArticulatedObject::getPackedState(): expected"
+                       << getPackedStateSize() << "values but got"
+                       << state.size(), );
+    const Mn::Quaternion rotation = getRotation();
+    Mn::Vector3::from(state.data()) = getTranslation();
+    Mn::Vector3::from(state.data() + 3) = rotation.vector();
+    state[6] = rotation.scalar();
+    Mn::Vector3::from(state.data() + 7) = getRootLinearVelocity();
+    Mn::Vector3::from(state.data() + 10) = getRootAngularVelocity();
+    const std::size_t numPositions = getNumJointPositions();
+    getJointPositions(state.slice(PackedRootStateSize,
+                                  PackedRootStateSize + numPositions));
+    getJointVelocities(
+        state.exceptPrefix(PackedRootStateSize + numPositions));
+  }
+
+  /**
+   * @brief Set the full state of the object from a buffer laid out as
+   * written by @ref getPackedState.
+   *
+   * @param state Of size @ref getPackedStateSize.
+   */
+  void setPackedState(Corrade::Containers::ArrayView<const float> state) {
+    CORRADE_ASSERT(state.size() == getPackedStateSize(),
+                   "ArticulatedObject::setPackedState(): expected"
+                       << getPackedStateSize() << "values but got"
+                       << state.size(), );
+    setRigidState(core::RigidState(
+        Mn::Quaternion{{state[3], state[4], state[5]}, state[6]},
+        Mn::Vector3::from(state.data())));
+    setRootLinearVelocity(Mn::Vector3::from(state.data() + 7));
+    setRootAngularVelocity(Mn::Vector3::from(state.data() + 10));
+    const std::size_t numPositions = getNumJointPositions();
+    setJointPositions(state.slice(PackedRootStateSize,
+                                  PackedRootStateSize + numPositions));
+    setJointVelocities(
+        state.exceptPrefix(PackedRootStateSize + numPositions));
+  }
+
   /**
    * @brief Get the torques on each joint
    *
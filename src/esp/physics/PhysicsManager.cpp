@@ -5,6 +5,7 @@
 #include "PhysicsManager.h"
 #include <Magnum/Math/Range.h>
 
+#include <algorithm>
 #include <utility>
 #include "esp/assets/CollisionMeshData.h"
 #include "esp/assets/ResourceManager.h"
@@ -541,6 +542,327 @@ Magnum::Vector3 PhysicsManager::getGravity() const {
   return Magnum::Vector3(0);
 }
 
+PhysicsStateSnapshot::ptr PhysicsManager::saveState() const {
+  auto snapshot = PhysicsStateSnapshot::create();
+  snapshot->worldTime = worldTime_;
+
+  snapshot->rigidObjects.reserve(existingObjects_.size());
+  for (const auto& objectItr : existingObjects_) {
+    RigidObject& object = *objectItr.second;
+    snapshot->rigidObjects.emplace_back();
+    PhysicsStateSnapshot::RigidObjectState& state =
+        snapshot->rigidObjects.back();
+    state.objectId = objectItr.first;
+    state.rigidState = object.getRigidState();
+    state.linearVelocity = object.getLinearVelocity();
+    state.angularVelocity = object.getAngularVelocity();
+    state.active = object.isActive();
+  }
+
+  snapshot->articulatedObjects.reserve(existingArticulatedObjects_.size());
+  for (const auto& aoItr : existingArticulatedObjects_) {
+    ArticulatedObject& ao = *aoItr.second;
+    snapshot->articulatedObjects.emplace_back();
+    PhysicsStateSnapshot::ArticulatedObjectState& state =
+        snapshot->articulatedObjects.back();
+    state.objectId = aoItr.first;
+    state.rootState = ao.getRigidState();
+    state.rootLinearVelocity = ao.getRootLinearVelocity();
+    state.rootAngularVelocity = ao.getRootAngularVelocity();
+    state.jointPositions = ao.getJointPositions();
+    state.jointVelocities = ao.getJointVelocities();
+    for (const auto& motorItr : ao.getExistingJointMotors()) {
+      state.jointMotors.emplace_back(
+          motorItr.first, ao.getJointMotorSettings(motorItr.first));
+    }
+    // restore motors in a fixed order
+    std::sort(state.jointMotors.begin(), state.jointMotors.end(),
+              [](const std::pair<int, JointMotorSettings>& a,
+                 const std::pair<int, JointMotorSettings>& b) {
+                return a.first < b.first;
+              });
+    state.active = ao.isActive();
+  }
+
+  snapshot->rigidConstraints.assign(rigidConstraintSettings_.begin(),
+                                    rigidConstraintSettings_.end());
+  std::sort(snapshot->rigidConstraints.begin(),
+            snapshot->rigidConstraints.end(),
+            [](const std::pair<int, RigidConstraintSettings>& a,
+               const std::pair<int, RigidConstraintSettings>& b) {
+              return a.first < b.first;
+            });
+  saveStateFinalize(*snapshot);
+  return snapshot;
+}  // PhysicsManager::saveState
+
+bool PhysicsManager::restoreState(const PhysicsStateSnapshot& snapshot) {
+  bool matched =
+      snapshot.rigidObjects.size() == existingObjects_.size() &&
+      snapshot.articulatedObjects.size() ==
+          existingArticulatedObjects_.size() &&
+      snapshot.rigidConstraints.size() == rigidConstraintSettings_.size();
+
+  for (const PhysicsStateSnapshot::RigidObjectState& state :
+       snapshot.rigidObjects) {
+    auto objectItr = existingObjects_.find(state.objectId);
+    if (objectItr == existingObjects_.end()) {
+      ESP_WARNING() << "Rigid object" << state.objectId
+                    << "was removed since the snapshot, skipping.";
+      matched = false;
+      continue;
+    }
+    RigidObject& object = *objectItr->second;
+    object.setRigidState(state.rigidState);
+    object.setLinearVelocity(state.linearVelocity);
+    object.setAngularVelocity(state.angularVelocity);
+    object.setActive(state.active);
+  }
+
+  for (const PhysicsStateSnapshot::ArticulatedObjectState& state :
+       snapshot.articulatedObjects) {
+    auto aoItr = existingArticulatedObjects_.find(state.objectId);
+    if (aoItr == existingArticulatedObjects_.end()) {
+      ESP_WARNING() << "Articulated object" << state.objectId
+                    << "was removed since the snapshot, skipping.";
+      matched = false;
+      continue;
+    }
+    ArticulatedObject& ao = *aoItr->second;
+    ao.setRigidState(state.rootState);
+    ao.setRootLinearVelocity(state.rootLinearVelocity);
+    ao.setRootAngularVelocity(state.rootAngularVelocity);
+    ao.setJointPositions(state.jointPositions);
+    ao.setJointVelocities(state.jointVelocities);
+    const std::unordered_map<int, int> existingMotors =
+        ao.getExistingJointMotors();
+    for (const auto& motor : state.jointMotors) {
+      if (existingMotors.count(motor.first) == 0) {
+        ESP_WARNING() << "Joint motor" << motor.first
+                      << "of articulated object" << state.objectId
+                      << "was removed since the snapshot, skipping.";
+        matched = false;
+        continue;
+      }
+      ao.updateJointMotor(motor.first, motor.second);
+    }
+    ao.setActive(state.active);
+  }
+
+  for (const auto& constraint : snapshot.rigidConstraints) {
+    auto constraintItr = rigidConstraintSettings_.find(constraint.first);
+    // a constraint removed since may have had its id reused by another one
+    if (constraintItr == rigidConstraintSettings_.end() ||
+        constraintItr->second.constraintType !=
+            constraint.second.constraintType ||
+        constraintItr->second.objectIdA != constraint.second.objectIdA ||
+        constraintItr->second.objectIdB != constraint.second.objectIdB ||
+        constraintItr->second.linkIdA != constraint.second.linkIdA ||
+        constraintItr->second.linkIdB != constraint.second.linkIdB) {
+      ESP_WARNING() << "Rigid constraint" << constraint.first
+                    << "was removed since the snapshot, skipping.";
+      matched = false;
+      continue;
+    }
+    updateRigidConstraint(constraint.first, constraint.second);
+  }
+
+  worldTime_ = snapshot.worldTime;
+  restoreStateFinalize(snapshot);
+  return matched;
+}  // PhysicsManager::restoreState
+
+bool PhysicsManager::getRigidObjectStates(
+    Cr::Containers::ArrayView<const int> objectIds,
+    Cr::Containers::ArrayView<Mn::Vector3> translations,
+    Cr::Containers::ArrayView<Mn::Quaternion> rotations,
+    Cr::Containers::ArrayView<Mn::Vector3> linearVelocities,
+    Cr::Containers::ArrayView<Mn::Vector3> angularVelocities,
+    Cr::Containers::ArrayView<MotionType> motionTypes) const {
+  const std::size_t n = objectIds.size();
+  CORRADE_ASSERT(
+      (translations.empty() || translations.size() == n) &&
+          (rotations.empty() || rotations.size() == n) &&
+          (linearVelocities.empty() || linearVelocities.size() == n) &&
+          (angularVelocities.empty() || angularVelocities.size() == n) &&
+          (motionTypes.empty() || motionTypes.size() == n),
+      "PhysicsManager::getRigidObjectStates(): expected outputs to be empty "
+      "or of size"
+          << n,
+      false);
+
+  bool allFound = true;
+  for (std::size_t i = 0; i < n; ++i) {
+    auto objIter = existingObjects_.find(objectIds[i]);
+    if (objIter == existingObjects_.end()) {
+      if (!motionTypes.empty()) {
+        motionTypes[i] = MotionType::UNDEFINED;
+      }
+      allFound = false;
+      continue;
+    }
+    const RigidObject& object = *objIter->second;
+    if (!translations.empty()) {
+      translations[i] = object.getTranslation();
+    }
+    if (!rotations.empty()) {
+      rotations[i] = object.getRotation();
+    }
+    if (!linearVelocities.empty()) {
+      linearVelocities[i] = object.getLinearVelocity();
+    }
+    if (!angularVelocities.empty()) {
+      angularVelocities[i] = object.getAngularVelocity();
+    }
+    if (!motionTypes.empty()) {
+      motionTypes[i] = object.getMotionType();
+    }
+  }
+  return allFound;
+}  // PhysicsManager::getRigidObjectStates
+
+bool PhysicsManager::setRigidObjectStates(
+    Cr::Containers::ArrayView<const int> objectIds,
+    Cr::Containers::ArrayView<const Mn::Vector3> translations,
+    Cr::Containers::ArrayView<const Mn::Quaternion> rotations,
+    Cr::Containers::ArrayView<const Mn::Vector3> linearVelocities,
+    Cr::Containers::ArrayView<const Mn::Vector3> angularVelocities) {
+  const std::size_t n = objectIds.size();
+  CORRADE_ASSERT(
+      (translations.empty() || translations.size() == n) &&
+          (rotations.empty() || rotations.size() == n) &&
+          (linearVelocities.empty() || linearVelocities.size() == n) &&
+          (angularVelocities.empty() || angularVelocities.size() == n),
+      "PhysicsManager::setRigidObjectStates(): expected inputs to be empty "
+      "or of size"
+          << n,
+      false);
+
+  bool allFound = true;
+  for (std::size_t i = 0; i < n; ++i) {
+    auto objIter = existingObjects_.find(objectIds[i]);
+    if (objIter == existingObjects_.end()) {
+      allFound = false;
+      continue;
+    }
+    RigidObject& object = *objIter->second;
+    if (!translations.empty()) {
+      object.setTranslation(translations[i]);
+    }
+    if (!rotations.empty()) {
+      object.setRotation(rotations[i]);
+    }
+    if (!linearVelocities.empty()) {
+      object.setLinearVelocity(linearVelocities[i]);
+    }
+    if (!angularVelocities.empty()) {
+      object.setAngularVelocity(angularVelocities[i]);
+    }
+  }
+  return allFound;
+}  // PhysicsManager::setRigidObjectStates
+
+bool PhysicsManager::countArticulatedJointValues(
+    Cr::Containers::ArrayView<const int> objectIds,
+    std::size_t& numPositions,
+    std::size_t& numDoFs) const {
+  numPositions = 0;
+  numDoFs = 0;
+  for (const int objectId : objectIds) {
+    auto aoIter = existingArticulatedObjects_.find(objectId);
+    if (aoIter == existingArticulatedObjects_.end()) {
+      ESP_ERROR() << "No articulated object with id" << objectId
+                  << "exists, aborting.";
+      return false;
+    }
+    numPositions += aoIter->second->getNumJointPositions();
+    numDoFs += aoIter->second->getNumDoFs();
+  }
+  return true;
+}  // PhysicsManager::countArticulatedJointValues
+
+bool PhysicsManager::getArticulatedJointStates(
+    Cr::Containers::ArrayView<const int> objectIds,
+    Cr::Containers::ArrayView<float> positions,
+    Cr::Containers::ArrayView<float> velocities,
+    Cr::Containers::ArrayView<float> forces) const {
+  std::size_t numPositions = 0;
+  std::size_t numDoFs = 0;
+  if (!countArticulatedJointValues(objectIds, numPositions, numDoFs)) {
+    return false;
+  }
+  if ((!positions.empty() && positions.size() != numPositions) ||
+      (!velocities.empty() && velocities.size() != numDoFs) ||
+      (!forces.empty() && forces.size() != numDoFs)) {
+    ESP_ERROR() << "Expected outputs to be empty or of size" << numPositions
+                << "for positions and" << numDoFs
+                << "for velocities and forces, aborting.";
+    return false;
+  }
+
+  std::size_t posOffset = 0;
+  std::size_t dofOffset = 0;
+  for (const int objectId : objectIds) {
+    const ArticulatedObject& ao = *existingArticulatedObjects_.at(objectId);
+    const std::size_t aoPositions = ao.getNumJointPositions();
+    const std::size_t aoDoFs = ao.getNumDoFs();
+    if (!positions.empty()) {
+      ao.getJointPositions(
+          positions.slice(posOffset, posOffset + aoPositions));
+    }
+    if (!velocities.empty()) {
+      ao.getJointVelocities(velocities.slice(dofOffset, dofOffset + aoDoFs));
+    }
+    if (!forces.empty()) {
+      ao.getJointForces(forces.slice(dofOffset, dofOffset + aoDoFs));
+    }
+    posOffset += aoPositions;
+    dofOffset += aoDoFs;
+  }
+  return true;
+}  // PhysicsManager::getArticulatedJointStates
+
+bool PhysicsManager::setArticulatedJointStates(
+    Cr::Containers::ArrayView<const int> objectIds,
+    Cr::Containers::ArrayView<const float> positions,
+    Cr::Containers::ArrayView<const float> velocities,
+    Cr::Containers::ArrayView<const float> forces) {
+  std::size_t numPositions = 0;
+  std::size_t numDoFs = 0;
+  if (!countArticulatedJointValues(objectIds, numPositions, numDoFs)) {
+    return false;
+  }
+  if ((!positions.empty() && positions.size() != numPositions) ||
+      (!velocities.empty() && velocities.size() != numDoFs) ||
+      (!forces.empty() && forces.size() != numDoFs)) {
+    ESP_ERROR() << "Expected inputs to be empty or of size" << numPositions
+                << "for positions and" << numDoFs
+                << "for velocities and forces, aborting.";
+    return false;
+  }
+
+  std::size_t posOffset = 0;
+  std::size_t dofOffset = 0;
+  for (const int objectId : objectIds) {
+    ArticulatedObject& ao = *existingArticulatedObjects_.at(objectId);
+    const std::size_t aoPositions = ao.getNumJointPositions();
+    const std::size_t aoDoFs = ao.getNumDoFs();
+    if (!positions.empty()) {
+      ao.setJointPositions(
+          positions.slice(posOffset, posOffset + aoPositions));
+    }
+    if (!velocities.empty()) {
+      ao.setJointVelocities(velocities.slice(dofOffset, dofOffset + aoDoFs));
+    }
+    if (!forces.empty()) {
+      ao.setJointForces(forces.slice(dofOffset, dofOffset + aoDoFs));
+    }
+    posOffset += aoPositions;
+    dofOffset += aoDoFs;
+  }
+  return true;
+}  // PhysicsManager::setArticulatedJointStates
+
 void PhysicsManager::stepPhysics(double dt) {
   // We don't step uninitialized physics sim...
   if (!initialized_) {
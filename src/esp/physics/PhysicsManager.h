@@ -10,6 +10,7 @@
  * PhysicsManager::PhysicsSimulationLibrary
  */
 
+#include <Corrade/Containers/ArrayView.h>
 #include <map>
 #include <memory>
 #include <string>
@@ -168,6 +169,55 @@ struct RigidConstraintSettings {
   ESP_SMART_POINTERS(RigidConstraintSettings)
 };  // struct RigidConstraintSettings
 
+/**
+ * @brief In-memory snapshot of the dynamic state of a physics world, see
+ * @ref PhysicsManager::saveState.
+ *
+ * Object motion types are not captured. Objects whose @ref MotionType changed
+ * since the snapshot keep their current one when it is restored.
+ */
+struct PhysicsStateSnapshot {
+  /** @brief Dynamic state of a rigid object. */
+  struct RigidObjectState {
+    int objectId = ID_UNDEFINED;
+    core::RigidState rigidState;
+    Mn::Vector3 linearVelocity, angularVelocity;
+    bool active = false;
+  };
+
+  /** @brief Dynamic state of an articulated object. */
+  struct ArticulatedObjectState {
+    int objectId = ID_UNDEFINED;
+    core::RigidState rootState;
+    Mn::Vector3 rootLinearVelocity, rootAngularVelocity;
+    std::vector<float> jointPositions, jointVelocities;
+    //! Motor id and settings of each joint motor
+    std::vector<std::pair<int, JointMotorSettings>> jointMotors;
+    bool active = false;
+  };
+
+  /** @brief The simulated time of the world. */
+  double worldTime = 0.0;
+
+  /**
+   * @brief Time passed to the simulator but not simulated yet, i.e. the
+   * remainder accumulated towards its next fixed timestep. Zero for
+   * simulators without one.
+   */
+  double stepRemainder = 0.0;
+
+  /** @brief State of each rigid object, sorted by object id. */
+  std::vector<RigidObjectState> rigidObjects;
+
+  /** @brief State of each articulated object, sorted by object id. */
+  std::vector<ArticulatedObjectState> articulatedObjects;
+
+  /** @brief Constraint id and settings of each rigid constraint. */
+  std::vector<std::pair<int, RigidConstraintSettings>> rigidConstraints;
+
+  ESP_SMART_POINTERS(PhysicsStateSnapshot)
+};  // struct PhysicsStateSnapshot
+
 class RigidObjectManager;
 class ArticulatedObjectManager;
 
@@ -539,6 +589,142 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
 
   //============ Simulator functions =============
 
+  /**
+   * @brief Capture the dynamic state of all rigid and articulated objects and
+   * rigid constraints: transforms, velocities, joint positions and velocities,
+   * joint motor settings, activation states and constraint settings. Motion
+   * types are not captured.
+   *
+   * Restore it with @ref restoreState to reset an episode without removing
+   * and re-adding objects.
+   */
+  PhysicsStateSnapshot::ptr saveState() const;
+
+  /**
+   * @brief Restore a snapshot taken with @ref saveState in place.
+   *
+   * Contacts cached by the simulation are dropped, so stepping after a restore
+   * does not depend on what was simulated since the snapshot.
+   *
+   * Objects and constraints are matched by id. Objects and constraints added
+   * since the snapshot are left as they are, the ones removed since are not
+   * recreated.
+   *
+   * @param snapshot The snapshot to restore.
+   * @return Whether the snapshot matched the current objects and constraints.
+   * The matching ones are restored either way.
+   */
+  bool restoreState(const PhysicsStateSnapshot& snapshot);
+
+  /**
+   * @brief Read the state of a set of rigid objects into caller-provided
+   * arrays in one call, without creating managed object wrappers.
+   *
+   * The arrays are structure-of-arrays: entry i of each output belongs to
+   * objectIds[i]. Each output must either be empty, in which case that field
+   * is skipped, or have the same size as objectIds. Pass
+   * @ref getExistingObjectIDs to query all objects.
+   *
+   * @param[in] objectIds The ids of the rigid objects to query.
+   * @param[out] translations The object translations.
+   * @param[out] rotations The object orientations.
+   * @param[out] linearVelocities The object linear velocities.
+   * @param[out] angularVelocities The object angular velocities.
+   * @param[out] motionTypes The object motion types.
+   * @return Whether all ids refer to existing rigid objects. Entries of
+   * unknown ids are left untouched, except for motion types which are set to
+   * @ref MotionType::UNDEFINED.
+   */
+  bool getRigidObjectStates(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<Magnum::Vector3> translations,
+      Corrade::Containers::ArrayView<Magnum::Quaternion> rotations,
+      Corrade::Containers::ArrayView<Magnum::Vector3> linearVelocities,
+      Corrade::Containers::ArrayView<Magnum::Vector3> angularVelocities,
+      Corrade::Containers::ArrayView<MotionType> motionTypes) const;
+
+  /**
+   * @brief Set the state of a set of rigid objects from caller-provided
+   * arrays in one call. The batched counterpart of @ref getRigidObjectStates.
+   *
+   * Each input must either be empty, in which case that field is left
+   * unchanged, or have the same size as objectIds. As with the per-object
+   * setters, poses of @ref MotionType::STATIC objects are not changed.
+   *
+   * @param objectIds The ids of the rigid objects to modify.
+   * @param translations The new object translations.
+   * @param rotations The new object orientations.
+   * @param linearVelocities The new object linear velocities.
+   * @param angularVelocities The new object angular velocities.
+   * @return Whether all ids refer to existing rigid objects. Unknown ids are
+   * skipped.
+   */
+  bool setRigidObjectStates(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<const Magnum::Vector3> translations,
+      Corrade::Containers::ArrayView<const Magnum::Quaternion> rotations,
+      Corrade::Containers::ArrayView<const Magnum::Vector3> linearVelocities,
+      Corrade::Containers::ArrayView<const Magnum::Vector3>
+          angularVelocities);
+
+  /**
+   * @brief Count the joint values of a set of articulated objects, i.e. the
+   * buffer sizes expected by @ref getArticulatedJointStates and
+   * @ref setArticulatedJointStates.
+   *
+   * @param[in] objectIds The ids of the articulated objects.
+   * @param[out] numPositions The total number of joint positions.
+   * @param[out] numDoFs The total number of joint degrees of freedom.
+   * @return Whether all ids refer to existing articulated objects.
+   */
+  bool countArticulatedJointValues(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      std::size_t& numPositions,
+      std::size_t& numDoFs) const;
+
+  /**
+   * @brief Read the joint state of a set of articulated objects into
+   * caller-provided buffers in one call, without allocating.
+   *
+   * The joint values of all objects are concatenated in the order of
+   * objectIds. positions holds @ref ArticulatedObject::getNumJointPositions
+   * values per object, velocities and forces
+   * @ref ArticulatedObject::getNumDoFs values per object. Each output must
+   * either be empty, in which case that field is skipped, or have exactly the
+   * total size. Pass @ref getExistingArticulatedObjectIds to query all
+   * articulated objects.
+   *
+   * @param[in] objectIds The ids of the articulated objects to query.
+   * @param[out] positions The joint positions.
+   * @param[out] velocities The joint velocities.
+   * @param[out] forces The joint forces/torques.
+   * @return Whether all ids refer to existing articulated objects and the
+   * outputs have the expected sizes. Nothing is written otherwise.
+   */
+  bool getArticulatedJointStates(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<float> positions,
+      Corrade::Containers::ArrayView<float> velocities,
+      Corrade::Containers::ArrayView<float> forces) const;
+
+  /**
+   * @brief Set the joint state of a set of articulated objects from
+   * caller-provided buffers in one call. The batched counterpart of
+   * @ref getArticulatedJointStates, using the same layout.
+   *
+   * @param objectIds The ids of the articulated objects to modify.
+   * @param positions The new joint positions.
+   * @param velocities The new joint velocities.
+   * @param forces The new joint forces/torques.
+   * @return Whether all ids refer to existing articulated objects and the
+   * inputs have the expected sizes. Nothing is changed otherwise.
+   */
+  bool setArticulatedJointStates(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<const float> positions,
+      Corrade::Containers::ArrayView<const float> velocities,
+      Corrade::Containers::ArrayView<const float> forces);
+
   /** @brief Step the physical world forward in time. Time may only advance in
    * increments of @ref fixedTimeStep_.
    * @param dt The desired amount of time to advance the physical world.
@@ -777,6 +963,28 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
    */
   virtual std::vector<ContactPointData> getContactPoints() const { return {}; }
 
+  /**
+   * @brief Write contact point data from the most recent collision detection
+   * cache into a caller-provided buffer instead of allocating a new vector.
+   *
+   * Contacts are looked up in the same order as @ref getContactPoints(). The
+   * buffer can be reused between steps; if the returned count exceeds its
+   * size, the remaining contact points were counted but not written.
+   *
+   * Not implemented for default PhysicsManager implementation.
+   * @param[out] contactPoints Filled with the first matching contact points.
+   * @param objectIds If not empty, only contacts involving one of these object
+   * ids are reported. The stage is -1.
+   * @return The number of matching contact points.
+   */
+  virtual std::size_t getContactPoints(
+      CORRADE_UNUSED Corrade::Containers::ArrayView<ContactPointData>
+          contactPoints,
+      CORRADE_UNUSED Corrade::Containers::ArrayView<const int> objectIds =
+          nullptr) const {
+    return 0;
+  }
+
   /**
    * @brief Set the stage to collidable or not.
    *
@@ -840,6 +1048,46 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
     return results;
   }
 
+  /**
+   * @brief Cast a batch of rays into the collision world, writing a fixed
+   * number of hit slots per ray into a flat buffer. Meant for sensors casting
+   * thousands of rays per step.
+   *
+   * Note: not implemented here in default PhysicsManager as there are no
+   * collision objects without a simulation implementation. All slots are
+   * reported empty.
+   *
+   * @param[in] rays The rays to cast. Need not be unit length, but hit
+   * distances will be in units of ray length.
+   * @param[out] hits The hits of ray i, sorted by distance, in slots
+   * [i*k, (i+1)*k) with k = hits.size()/rays.size(). Must be a non-zero
+   * multiple of the number of rays. With one slot per ray only the closest
+   * hit is searched for, which is considerably cheaper than collecting all
+   * hits. Slots past the last hit of a ray have a negative
+   * @ref RayHitInfo::rayDistance.
+   * @param[in] maxDistance The maximum distance along the ray direction to
+   * search. In units of ray length.
+   * @param[in] collisionFilterMask Bitmask of @ref CollisionGroup values of
+   * the objects rays may hit. All groups by default.
+   * @param[in] numThreads The number of worker threads. Values <= 0 use the
+   * OpenMP default.
+   */
+  virtual void castRays(
+      Corrade::Containers::ArrayView<const esp::geo::Ray> rays,
+      Corrade::Containers::ArrayView<RayHitInfo> hits,
+      CORRADE_UNUSED double maxDistance = 100.0,
+      CORRADE_UNUSED int collisionFilterMask = -1,
+      CORRADE_UNUSED int numThreads = 0) {
+    CORRADE_ASSERT(rays.empty() || (!hits.empty() &&
+                                    hits.size() % rays.size() == 0),
+                   "PhysicsManager::castRays(): expected a non-zero multiple "
+                   "of" << rays.size() << "hit slots but got" << hits.size(), );
+    for (RayHitInfo& hit : hits) {
+      hit = RayHitInfo{};
+      hit.rayDistance = -1.0;
+    }
+  }
+
   /**
    * @brief returns the wrapper manager for the currently created rigid
    * objects.
@@ -1092,6 +1340,23 @@ class PhysicsManager : public std::enable_shared_from_this<PhysicsManager> {
    */
   virtual bool initPhysicsFinalize();
 
+  /**
+   * @brief Finalize @ref saveState, e.g. to capture simulator-specific state.
+   * Does nothing by default.
+   * @param snapshot The snapshot being saved.
+   */
+  virtual void saveStateFinalize(
+      CORRADE_UNUSED PhysicsStateSnapshot& snapshot) const {}
+
+  /**
+   * @brief Finalize @ref restoreState after all states were set, e.g. to
+   * restore simulator-specific state and drop caches. Does nothing by
+   * default.
+   * @param snapshot The snapshot being restored.
+   */
+  virtual void restoreStateFinalize(
+      CORRADE_UNUSED const PhysicsStateSnapshot& snapshot) {}
+
   /**
    * @brief Finalize stage initialization for kinematic stage.  Overidden by
    * instancing class if physics is supported.
@@ -5,6 +5,9 @@
 // Construction code adapted from Bullet3/examples/
 
 #include "BulletArticulatedObject.h"
+
+#include <Corrade/Containers/ArrayViewStl.h>
+
 #include "BulletDynamics/Featherstone/btMultiBodyLinkCollider.h"
 #include "BulletPhysicsManager.h"
 #include "BulletURDFImporter.h"
@@ -238,6 +241,7 @@ void BulletArticulatedObject::constructStaticRigidBaseObject() {
         uint32_t(
             CollisionGroupHelper::getMaskForGroup(CollisionGroup::Static)));
     collisionObjToObjIds_->emplace(bFixedObjectRigidBody_.get(), objectId_);
+    setCollisionObjectIds(bFixedObjectRigidBody_.get(), objectId_);
   }
 }
 
@@ -382,16 +386,9 @@ void BulletArticulatedObject::setJointForces(const std::vector<float>& forces) {
     ESP_DEBUG() << "Force vector size mis-match (input:" << forces.size()
                 << ", expected:" << btMultiBody_->getNumDofs()
                 << "), aborting.";
+    return;
   }
-
-  int dofCount = 0;
-  for (int i = 0; i < btMultiBody_->getNumLinks(); ++i) {
-    btMultibodyLink& link = btMultiBody_->getLink(i);
-    for (int dof = 0; dof < link.m_dofCount; ++dof) {
-      link.m_jointTorque[dof] = forces[dofCount];
-      ++dofCount;
-    }
-  }
+  setJointForces(Cr::Containers::arrayView(forces));
 }
 
 void BulletArticulatedObject::addJointForces(const std::vector<float>& forces) {
@@ -413,6 +410,16 @@ void BulletArticulatedObject::addJointForces(const std::vector<float>& forces) {
 
 std::vector<float> BulletArticulatedObject::getJointForces() {
   std::vector<float> forces(btMultiBody_->getNumDofs());
+  getJointForces(Cr::Containers::arrayView(forces));
+  return forces;
+}
+
+void BulletArticulatedObject::getJointForces(
+    Cr::Containers::ArrayView<float> forces) const {
+  CORRADE_ASSERT(forces.size() == std::size_t(btMultiBody_->getNumDofs()),
+                 "BulletArticulatedObject::getJointForces(): expected"
+                     << btMultiBody_->getNumDofs() << "values but got"
+                     << forces.size(), );
   int dofCount = 0;
   for (int i = 0; i < btMultiBody_->getNumLinks(); ++i) {
     btScalar* dofForces = btMultiBody_->getJointTorqueMultiDof(i);
@@ -421,7 +428,22 @@ std::vector<float> BulletArticulatedObject::getJointForces() {
       ++dofCount;
     }
   }
-  return forces;
+}
+
+void BulletArticulatedObject::setJointForces(
+    Cr::Containers::ArrayView<const float> forces) {
+  CORRADE_ASSERT(forces.size() == std::size_t(btMultiBody_->getNumDofs()),
+                 "BulletArticulatedObject::setJointForces(): expected"
+                     << btMultiBody_->getNumDofs() << "values but got"
+                     << forces.size(), );
+  int dofCount = 0;
+  for (int i = 0; i < btMultiBody_->getNumLinks(); ++i) {
+    btMultibodyLink& link = btMultiBody_->getLink(i);
+    for (int dof = 0; dof < link.m_dofCount; ++dof) {
+      link.m_jointTorque[dof] = forces[dofCount];
+      ++dofCount;
+    }
+  }
 }
 
 void BulletArticulatedObject::setJointVelocities(
@@ -430,21 +452,23 @@ void BulletArticulatedObject::setJointVelocities(
     ESP_DEBUG() << "Velocity vector size mis-match (input:" << vels.size()
                 << ", expected:" << btMultiBody_->getNumDofs()
                 << "), aborting.";
+    return;
   }
-
-  int dofCount = 0;
-  for (int i = 0; i < btMultiBody_->getNumLinks(); ++i) {
-    if (btMultiBody_->getLink(i).m_dofCount > 0) {
-      // this const_cast is only needed for Bullet 2.87. It is harmless in any
-      // case.
-      btMultiBody_->setJointVelMultiDof(i, const_cast<float*>(&vels[dofCount]));
-      dofCount += btMultiBody_->getLink(i).m_dofCount;
-    }
-  }
+  setJointVelocities(Cr::Containers::arrayView(vels));
 }
 
 std::vector<float> BulletArticulatedObject::getJointVelocities() {
   std::vector<float> vels(btMultiBody_->getNumDofs());
+  getJointVelocities(Cr::Containers::arrayView(vels));
+  return vels;
+}
+
+void BulletArticulatedObject::getJointVelocities(
+    Cr::Containers::ArrayView<float> vels) const {
+  CORRADE_ASSERT(vels.size() == std::size_t(btMultiBody_->getNumDofs()),
+                 "BulletArticulatedObject::getJointVelocities(): expected"
+                     << btMultiBody_->getNumDofs() << "values but got"
+                     << vels.size(), );
   int dofCount = 0;
   for (int i = 0; i < btMultiBody_->getNumLinks(); ++i) {
     btScalar* dofVels = btMultiBody_->getJointVelMultiDof(i);
@@ -453,7 +477,23 @@ std::vector<float> BulletArticulatedObject::getJointVelocities() {
       ++dofCount;
     }
   }
-  return vels;
+}
+
+void BulletArticulatedObject::setJointVelocities(
+    Cr::Containers::ArrayView<const float> vels) {
+  CORRADE_ASSERT(vels.size() == std::size_t(btMultiBody_->getNumDofs()),
+                 "BulletArticulatedObject::setJointVelocities(): expected"
+                     << btMultiBody_->getNumDofs() << "values but got"
+                     << vels.size(), );
+  int dofCount = 0;
+  for (int i = 0; i < btMultiBody_->getNumLinks(); ++i) {
+    if (btMultiBody_->getLink(i).m_dofCount > 0) {
+      // this const_cast is only needed for Bullet 2.87. It is harmless in any
+      // case.
+      btMultiBody_->setJointVelMultiDof(i, const_cast<float*>(&vels[dofCount]));
+      dofCount += btMultiBody_->getLink(i).m_dofCount;
+    }
+  }
 }
 
 void BulletArticulatedObject::setJointPositions(
@@ -462,8 +502,49 @@ void BulletArticulatedObject::setJointPositions(
     ESP_DEBUG(Mn::Debug::Flag::NoSpace)
         << "Position vector size mis-match (input:" << positions.size()
         << ", expected:" << btMultiBody_->getNumPosVars() << "), aborting.";
+    return;
+  }
+  setJointPositions(Cr::Containers::arrayView(positions));
+}
+
+std::vector<float> BulletArticulatedObject::getJointPositions() {
+  std::vector<float> positions(btMultiBody_->getNumPosVars());
+  getJointPositions(Cr::Containers::arrayView(positions));
+  return positions;
+}
+
+int BulletArticulatedObject::getNumJointPositions() const {
+  return btMultiBody_->getNumPosVars();
+}
+
+int BulletArticulatedObject::getNumDoFs() const {
+  return btMultiBody_->getNumDofs();
+}
+
+void BulletArticulatedObject::getJointPositions(
+    Cr::Containers::ArrayView<float> positions) const {
+  CORRADE_ASSERT(
+      positions.size() == std::size_t(btMultiBody_->getNumPosVars()),
+      "BulletArticulatedObject::getJointPositions(): expected"
+          << btMultiBody_->getNumPosVars() << "values but got"
+          << positions.size(), );
+  int posCount = 0;
+  for (int i = 0; i < btMultiBody_->getNumLinks(); ++i) {
+    btScalar* linkPos = btMultiBody_->getJointPosMultiDof(i);
+    for (int pos = 0; pos < btMultiBody_->getLink(i).m_posVarCount; ++pos) {
+      positions[posCount] = linkPos[pos];
+      ++posCount;
+    }
   }
+}
 
+void BulletArticulatedObject::setJointPositions(
+    Cr::Containers::ArrayView<const float> positions) {
+  CORRADE_ASSERT(
+      positions.size() == std::size_t(btMultiBody_->getNumPosVars()),
+      "BulletArticulatedObject::setJointPositions(): expected"
+          << btMultiBody_->getNumPosVars() << "values but got"
+          << positions.size(), );
   int posCount = 0;
   for (int i = 0; i < btMultiBody_->getNumLinks(); ++i) {
     auto& link = btMultiBody_->getLink(i);
@@ -478,19 +559,6 @@ void BulletArticulatedObject::setJointPositions(
   updateKinematicState();
 }
 
-std::vector<float> BulletArticulatedObject::getJointPositions() {
-  std::vector<float> positions(btMultiBody_->getNumPosVars());
-  int posCount = 0;
-  for (int i = 0; i < btMultiBody_->getNumLinks(); ++i) {
-    btScalar* linkPos = btMultiBody_->getJointPosMultiDof(i);
-    for (int pos = 0; pos < btMultiBody_->getLink(i).m_posVarCount; ++pos) {
-      positions[posCount] = linkPos[pos];
-      ++posCount;
-    }
-  }
-  return positions;
-}
-
 std::vector<float> BulletArticulatedObject::getJointMotorTorques(
     double fixedTimeStep) {
   std::vector<float> torques(btMultiBody_->getNumDofs());
@@ -219,6 +219,69 @@ class BulletArticulatedObject : public ArticulatedObject {
    */
   std::vector<float> getJointPositions() override;
 
+  /**
+   * @brief Get the number of joint position values.
+   */
+  int getNumJointPositions() const override;
+
+  /**
+   * @brief Get the number of joint degrees of freedom.
+   */
+  int getNumDoFs() const override;
+
+  /**
+   * @brief Write positions for all joints into a caller-provided buffer.
+   *
+   * @param[out] positions Of size @ref getNumJointPositions.
+   */
+  void getJointPositions(
+      Corrade::Containers::ArrayView<float> positions) const override;
+
+  /**
+   * @brief Set positions for all joints from a caller-provided buffer.
+   *
+   * @param positions Of size @ref getNumJointPositions.
+   */
+  void setJointPositions(
+      Corrade::Containers::ArrayView<const float> positions) override;
+
+  /**
+   * @brief Write velocities for all joints into a caller-provided buffer.
+   *
+   * @param[out] vels Of size @ref getNumDoFs.
+   */
+  void getJointVelocities(
+      Corrade::Containers::ArrayView<float> vels) const override;
+
+  /**
+   * @brief Set velocities for all joints from a caller-provided buffer.
+   *
+   * @param vels Of size @ref getNumDoFs.
+   */
+  void setJointVelocities(
+      Corrade::Containers::ArrayView<const float> vels) override;
+
+  /**
+   * @brief Write current forces/torques for all joints into a caller-provided
+   * buffer.
+   *
+   * Bullet clears joint forces/torques with each simulation step.
+   *
+   * @param[out] forces Of size @ref getNumDoFs.
+   */
+  void getJointForces(
+      Corrade::Containers::ArrayView<float> forces) const override;
+
+  /**
+   * @brief Set forces/torques for all joints from a caller-provided buffer.
+   *
+   * Bullet clears joint forces/torques with each simulation step.
+   *
+   * @param forces Of size @ref getNumDoFs.
+   */
+  void setJointForces(
+      Corrade::Containers::ArrayView<const float> forces) override;
+
   /**
    * @brief Get the torques on each joint
    *
@@ -3,7 +3,14 @@
 // LICENSE file in the root directory of this source tree.
 
 #include "BulletBase.h"
+#include <LinearMath/btConvexHullComputer.h>
 #include <Magnum/BulletIntegration/Integration.h>
+#include <Magnum/Math/Constants.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Range.h>
+
+#include <algorithm>
+#include <cmath>
 
 namespace Mn = Magnum;
 namespace Cr = Corrade;
@@ -72,5 +79,94 @@ void BulletBase::constructJoinedConvexShapeFromMeshes(
   }
 }
 
+void BulletBase::collectConvexPointsFromMeshes(
+    const Magnum::Matrix4& transformFromParentToWorld,
+    const std::vector<assets::CollisionMeshData>& meshGroup,
+    const assets::MeshTransformNode& node,
+    const bool joinMeshes,
+    BulletCollisionCache::ConvexPoints& convexPoints) {
+  Magnum::Matrix4 transformFromLocalToWorld =
+      transformFromParentToWorld * node.transformFromLocalToParent;
+  if (node.meshIDLocal != ID_UNDEFINED) {
+    const assets::CollisionMeshData& mesh = meshGroup[node.meshIDLocal];
+
+    if (!joinMeshes || convexPoints.empty()) {
+      convexPoints.emplace_back();
+    }
+    std::vector<Mn::Vector3>& points = convexPoints.back();
+    points.reserve(points.size() + mesh.positions.size());
+    for (auto& v : mesh.positions) {
+      points.push_back(transformFromLocalToWorld.transformPoint(v));
+    }
+  }
+
+  for (const auto& child : node.children) {
+    collectConvexPointsFromMeshes(transformFromLocalToWorld, meshGroup, child,
+                                  joinMeshes, convexPoints);
+  }
+}
+
+std::vector<Mn::Vector3> BulletBase::computeConvexHull(
+    const std::vector<Mn::Vector3>& points,
+    int maxVertices) {
+  if (points.empty()) {
+    return points;
+  }
+
+  btConvexHullComputer hullComputer;
+  hullComputer.compute(points.data()->data(), sizeof(Mn::Vector3),
+                       points.size(), 0.0f, 0.0f);
+  if (hullComputer.vertices.size() == 0) {
+    return points;
+  }
+
+  std::vector<Mn::Vector3> vertices;
+  vertices.reserve(hullComputer.vertices.size());
+  Mn::Range3D bounds{Mn::Vector3{hullComputer.vertices[0]},
+                     Mn::Vector3{hullComputer.vertices[0]}};
+  for (int i = 0; i < hullComputer.vertices.size(); ++i) {
+    vertices.emplace_back(hullComputer.vertices[i]);
+    bounds = Mn::Math::join(bounds, Mn::Range3D{vertices.back(),
+                                                vertices.back()});
+  }
+  if (maxVertices <= 0 || vertices.size() <= std::size_t(maxVertices)) {
+    return vertices;
+  }
+
+  // Keep the support vertices in directions spread over the sphere with a
+  // Fibonacci lattice. The directions are scaled by the inverse extents of the
+  // hull, so flat or elongated hulls keep vertices along all of their sides.
+  const int numDirections = std::max(maxVertices, 4);
+  const Mn::Vector3 invExtents =
+      1.0f / Mn::Math::max(bounds.size(), Mn::Vector3{1.0e-6f});
+  const float goldenAngle = Mn::Constants::pi() * (3.0f - std::sqrt(5.0f));
+  std::vector<bool> kept(vertices.size(), false);
+  std::vector<Mn::Vector3> reduced;
+  reduced.reserve(numDirections);
+  for (int i = 0; i < numDirections; ++i) {
+    const float y = 1.0f - 2.0f * (i + 0.5f) / numDirections;
+    const float r = std::sqrt(1.0f - y * y);
+    const float phi = goldenAngle * i;
+    const Mn::Vector3 direction =
+        Mn::Vector3{r * std::cos(phi), y, r * std::sin(phi)} * invExtents;
+
+    std::size_t support = 0;
+    float supportDist = Mn::Math::dot(direction, vertices[0]);
+    for (std::size_t j = 1; j < vertices.size(); ++j) {
+      const float dist = Mn::Math::dot(direction, vertices[j]);
+      if (dist > supportDist) {
+        support = j;
+        supportDist = dist;
+      }
+    }
+    if (!kept[support]) {
+      kept[support] = true;
+      reduced.push_back(vertices[support]);
+    }
+  }
+
+  return reduced;
+}
+
 }  // namespace physics
 }  // namespace esp
@@ -8,7 +8,12 @@
 #include <Magnum/BulletIntegration/MotionState.h>
 #include <btBulletDynamicsCommon.h>
 
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 #include "BulletDynamics/Featherstone/btMultiBodyDynamicsWorld.h"
 #include "BulletDynamics/Featherstone/btMultiBodyLinkCollider.h"
@@ -60,6 +65,84 @@ struct SimulationContactResultCallback
   }
 };
 
+/**
+ * @brief Collision geometry derived from mesh assets, computed once and shared
+ * by all objects built from the same asset. Owned by the @ref
+ * BulletPhysicsManager.
+ */
+struct BulletCollisionCache {
+  //! The points of each convex shape of a collision asset, in asset space
+  typedef std::vector<std::vector<Magnum::Vector3>> ConvexPoints;
+
+  //! Key of @ref convexHulls: collision asset handle, whether the meshes are
+  //! joined into one shape and the max vertex count of each hull
+  typedef std::tuple<std::string, bool, int> ConvexHullKey;
+
+  //! Simplified convex hulls of mesh collision assets, see @ref
+  //! BulletBase::computeConvexHull
+  std::map<ConvexHullKey, std::shared_ptr<const ConvexPoints>> convexHulls;
+
+  /**
+   * @brief Key of @ref convexShapes, everything the convex child shapes of an
+   * object's compound collision shape are built from.
+   *
+   * The object scale is baked into the shapes and part of the key. Scaling
+   * the compound shape instead would rescale the shared shapes in place.
+   */
+  struct ConvexShapeKey {
+    //! Collision asset handle
+    std::string collisionAssetHandle;
+    //! Local scaling of the convex shapes, the object scale times the
+    //! collision asset size if the meshes are joined
+    Magnum::Vector3 localScaling;
+    //! Collision margin of the convex shapes
+    double margin;
+    //! Whether the meshes are joined into one shape
+    bool joinCollisionMeshes;
+    //! Max vertex count of simplified hulls, -1 if the meshes are used as is
+    int maxHullVertices;
+
+    bool operator<(const ConvexShapeKey& other) const {
+      return std::make_tuple(collisionAssetHandle, localScaling.x(),
+                             localScaling.y(), localScaling.z(), margin,
+                             joinCollisionMeshes, maxHullVertices) <
+             std::make_tuple(other.collisionAssetHandle, other.localScaling.x(),
+                             other.localScaling.y(), other.localScaling.z(),
+                             other.margin, other.joinCollisionMeshes,
+                             other.maxHullVertices);
+    }
+  };
+
+  //! Convex child shapes handed out to the objects built with the same @ref
+  //! ConvexShapeKey. The shapes are owned by those objects and released with
+  //! the last of them, so the entries only hold weak references.
+  std::map<ConvexShapeKey, std::vector<std::weak_ptr<btConvexHullShape>>>
+      convexShapes;
+
+  ESP_SMART_POINTERS(BulletCollisionCache)
+};
+
+/**
+ * @brief Tag a collision object with the object and link ids reported for it
+ * in contact queries, so that they can be looked up in constant time. Uses
+ * the collision object's user indices. Untagged collision objects are reported
+ * as the stage.
+ *
+ * @param colObj The collision object. Ignored if null, e.g. for articulated
+ * links without collision shapes.
+ * @param objectId The id of the rigid or articulated object owning it.
+ * @param linkId The articulated link index, or -1 if not a link.
+ */
+inline void setCollisionObjectIds(btCollisionObject* colObj,
+                                  int objectId,
+                                  int linkId = -1) {
+  if (colObj == nullptr) {
+    return;
+  }
+  colObj->setUserIndex(objectId);
+  colObj->setUserIndex2(linkId);
+}
+
 /**
  * @brief This class is intended to implement bullet-specific
  */
@@ -133,6 +216,42 @@ class BulletBase {
       btCompoundShape* bObjectShape,
       std::vector<std::unique_ptr<btConvexHullShape>>& bObjectConvexShapes);
 
+  /**
+   * @brief Recursively collect the points of the convex shapes @ref
+   * constructConvexShapesFromMeshes or @ref
+   * constructJoinedConvexShapeFromMeshes would build from loaded mesh assets.
+   * @param transformFromParentToWorld The cumulative parent-to-world
+   * transformation matrix constructed by composition down the @ref
+   * MeshTransformNode tree to the current node.
+   * @param meshGroup Access structure for collision mesh data.
+   * @param node The current @ref MeshTransformNode in the recursion.
+   * @param joinMeshes Whether to collect the points of all meshes into a single
+   * point set or one point set per mesh.
+   * @param convexPoints The point sets we are collecting into. Should be empty
+   * when passed into entry point.
+   */
+  static void collectConvexPointsFromMeshes(
+      const Magnum::Matrix4& transformFromParentToWorld,
+      const std::vector<assets::CollisionMeshData>& meshGroup,
+      const assets::MeshTransformNode& node,
+      bool joinMeshes,
+      BulletCollisionCache::ConvexPoints& convexPoints);
+
+  /**
+   * @brief Compute the vertices of the convex hull of a point set, dropping all
+   * points a @ref btConvexHullShape would otherwise iterate over in its support
+   * mapping without them ever being a support point.
+   * @param points The point set.
+   * @param maxVertices If positive and the hull has more vertices, the hull is
+   * decimated to the support vertices in at most this many (but at least 4)
+   * directions spread evenly over the sphere, relative to the extents of the
+   * hull. The result is contained in the full hull.
+   * @return The hull vertices, or @p points if no hull could be computed.
+   */
+  static std::vector<Magnum::Vector3> computeConvexHull(
+      const std::vector<Magnum::Vector3>& points,
+      int maxVertices = 0);
+
  protected:
   /** @brief A pointer to the Bullet world to which this object belongs. See
    * @ref btMultiBodyDynamicsWorld.*/
@@ -143,8 +262,9 @@ class BulletBase {
    */
   std::vector<std::unique_ptr<btRigidBody>> bStaticCollisionObjects_;
 
-  //! Object data: Composite convex collision shape
-  std::vector<std::unique_ptr<btConvexHullShape>> bObjectConvexShapes_;
+  //! Object data: Composite convex collision shape. The shapes may be shared
+  //! with other objects, see @ref BulletCollisionCache::convexShapes.
+  std::vector<std::shared_ptr<btConvexHullShape>> bObjectConvexShapes_;
 
   //! list of @ref btCollisionShape for storing arbitrary collision shapes
   //! referenced within the @ref bObjectShape_.
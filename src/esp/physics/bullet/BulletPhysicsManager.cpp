@@ -7,8 +7,12 @@
 
 #include "BulletPhysicsManager.h"
 
+#include <Corrade/Containers/ArrayViewStl.h>
+#include <algorithm>
+#include <mutex>
 #include <utility>
 #include "BulletArticulatedObject.h"
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
 #include "BulletDynamics/Featherstone/btMultiBodyLinkCollider.h"
 #include "BulletRigidObject.h"
 #include "BulletURDFImporter.h"
@@ -18,9 +22,55 @@
 #include "esp/physics/objectManagers/RigidObjectManager.h"
 #include "esp/sim/Simulator.h"
 
+#include <LinearMath/btThreads.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace esp {
 namespace physics {
 
+namespace {
+
+/**
+ * @brief Get the task scheduler Bullet dispatches collisions with, created on
+ * first use and shared by all worlds. Null if Bullet was built without
+ * multi-threading support.
+ */
+btITaskScheduler* getBulletTaskScheduler() {
+  static std::mutex mutex;
+  static btITaskScheduler* scheduler = nullptr;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (scheduler == nullptr) {
+    scheduler = btGetOpenMPTaskScheduler();
+    if (scheduler == nullptr) {
+      // never destroyed, the scheduler's threads live as long as the process
+      scheduler = btCreateDefaultTaskScheduler();
+    }
+    if (scheduler != nullptr) {
+      btSetTaskScheduler(scheduler);
+    }
+  }
+  return scheduler;
+}
+
+//! Held by multi-threaded worlds while they use the shared task scheduler
+std::mutex taskSchedulerMutex;
+
+/**
+ * @brief Access to the time btDiscreteDynamicsWorld::stepSimulation
+ * accumulated towards its next fixed substep, which Bullet keeps protected
+ * without an accessor.
+ */
+struct WorldLocalTime : btDiscreteDynamicsWorld {
+  static btScalar& of(btDiscreteDynamicsWorld& world) {
+    return world.*(&WorldLocalTime::m_localTime);
+  }
+};
+
+}  // namespace
+
 BulletPhysicsManager::BulletPhysicsManager(
     assets::ResourceManager& _resourceManager,
     const metadata::attributes::PhysicsManagerAttributes::cptr&
@@ -28,6 +78,8 @@ BulletPhysicsManager::BulletPhysicsManager(
     : PhysicsManager(_resourceManager, _physicsManagerAttributes) {
   collisionObjToObjIds_ =
       std::make_shared<std::map<const btCollisionObject*, int>>();
+  collisionCache_ = BulletCollisionCache::create();
+  dirtyObjects_ = BulletDirtyObjectList::create();
   urdfImporter_ = std::make_unique<BulletURDFImporter>(_resourceManager);
   if (_resourceManager.getCreateRenderer()) {
     debugDrawer_ = std::make_unique<Magnum::BulletIntegration::DebugDraw>();
@@ -59,9 +111,34 @@ bool BulletPhysicsManager::initPhysicsFinalize() {
 
   //! We can potentially use other collision checking algorithms, by
   //! uncommenting the line below
-  // btGImpactCollisionAlgorithm::registerAlgorithm(&bDispatcher_);
+  // btGImpactCollisionAlgorithm::registerAlgorithm(bDispatcher_.get());
+  numThreads_ = 1;
+  const int numThreads = physicsManagerAttributes_->getNumThreads();
+  if (numThreads != 1) {
+    btITaskScheduler* scheduler = getBulletTaskScheduler();
+    if (scheduler != nullptr) {
+      numThreads_ = numThreads <= 0
+                        ? scheduler->getMaxNumThreads()
+                        : std::min(numThreads, scheduler->getMaxNumThreads());
+    } else {
+      ESP_WARNING() << "Bullet was built without multi-threading support, "
+                       "stepping the world single-threaded.";
+    }
+  }
+  if (numThreads_ > 1) {
+    // the dispatcher sizes its per-thread storage by the current thread count
+    const std::unique_lock<std::mutex> schedulerLock = useTaskScheduler();
+    bDispatcher_ =
+        std::make_unique<btCollisionDispatcherMt>(&bCollisionConfig_);
+  } else {
+    bDispatcher_ = std::make_unique<btCollisionDispatcher>(&bCollisionConfig_);
+  }
   bWorld_ = std::make_shared<btMultiBodyDynamicsWorld>(
-      &bDispatcher_, &bBroadphase_, &bSolver_, &bCollisionConfig_);
+      bDispatcher_.get(), &bBroadphase_, &bSolver_, &bCollisionConfig_);
+  // sort overlapping pairs and contact manifolds so the constraint order does
+  // not depend on which thread found a contact first
+  bWorld_->getDispatchInfo().m_deterministicOverlappingPairs =
+      physicsManagerAttributes_->getDeterministic();
 
   if (debugDrawer_) {
     debugDrawer_->setMode(
@@ -97,9 +174,9 @@ bool BulletPhysicsManager::makeAndAddRigidObject(
     int newObjectID,
     const esp::metadata::attributes::ObjectAttributes::ptr& objectAttributes,
     scene::SceneNode* objectNode) {
-  auto ptr = physics::BulletRigidObject::create(objectNode, newObjectID,
-                                                resourceManager_, bWorld_,
-                                                collisionObjToObjIds_);
+  auto ptr = physics::BulletRigidObject::create(
+      objectNode, newObjectID, resourceManager_, bWorld_, collisionObjToObjIds_,
+      collisionCache_, dirtyObjects_);
   bool objSuccess = ptr->initialize(objectAttributes);
   if (objSuccess) {
     existingObjects_.emplace(newObjectID, std::move(ptr));
@@ -169,8 +246,11 @@ int BulletPhysicsManager::addArticulatedObjectFromURDF(
        ++linkIx) {
     int linkObjectId = allocateObjectID();
     articulatedObject->objectIdToLinkId_[linkObjectId] = linkIx;
-    collisionObjToObjIds_->emplace(
-        articulatedObject->btMultiBody_->getLinkCollider(linkIx), linkObjectId);
+    auto* linkCollider =
+        articulatedObject->btMultiBody_->getLinkCollider(linkIx);
+    collisionObjToObjIds_->emplace(linkCollider, linkObjectId);
+    // contacts report links by articulated object id and link index
+    setCollisionObjectIds(linkCollider, articulatedObjectID, linkIx);
   }
 
   // attach link visual shapes
@@ -196,6 +276,8 @@ int BulletPhysicsManager::addArticulatedObjectFromURDF(
   // base collider refers to the articulated object's id
   collisionObjToObjIds_->emplace(
       articulatedObject->btMultiBody_->getBaseCollider(), articulatedObjectID);
+  setCollisionObjectIds(articulatedObject->btMultiBody_->getBaseCollider(),
+                        articulatedObjectID);
 
   existingArticulatedObjects_.emplace(articulatedObjectID,
                                       std::move(articulatedObject));
@@ -424,6 +506,7 @@ void BulletPhysicsManager::stepPhysics(double dt) {
   }
 
   // ==== Physics stepforward ======
+  const std::unique_lock<std::mutex> schedulerLock = useTaskScheduler();
   // NOTE: worldTime_ will always be a multiple of sceneMetaData_.timestep
   int numSubStepsTaken =
       bWorld_->stepSimulation(dt, /*maxSubSteps*/ 10000, fixedTimeStep_);
@@ -432,6 +515,65 @@ void BulletPhysicsManager::stepPhysics(double dt) {
   recentTimeStep_ = fixedTimeStep_;
 }
 
+void BulletPhysicsManager::deferNodesUpdate() {
+  dirtyObjects_->deferring = true;
+  for (auto& ao : existingArticulatedObjects_)
+    ao.second->deferUpdate();
+}
+
+void BulletPhysicsManager::updateNodes() {
+  dirtyObjects_->deferring = false;
+  // only rigid objects moved by the simulation have a pending transform
+  for (const int objectId : dirtyObjects_->objectIds) {
+    // the object may have been removed since it moved
+    auto objIter = existingObjects_.find(objectId);
+    if (objIter != existingObjects_.end()) {
+      objIter->second->updateNodes();
+    }
+  }
+  dirtyObjects_->objectIds.clear();
+
+  for (auto& ao : existingArticulatedObjects_)
+    ao.second->updateNodes();
+}
+
+void BulletPhysicsManager::saveStateFinalize(
+    PhysicsStateSnapshot& snapshot) const {
+  snapshot.stepRemainder = WorldLocalTime::of(*bWorld_);
+}
+
+void BulletPhysicsManager::restoreStateFinalize(
+    const PhysicsStateSnapshot& snapshot) {
+  // the remainder also offsets the interpolated transforms of the next step
+  WorldLocalTime::of(*bWorld_) = btScalar(snapshot.stepRemainder);
+
+  btOverlappingPairCache* pairCache =
+      bWorld_->getBroadphase()->getOverlappingPairCache();
+  btCollisionObjectArray& collisionObjects = bWorld_->getCollisionObjectArray();
+  for (int i = 0; i < collisionObjects.size(); ++i) {
+    btCollisionObject* collisionObject = collisionObjects[i];
+    // frees the collision algorithms and with them the cached contact points
+    if (collisionObject->getBroadphaseHandle() != nullptr) {
+      pairCache->cleanProxyFromPairs(collisionObject->getBroadphaseHandle(),
+                                     bWorld_->getDispatcher());
+    }
+    // restart the sleep timers along with the contacts
+    collisionObject->setDeactivationTime(0);
+  }
+  bWorld_->clearForces();
+  bWorld_->clearMultiBodyForces();
+  bSolver_.reset();
+}
+
+std::unique_lock<std::mutex> BulletPhysicsManager::useTaskScheduler() const {
+  if (numThreads_ <= 1) {
+    return {};
+  }
+  std::unique_lock<std::mutex> lock(taskSchedulerMutex);
+  getBulletTaskScheduler()->setNumThreadsToUse(numThreads_);
+  return lock;
+}
+
 void BulletPhysicsManager::setStageFrictionCoefficient(
     const double frictionCoefficient) {
   staticStageObject_->setFrictionCoefficient(frictionCoefficient);
@@ -507,6 +649,107 @@ RaycastResults BulletPhysicsManager::castRay(const esp::geo::Ray& ray,
   return results;
 }
 
+void BulletPhysicsManager::castRays(
+    Corrade::Containers::ArrayView<const esp::geo::Ray> rays,
+    Corrade::Containers::ArrayView<RayHitInfo> hits,
+    const double maxDistance,
+    const int collisionFilterMask,
+    int numThreads) {
+  CORRADE_ASSERT(
+      rays.empty() || (!hits.empty() && hits.size() % rays.size() == 0),
+      "BulletPhysicsManager::castRays(): expected a non-zero multiple of"
+          << rays.size() << "hit slots but got" << hits.size(), );
+  const int numRays = rays.size();
+  if (numRays == 0) {
+    return;
+  }
+  const std::size_t maxHits = hits.size() / rays.size();
+
+#ifdef _OPENMP
+  if (numThreads <= 0) {
+    numThreads = omp_get_max_threads();
+  }
+#else
+  numThreads = 1;
+#endif
+  // btDbvtBroadphase::rayTest shares its traversal stack between callers
+  // unless Bullet was built thread-safe. Checked at compile time, as probing
+  // for a task scheduler would start Bullet's thread pool.
+#if !BT_THREADSAFE
+  numThreads = 1;
+#endif
+  numThreads = std::max(1, std::min(numThreads, numRays));
+
+  const auto getObjectId = [this](const btCollisionObject* colObj) {
+    // default to -1 for "scene collision" if we don't know which object was
+    // involved
+    auto rawColObjIdIter = collisionObjToObjIds_->find(colObj);
+    return rawColObjIdIter != collisionObjToObjIds_->end()
+               ? rawColObjIdIter->second
+               : -1;
+  };
+
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic, 64)
+  for (int i = 0; i < numRays; ++i) {
+    const esp::geo::Ray& ray = rays[i];
+    Corrade::Containers::ArrayView<RayHitInfo> rayHits =
+        hits.slice(i * maxHits, (i + 1) * maxHits);
+    for (RayHitInfo& hit : rayHits) {
+      hit = RayHitInfo{};
+      hit.rayDistance = -1.0;
+    }
+    const double rayLength = static_cast<double>(ray.direction.length());
+    if (rayLength == 0) {
+      continue;
+    }
+    btVector3 from(ray.origin);
+    btVector3 to(ray.origin + ray.direction * maxDistance);
+
+    if (maxHits == 1) {
+      btCollisionWorld::ClosestRayResultCallback closestResult(from, to);
+      closestResult.m_collisionFilterMask = collisionFilterMask;
+      bWorld_->rayTest(from, to, closestResult);
+      if (closestResult.hasHit()) {
+        RayHitInfo& hit = rayHits[0];
+        hit.normal = Magnum::Vector3{closestResult.m_hitNormalWorld};
+        hit.point = Magnum::Vector3{closestResult.m_hitPointWorld};
+        hit.rayDistance =
+            (static_cast<double>(closestResult.m_closestHitFraction) *
+             maxDistance) /
+            rayLength;
+        hit.objectId = getObjectId(closestResult.m_collisionObject);
+      }
+      continue;
+    }
+
+    btCollisionWorld::AllHitsRayResultCallback allResults(from, to);
+    allResults.m_collisionFilterMask = collisionFilterMask;
+    bWorld_->rayTest(from, to, allResults);
+
+    // only convert the closest hits that fit
+    std::vector<int> order(allResults.m_hitFractions.size());
+    for (std::size_t j = 0; j < order.size(); ++j) {
+      order[j] = j;
+    }
+    const std::size_t numHits = std::min(order.size(), maxHits);
+    std::partial_sort(order.begin(), order.begin() + numHits, order.end(),
+                      [&allResults](int a, int b) {
+                        return allResults.m_hitFractions[a] <
+                               allResults.m_hitFractions[b];
+                      });
+    for (std::size_t j = 0; j < numHits; ++j) {
+      RayHitInfo& hit = rayHits[j];
+      const int k = order[j];
+      hit.normal = Magnum::Vector3{allResults.m_hitNormalWorld[k]};
+      hit.point = Magnum::Vector3{allResults.m_hitPointWorld[k]};
+      hit.rayDistance =
+          (static_cast<double>(allResults.m_hitFractions[k]) * maxDistance) /
+          rayLength;
+      hit.objectId = getObjectId(allResults.m_collisionObjects[k]);
+    }
+  }
+}
+
 void BulletPhysicsManager::lookUpObjectIdAndLinkId(
     const btCollisionObject* colObj,
     int* objectId,
@@ -514,38 +757,35 @@ void BulletPhysicsManager::lookUpObjectIdAndLinkId(
   CORRADE_INTERNAL_ASSERT(objectId);
   CORRADE_INTERNAL_ASSERT(linkId);
 
-  *linkId = -1;
-  // If the lookup fails, default to the stage. TODO: better error-handling.
-  *objectId = -1;
-  auto rawColObjIdIter = collisionObjToObjIds_->find(colObj);
-  if (rawColObjIdIter != collisionObjToObjIds_->end()) {
-    int rawObjectId = rawColObjIdIter->second;
-    if (existingObjects_.count(rawObjectId) != 0u ||
-        existingArticulatedObjects_.count(rawObjectId) != 0u) {
-      *objectId = rawObjectId;
-      return;
-    } else {
-      // search articulated objects to see if this is a link
-      for (const auto& pair : existingArticulatedObjects_) {
-        auto objIdToLinkIter = pair.second->objectIdToLinkId_.find(rawObjectId);
-        if (objIdToLinkIter != pair.second->objectIdToLinkId_.end()) {
-          *objectId = pair.first;
-          *linkId = objIdToLinkIter->second;
-          return;
-        }
-      }
-    }
+  // see setCollisionObjectIds(). Untagged objects default to the stage (-1).
+  *objectId = colObj->getUserIndex();
+  *linkId = colObj->getUserIndex2();
+}
+
+std::vector<ContactPointData> BulletPhysicsManager::getContactPoints() const {
+  auto* dispatcher = bWorld_->getDispatcher();
+  std::size_t numContactPoints = 0;
+  for (int i = 0; i < dispatcher->getNumManifolds(); ++i) {
+    numContactPoints +=
+        dispatcher->getInternalManifoldPointer()[i]->getNumContacts();
   }
 
-  // lookup failed
+  std::vector<ContactPointData> contactPoints(numContactPoints);
+  getContactPoints(Corrade::Containers::arrayView(contactPoints));
+  return contactPoints;
 }
 
-std::vector<ContactPointData> BulletPhysicsManager::getContactPoints() const {
-  std::vector<ContactPointData> contactPoints;
+std::size_t BulletPhysicsManager::getContactPoints(
+    Corrade::Containers::ArrayView<ContactPointData> contactPoints,
+    Corrade::Containers::ArrayView<const int> objectIds) const {
+  const auto isQueried = [&objectIds](int objectId) {
+    return std::find(objectIds.begin(), objectIds.end(), objectId) !=
+           objectIds.end();
+  };
 
+  std::size_t numContactPoints = 0;
   auto* dispatcher = bWorld_->getDispatcher();
   int numContactManifolds = dispatcher->getNumManifolds();
-  contactPoints.reserve(numContactManifolds * 4);
   for (int i = 0; i < numContactManifolds; ++i) {
     const btPersistentManifold* manifold =
         dispatcher->getInternalManifoldPointer()[i];
@@ -561,6 +801,11 @@ std::vector<ContactPointData> BulletPhysicsManager::getContactPoints() const {
     lookUpObjectIdAndLinkId(colObj0, &objectIdA, &linkIndexA);
     lookUpObjectIdAndLinkId(colObj1, &objectIdB, &linkIndexB);
 
+    if (!objectIds.empty() && !isQueried(objectIdA) &&
+        !isQueried(objectIdB)) {
+      continue;
+    }
+
     // logic copied from btSimulationIslandManager::buildIslands. We count
     // manifolds as active only if related to non-sleeping bodies.
     bool isActive = ((((colObj0) != nullptr) &&
@@ -568,8 +813,12 @@ std::vector<ContactPointData> BulletPhysicsManager::getContactPoints() const {
                      (((colObj1) != nullptr) &&
                       colObj1->getActivationState() != ISLAND_SLEEPING));
 
-    for (int p = 0; p < manifold->getNumContacts(); ++p) {
-      ContactPointData pt;
+    for (int p = 0; p < manifold->getNumContacts(); ++p, ++numContactPoints) {
+      // keep counting past the end of the buffer to report the needed size
+      if (numContactPoints >= contactPoints.size()) {
+        continue;
+      }
+      ContactPointData& pt = contactPoints[numContactPoints];
       pt.objectIdA = objectIdA;
       pt.objectIdB = objectIdB;
       const btManifoldPoint& srcPt = manifold->getContactPoint(p);
@@ -593,12 +842,10 @@ std::vector<ContactPointData> BulletPhysicsManager::getContactPoints() const {
       pt.linearFrictionDirection2 = Mn::Vector3(srcPt.m_lateralFrictionDir2);
 
       pt.isActive = isActive;
-
-      contactPoints.push_back(pt);
     }
   }
 
-  return contactPoints;
+  return numContactPoints;
 }
 
 //============ Rigid Constraints =============
@@ -9,6 +9,8 @@
  * @brief Class @ref esp::physics::BulletPhysicsManager
  */
 
+#include <mutex>
+
 /* Bullet Physics Integration */
 #include <Magnum/BulletIntegration/DebugDraw.h>
 #include <Magnum/BulletIntegration/Integration.h>
@@ -168,6 +170,26 @@ class BulletPhysicsManager : public PhysicsManager {
    */
   void stepPhysics(double dt) override;
 
+  /** @brief Defers the update of the scene graph nodes until updateNodes is
+   * called. Rigid objects moved by the simulation in the meantime are
+   * recorded in @ref dirtyObjects_.
+   */
+  void deferNodesUpdate() override;
+
+  /** @brief Syncs the state of physics simulation to the rendering scene
+   * graph. Only visits the rigid objects moved since @ref deferNodesUpdate,
+   * so the cost scales with the number of active objects.
+   */
+  void updateNodes() override;
+
+  /**
+   * @brief Get the ids of the rigid objects with a scene graph update pending
+   * since @ref deferNodesUpdate, in the order they were moved.
+   */
+  const std::vector<int>& getDeferredObjectIds() const {
+    return dirtyObjects_->objectIds;
+  }
+
   /** @brief Set the gravity of the physical world.
    * @param gravity The desired gravity force of the physical world.
    */
@@ -248,6 +270,21 @@ class BulletPhysicsManager : public PhysicsManager {
    */
   std::vector<ContactPointData> getContactPoints() const override;
 
+  /**
+   * @brief Write ContactPointData describing the contacts from the most
+   * recent physics substep into a caller-provided buffer.
+   *
+   * @param[out] contactPoints Filled with the first matching contact points.
+   * @param objectIds If not empty, only contacts involving one of these object
+   * ids are reported.
+   * @return The number of matching contact points, which may exceed the size
+   * of contactPoints.
+   */
+  std::size_t getContactPoints(
+      Corrade::Containers::ArrayView<ContactPointData> contactPoints,
+      Corrade::Containers::ArrayView<const int> objectIds =
+          nullptr) const override;
+
   /**
    * @brief Cast a ray into the collision world and return a @ref RaycastResults
    * with hit information.
@@ -261,6 +298,25 @@ class BulletPhysicsManager : public PhysicsManager {
   RaycastResults castRay(const esp::geo::Ray& ray,
                          double maxDistance = 100.0) override;
 
+  /**
+   * @brief Cast a batch of rays into the collision world, see @ref
+   * PhysicsManager::castRays. Rays are cast in parallel only if Bullet was
+   * built thread-safe, as concurrent ray tests are not safe otherwise.
+   * @param[in] rays The rays to cast.
+   * @param[out] hits The hit slots of all rays.
+   * @param[in] maxDistance The maximum distance along the ray direction to
+   * search. In units of ray length.
+   * @param[in] collisionFilterMask Bitmask of @ref CollisionGroup values of
+   * the objects rays may hit.
+   * @param[in] numThreads The number of worker threads. Values <= 0 use the
+   * OpenMP default.
+   */
+  void castRays(Corrade::Containers::ArrayView<const esp::geo::Ray> rays,
+                Corrade::Containers::ArrayView<RayHitInfo> hits,
+                double maxDistance = 100.0,
+                int collisionFilterMask = -1,
+                int numThreads = 0) override;
+
   /**
    * @brief Query the number of contact points that were active during the
    * collision detection check.
@@ -304,6 +360,7 @@ class BulletPhysicsManager : public PhysicsManager {
    * @brief Perform discrete collision detection for the scene.
    */
   void performDiscreteCollisionDetection() override {
+    const std::unique_lock<std::mutex> schedulerLock = useTaskScheduler();
     bWorld_->getCollisionWorld()->performDiscreteCollisionDetection();
     recentNumSubStepsTaken_ = -1;  // TODO: handle this more gracefully
   }
@@ -370,6 +427,20 @@ class BulletPhysicsManager : public PhysicsManager {
    */
   bool initPhysicsFinalize() override;
 
+  /**
+   * @brief Capture the time Bullet accumulated towards its next fixed
+   * substep, see @ref PhysicsStateSnapshot::stepRemainder.
+   */
+  void saveStateFinalize(PhysicsStateSnapshot& snapshot) const override;
+
+  /**
+   * @brief Restore the time accumulated towards the next fixed substep and
+   * drop the contact manifolds, pending forces and solver state accumulated
+   * before @ref restoreState, so the simulation continues the same way after
+   * every restore of a snapshot.
+   */
+  void restoreStateFinalize(const PhysicsStateSnapshot& snapshot) override;
+
   /**
    * @brief Create an object wrapper appropriate for this physics manager.
    * Overridden if called by dynamics-library-enabled PhysicsManager
@@ -413,7 +484,11 @@ class BulletPhysicsManager : public PhysicsManager {
   btDefaultCollisionConfiguration bCollisionConfig_;
 
   btMultiBodyConstraintSolver bSolver_;
-  btCollisionDispatcher bDispatcher_{&bCollisionConfig_};
+  //! A @ref btCollisionDispatcherMt if the world is stepped multi-threaded
+  std::unique_ptr<btCollisionDispatcher> bDispatcher_;
+
+  //! Number of threads used to dispatch collisions, 1 if single-threaded
+  int numThreads_ = 1;
 
   /** @brief A pointer to the Bullet world. See @ref btMultiBodyDynamicsWorld.*/
   std::shared_ptr<btMultiBodyDynamicsWorld> bWorld_;
@@ -425,12 +500,30 @@ class BulletPhysicsManager : public PhysicsManager {
   std::shared_ptr<std::map<const btCollisionObject*, int>>
       collisionObjToObjIds_;
 
+  //! collision geometry shared by the objects built from the same asset
+  BulletCollisionCache::ptr collisionCache_;
+
+  //! rigid objects moved while scene graph updates are deferred
+  BulletDirtyObjectList::ptr dirtyObjects_;
+
   //! necessary to acquire forces from impulses
   double recentTimeStep_ = fixedTimeStep_;
   //! for recent call to stepPhysics
   int recentNumSubStepsTaken_ = -1;
 
  private:
+  /**
+   * @brief Set Bullet's process-wide task scheduler up for this world before
+   * dispatching collisions.
+   *
+   * All worlds of the process share the scheduler and its thread count, so
+   * multi-threaded worlds take turns: the returned lock must be held until
+   * the dispatch is done. Multi-threaded worlds of concurrently stepped
+   * simulators therefore step one at a time. Single-threaded worlds don't use
+   * the scheduler and get an empty lock.
+   */
+  std::unique_lock<std::mutex> useTaskScheduler() const;
+
   /**
    * @brief Helper function for getting object and link unique ids from
    * btCollisionObject cache
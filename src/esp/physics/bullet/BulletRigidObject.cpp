@@ -7,6 +7,7 @@
 
 #include <Corrade/Utility/Assert.h>
 
+#include <algorithm>
 #include <utility>
 
 #include "BulletCollision/CollisionShapes/btCompoundShape.h"
@@ -41,10 +42,14 @@ BulletRigidObject::BulletRigidObject(
     const assets::ResourceManager& resMgr,
     std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
     std::shared_ptr<std::map<const btCollisionObject*, int> >
-        collisionObjToObjIds)
+        collisionObjToObjIds,
+    BulletCollisionCache::ptr collisionCache,
+    BulletDirtyObjectList::ptr dirtyObjects)
     : BulletBase(std::move(bWorld), std::move(collisionObjToObjIds)),
       RigidObject(rigidBodyNode, objectId, resMgr),
-      MotionState{*rigidBodyNode} {}
+      MotionState{*rigidBodyNode},
+      collisionCache_(std::move(collisionCache)),
+      dirtyObjects_(std::move(dirtyObjects)) {}
 
 BulletRigidObject::~BulletRigidObject() {
   if (!BulletRigidObject::isActive()) {
@@ -84,7 +89,6 @@ bool BulletRigidObject::constructCollisionShape() {
 
   //! Physical parameters
   double margin = tmpAttr->getMargin();
-  bool joinCollisionMeshes = tmpAttr->getJoinCollisionMeshes();
   usingBBCollisionShape_ = tmpAttr->getBoundingBoxCollisions();
 
   // TODO(alexanderwclegg): should provide the option for joinCollisionMeshes
@@ -117,40 +121,22 @@ bool BulletRigidObject::constructCollisionShape() {
     bObjectShape_->addChildShape(btTransform::getIdentity(),
                                  bGenericShapes_.back().get());
     bObjectShape_->recalculateLocalAabb();
-  } else {
+  } else if (!usingBBCollisionShape_) {
     // mesh collider
-    const std::vector<assets::CollisionMeshData>& meshGroup =
-        resMgr_.getCollisionMesh(collisionAssetHandle);
-    const assets::MeshMetaData& metaData =
-        resMgr_.getMeshMetaData(collisionAssetHandle);
-
-    if (!usingBBCollisionShape_) {
-      if (joinCollisionMeshes) {
-        bObjectConvexShapes_.emplace_back(
-            std::make_unique<btConvexHullShape>());
-        constructJoinedConvexShapeFromMeshes(Magnum::Matrix4{}, meshGroup,
-                                             metaData.root,
-                                             bObjectConvexShapes_.back().get());
-
-        // add the final object after joining meshes
-        bObjectConvexShapes_.back()->setLocalScaling(
-            btVector3(tmpAttr->getCollisionAssetSize()));
-        bObjectConvexShapes_.back()->setMargin(0.0);
-        bObjectConvexShapes_.back()->recalcLocalAabb();
-        bObjectShape_->addChildShape(btTransform::getIdentity(),
-                                     bObjectConvexShapes_.back().get());
-      } else {
-        constructConvexShapesFromMeshes(Magnum::Matrix4{}, meshGroup,
-                                        metaData.root, bObjectShape_.get(),
-                                        bObjectConvexShapes_);
-      }
+    bObjectConvexShapes_ = getConvexShapes(0.0);
+    for (const auto& convexShape : bObjectConvexShapes_) {
+      bObjectShape_->addChildShape(btTransform::getIdentity(),
+                                   convexShape.get());
     }
   }  // if using prim collider else use mesh collider
 
   //! Set properties
   bObjectShape_->setMargin(margin);
 
-  bObjectShape_->setLocalScaling(btVector3{tmpAttr->getScale()});
+  // mesh convex shapes are built at the object scale, as they may be shared
+  if (bObjectConvexShapes_.empty()) {
+    bObjectShape_->setLocalScaling(btVector3{tmpAttr->getScale()});
+  }
   bObjectShape_->recalculateLocalAabb();
 
   if (!originShift_.isZero()) {
@@ -161,6 +147,137 @@ bool BulletRigidObject::constructCollisionShape() {
   return true;
 }
 
+std::vector<std::shared_ptr<btConvexHullShape>>
+BulletRigidObject::getConvexShapes(double margin) {
+  auto tmpAttr = getInitializationAttributes();
+  // separate meshes ignore the collision asset size
+  const Mn::Vector3 localScaling =
+      tmpAttr->getJoinCollisionMeshes()
+          ? tmpAttr->getScale() * tmpAttr->getCollisionAssetSize()
+          : tmpAttr->getScale();
+  const BulletCollisionCache::ConvexShapeKey key{
+      tmpAttr->getCollisionAssetHandle(), localScaling, margin,
+      tmpAttr->getJoinCollisionMeshes(),
+      tmpAttr->getSimplifyCollisionHulls()
+          ? std::max(tmpAttr->getMaxCollisionHullVertices(), 0)
+          : -1};
+
+  std::vector<std::shared_ptr<btConvexHullShape>> convexShapes;
+  if (collisionCache_) {
+    auto cached = collisionCache_->convexShapes.find(key);
+    if (cached != collisionCache_->convexShapes.end()) {
+      for (const auto& weakShape : cached->second) {
+        std::shared_ptr<btConvexHullShape> shape = weakShape.lock();
+        if (!shape) {
+          break;
+        }
+        convexShapes.push_back(std::move(shape));
+      }
+      if (convexShapes.size() == cached->second.size()) {
+        return convexShapes;
+      }
+      // released by all objects in the meantime
+      convexShapes.clear();
+    }
+  }
+
+  const std::vector<assets::CollisionMeshData>& meshGroup =
+      resMgr_.getCollisionMesh(key.collisionAssetHandle);
+  const assets::MeshMetaData& metaData =
+      resMgr_.getMeshMetaData(key.collisionAssetHandle);
+
+  if (key.maxHullVertices >= 0) {
+    for (const std::vector<Mn::Vector3>& hull :
+         *getConvexHulls(meshGroup, metaData)) {
+      convexShapes.emplace_back(std::make_shared<btConvexHullShape>());
+      for (const Mn::Vector3& v : hull) {
+        convexShapes.back()->addPoint(btVector3(v), false);
+      }
+    }
+  } else if (key.joinCollisionMeshes) {
+    convexShapes.emplace_back(std::make_shared<btConvexHullShape>());
+    constructJoinedConvexShapeFromMeshes(Magnum::Matrix4{}, meshGroup,
+                                         metaData.root,
+                                         convexShapes.back().get());
+  } else {
+    std::vector<std::unique_ptr<btConvexHullShape>> meshShapes;
+    constructConvexShapesFromMeshes(Magnum::Matrix4{}, meshGroup,
+                                    metaData.root, nullptr, meshShapes);
+    for (auto& meshShape : meshShapes) {
+      convexShapes.emplace_back(std::move(meshShape));
+    }
+  }
+
+  for (const auto& convexShape : convexShapes) {
+    convexShape->setLocalScaling(btVector3(key.localScaling));
+    convexShape->setMargin(margin);
+    convexShape->recalcLocalAabb();
+  }
+
+  if (collisionCache_) {
+    collisionCache_->convexShapes[key] =
+        std::vector<std::weak_ptr<btConvexHullShape>>(convexShapes.begin(),
+                                                      convexShapes.end());
+  }
+  return convexShapes;
+}
+
+void BulletRigidObject::setMargin(const double margin) {
+  if (!collisionCache_) {
+    for (std::size_t i = 0; i < bObjectConvexShapes_.size(); ++i) {
+      bObjectConvexShapes_[i]->setMargin(margin);
+    }
+  } else if (!bObjectConvexShapes_.empty()) {
+    // shared shapes are never modified, swap in the ones with the new margin
+    std::vector<std::shared_ptr<btConvexHullShape>> convexShapes =
+        getConvexShapes(margin);
+    for (std::size_t i = 0; i < bObjectConvexShapes_.size(); ++i) {
+      for (int j = 0; j < bObjectShape_->getNumChildShapes(); ++j) {
+        if (bObjectShape_->getChildShape(j) == bObjectConvexShapes_[i].get()) {
+          const btTransform childTransform =
+              bObjectShape_->getChildTransform(j);
+          bObjectShape_->removeChildShapeByIndex(j);
+          bObjectShape_->addChildShape(childTransform, convexShapes[i].get());
+          break;
+        }
+      }
+    }
+    bObjectConvexShapes_ = std::move(convexShapes);
+  }
+  if (!bObjectConvexShapes_.empty()) {
+    bObjectShape_->recalculateLocalAabb();
+  }
+  bObjectShape_->setMargin(margin);
+}
+
+std::shared_ptr<const BulletCollisionCache::ConvexPoints>
+BulletRigidObject::getConvexHulls(
+    const std::vector<assets::CollisionMeshData>& meshGroup,
+    const assets::MeshMetaData& metaData) {
+  auto tmpAttr = getInitializationAttributes();
+  const BulletCollisionCache::ConvexHullKey key{
+      tmpAttr->getCollisionAssetHandle(), tmpAttr->getJoinCollisionMeshes(),
+      std::max(tmpAttr->getMaxCollisionHullVertices(), 0)};
+  if (collisionCache_) {
+    auto cached = collisionCache_->convexHulls.find(key);
+    if (cached != collisionCache_->convexHulls.end()) {
+      return cached->second;
+    }
+  }
+
+  auto hulls = std::make_shared<BulletCollisionCache::ConvexPoints>();
+  collectConvexPointsFromMeshes(Mn::Matrix4{}, meshGroup, metaData.root,
+                                std::get<1>(key), *hulls);
+  for (std::vector<Mn::Vector3>& points : *hulls) {
+    points = computeConvexHull(points, std::get<2>(key));
+  }
+
+  if (collisionCache_) {
+    collisionCache_->convexHulls.emplace(key, hulls);
+  }
+  return hulls;
+}
+
 std::unique_ptr<btCollisionShape>
 BulletRigidObject::buildPrimitiveCollisionObject(int primTypeVal,
                                                  double halfLength) {
@@ -389,6 +506,7 @@ void BulletRigidObject::constructAndAddRigidBody(MotionType mt) {
   }
   bObjectRigidBody_ = std::make_unique<btRigidBody>(info);
   collisionObjToObjIds_->emplace(bObjectRigidBody_.get(), objectId_);
+  setCollisionObjectIds(bObjectRigidBody_.get(), objectId_);
   BulletCollisionHelper::get().mapCollisionObjectTo(bObjectRigidBody_.get(),
                                                     getCollisionDebugName());
 
@@ -527,7 +645,11 @@ void BulletRigidObject::updateNodes(bool force) {
 }
 
 void BulletRigidObject::setWorldTransform(const btTransform& worldTrans) {
-  if (isDeferringUpdate_) {
+  if (isDeferringUpdate_ || (dirtyObjects_ && dirtyObjects_->deferring)) {
+    // enqueue once, the latest transform is applied in updateNodes()
+    if (dirtyObjects_ && !deferredUpdate_) {
+      dirtyObjects_->objectIds.push_back(objectId_);
+    }
     deferredUpdate_ = {worldTrans};
   } else {
     MotionState::setWorldTransform(worldTrans);
@@ -6,7 +6,8 @@
 #define ESP_PHYSICS_BULLET_BULLETRIGIDOBJECT_H_
 
 /** @file
- * @brief Struct SimulationContactResultCallback, class @ref
+ * @brief Struct SimulationContactResultCallback, struct @ref
+ * esp::physics::BulletDirtyObjectList, class @ref
  * esp::physics::BulletRigidObject
  */
 
@@ -27,6 +28,23 @@
 namespace esp {
 namespace physics {
 
+/**
+ * @brief Rigid objects moved by the simulation while scene graph updates are
+ * deferred. Shared between a @ref BulletPhysicsManager and its rigid objects,
+ * so that syncing the scene graph only visits the objects that moved instead
+ * of every object in the world.
+ */
+struct BulletDirtyObjectList {
+  //! Whether scene graph updates are deferred until the next
+  //! @ref BulletPhysicsManager::updateNodes
+  bool deferring = false;
+
+  //! Ids of the objects with a pending transform, each listed once
+  std::vector<int> objectIds;
+
+  ESP_SMART_POINTERS(BulletDirtyObjectList)
+};
+
 /**
  * @brief An individual rigid object instance implementing an interface with
  * Bullet physics to enable dynamic objects. See @ref btRigidBody for @ref
@@ -49,13 +67,19 @@ class BulletRigidObject : public BulletBase,
    * @param bWorld The Bullet world to which this object will belong.
    * @param collisionObjToObjIds The global map of btCollisionObjects to Habitat
    * object IDs for contact query identification.
+   * @param collisionCache Collision geometry shared with the other objects of
+   * the world. If null, shared geometry is computed for this object only.
+   * @param dirtyObjects The world's list of objects moved while scene graph
+   * updates are deferred. If null, only @ref deferUpdate defers updates.
    */
   BulletRigidObject(scene::SceneNode* rigidBodyNode,
                     int objectId,
                     const assets::ResourceManager& resMgr,
                     std::shared_ptr<btMultiBodyDynamicsWorld> bWorld,
                     std::shared_ptr<std::map<const btCollisionObject*, int>>
-                        collisionObjToObjIds);
+                        collisionObjToObjIds,
+                    BulletCollisionCache::ptr collisionCache = nullptr,
+                    BulletDirtyObjectList::ptr dirtyObjects = nullptr);
 
   /**
    * @brief Destructor cleans up simulation structures for the object.
@@ -439,12 +463,7 @@ class BulletRigidObject : public BulletBase,
    * btCompoundShape::setMargin.
    * @param margin The new scalar collision margin of the object.
    */
-  void setMargin(const double margin) override {
-    for (std::size_t i = 0; i < bObjectConvexShapes_.size(); ++i) {
-      bObjectConvexShapes_[i]->setMargin(margin);
-    }
-    bObjectShape_->setMargin(margin);
-  }
+  void setMargin(double margin) override;
 
   /** @brief Sets the object's collision shape to its bounding box.
    * Since the bounding hierarchy is not constructed when the object is
@@ -534,6 +553,32 @@ class BulletRigidObject : public BulletBase,
   //! Object data: All components of the collision shape
   std::unique_ptr<btCompoundShape> bObjectShape_;
 
+  //! Collision geometry shared with the other objects of the world
+  BulletCollisionCache::ptr collisionCache_;
+
+  //! The world's list of objects moved while scene graph updates are deferred
+  BulletDirtyObjectList::ptr dirtyObjects_;
+
+  /**
+   * @brief Get the simplified convex hulls of the mesh collision asset of this
+   * object, computing and caching them on first use.
+   * @param meshGroup The collision meshes of the asset.
+   * @param metaData The mesh meta data of the asset.
+   */
+  std::shared_ptr<const BulletCollisionCache::ConvexPoints> getConvexHulls(
+      const std::vector<assets::CollisionMeshData>& meshGroup,
+      const assets::MeshMetaData& metaData);
+
+  /**
+   * @brief Get the convex child shapes of this object's mesh collision shape
+   * with the given margin, scaled by the object scale. Shapes still in use by
+   * another object built from the same asset at the same scale are shared
+   * instead of constructed anew.
+   * @param margin The collision margin of the shapes.
+   */
+  std::vector<std::shared_ptr<btConvexHullShape>> getConvexShapes(
+      double margin);
+
   std::unique_ptr<btCompoundShape> bEmptyShape_;
 
   void setWorldTransform(const btTransform& worldTrans) override;
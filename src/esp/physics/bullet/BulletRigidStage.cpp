@@ -5,6 +5,12 @@
 #include <Magnum/BulletIntegration/DebugDraw.h>
 #include <Magnum/BulletIntegration/Integration.h>
 
+#include <algorithm>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
 #include <utility>
 
 #include "BulletCollision/CollisionShapes/btCompoundShape.h"
@@ -20,6 +26,76 @@
 namespace esp {
 namespace physics {
 
+namespace {
+
+//! Key of the stage BVH cache: collision asset handle, mesh index within the
+//! asset, vertex and index count of the mesh, local scaling and margin of the
+//! mesh shape
+typedef std::tuple<std::string,
+                   int,
+                   std::size_t,
+                   std::size_t,
+                   float,
+                   float,
+                   float,
+                   float>
+    StageBvhKey;
+
+//! Number of most recently instanced stage collision assets whose BVHs stay
+//! cached after the last stage using them is released
+constexpr std::size_t maxCachedStageAssets = 4;
+
+std::mutex stageBvhCacheMutex;
+
+//! BVHs of the recently instanced stages, guarded by stageBvhCacheMutex. The
+//! cache keeps them alive between stage instances, e.g. across a
+//! reconfigure to the same scene, which releases the old stage before
+//! instancing the new one.
+std::map<StageBvhKey, std::shared_ptr<btOptimizedBvh>>& stageBvhCache() {
+  static std::map<StageBvhKey, std::shared_ptr<btOptimizedBvh>> cache;
+  return cache;
+}
+
+//! Collision asset handles of the cached BVHs, most recently used first,
+//! guarded by stageBvhCacheMutex
+std::list<std::string>& stageBvhCacheOrder() {
+  static std::list<std::string> order;
+  return order;
+}
+
+//! Number of BVHs built on cache misses, guarded by stageBvhCacheMutex
+int numStageBvhBuilds = 0;
+
+/**
+ * @brief Mark the BVHs of a collision asset as the most recently used and
+ * evict those of the least recently used assets beyond
+ * maxCachedStageAssets. Stages still using an evicted BVH keep it alive.
+ * Must be called with stageBvhCacheMutex held.
+ */
+void touchCachedStageAsset(const std::string& collisionAssetHandle) {
+  std::list<std::string>& order = stageBvhCacheOrder();
+  auto used = std::find(order.begin(), order.end(), collisionAssetHandle);
+  if (used != order.end()) {
+    order.splice(order.begin(), order, used);
+  } else {
+    order.push_front(collisionAssetHandle);
+  }
+
+  while (order.size() > maxCachedStageAssets) {
+    auto& cache = stageBvhCache();
+    for (auto it = cache.begin(); it != cache.end();) {
+      if (std::get<0>(it->first) == order.back()) {
+        it = cache.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    order.pop_back();
+  }
+}
+
+}  // namespace
+
 BulletRigidStage::BulletRigidStage(
     scene::SceneNode* rigidBodyNode,
     const assets::ResourceManager& resMgr,
@@ -84,6 +160,7 @@ void BulletRigidStage::constructAndAddCollisionObjects() {
       object->setRestitution(
           initializationAttributes_->getRestitutionCoefficient());
       collisionObjToObjIds_->emplace(object.get(), objectId_);
+      setCollisionObjectIds(object.get(), objectId_);
     }
   }
 
@@ -140,14 +217,20 @@ void BulletRigidStage::constructBulletSceneFromMeshes(
     //! which allows concavity if the object is static
     std::unique_ptr<btBvhTriangleMeshShape> meshShape =
         std::make_unique<btBvhTriangleMeshShape>(indexedVertexArray.get(),
-                                                 true);
+                                                 true, false);
     meshShape->setMargin(initializationAttributes_->getMargin());
-    meshShape->setLocalScaling(
-        btVector3{transformFromLocalToWorld
-                      .scaling()});  // scale is a property of the shape
+    // scale is a property of the shape
+    const btVector3 scaling{transformFromLocalToWorld.scaling()};
+    if ((meshShape->getLocalScaling() - scaling).length2() > SIMD_EPSILON) {
+      // rescale the mesh only, without the bvh rebuild of the derived class
+      meshShape->btTriangleMeshShape::setLocalScaling(scaling);
+    }
 
-    // re-build the bvh after setting margin
-    meshShape->buildOptimizedBvh();
+    // build the bvh after setting margin and scale, or reuse the one built
+    // for a previous instance of this stage
+    std::shared_ptr<btOptimizedBvh> bvh =
+        getOptimizedBvh(*meshShape, node.meshIDLocal, *mesh);
+    meshShape->setOptimizedBvh(bvh.get(), scaling);
     // mass == 0 to indicate static. See isStaticObject assert below. See also
     // examples/MultiThreadedDemo/CommonRigidBodyMTBase.h
     btVector3 localInertia(0, 0, 0);
@@ -162,6 +245,7 @@ void BulletRigidStage::constructBulletSceneFromMeshes(
     BulletCollisionHelper::get().mapCollisionObjectTo(
         sceneCollisionObject.get(),
         getCollisionDebugName(bStaticCollisionObjects_.size()));
+    bStageBvhs_.emplace_back(std::move(bvh));
     bStageArrays_.emplace_back(std::move(indexedVertexArray));
     bStageShapes_.emplace_back(std::move(meshShape));
     bStaticCollisionObjects_.emplace_back(std::move(sceneCollisionObject));
@@ -172,6 +256,56 @@ void BulletRigidStage::constructBulletSceneFromMeshes(
   }
 }  // constructBulletSceneFromMeshes
 
+std::shared_ptr<btOptimizedBvh> BulletRigidStage::getOptimizedBvh(
+    btBvhTriangleMeshShape& meshShape,
+    int meshID,
+    const assets::CollisionMeshData& mesh) {
+  const btVector3& scaling = meshShape.getLocalScaling();
+  const StageBvhKey key{initializationAttributes_->getCollisionAssetHandle(),
+                        meshID,
+                        mesh.positions.size(),
+                        mesh.indices.size(),
+                        scaling.x(),
+                        scaling.y(),
+                        scaling.z(),
+                        meshShape.getMargin()};
+  {
+    std::lock_guard<std::mutex> lock(stageBvhCacheMutex);
+    auto cached = stageBvhCache().find(key);
+    if (cached != stageBvhCache().end()) {
+      touchCachedStageAsset(std::get<0>(key));
+      return cached->second;
+    }
+  }
+
+  // quantize over the same bounds btBvhTriangleMeshShape::buildOptimizedBvh
+  // uses, the local Aabb without the margin getAabb adds
+  btVector3 aabbMin, aabbMax;
+  meshShape.getAabb(btTransform::getIdentity(), aabbMin, aabbMax);
+  const btVector3 margin{meshShape.getMargin(), meshShape.getMargin(),
+                         meshShape.getMargin()};
+  // btOptimizedBvh declares an aligned operator new
+  std::shared_ptr<btOptimizedBvh> bvh(new btOptimizedBvh());
+  bvh->build(meshShape.getMeshInterface(), true, aabbMin + margin,
+             aabbMax - margin);
+
+  std::lock_guard<std::mutex> lock(stageBvhCacheMutex);
+  ++numStageBvhBuilds;
+  // another thread may have built the same bvh concurrently, keep theirs
+  std::shared_ptr<btOptimizedBvh>& cached = stageBvhCache()[key];
+  if (!cached) {
+    cached = std::move(bvh);
+  }
+  std::shared_ptr<btOptimizedBvh> result = cached;
+  touchCachedStageAsset(std::get<0>(key));
+  return result;
+}
+
+int BulletRigidStage::getNumOptimizedBvhBuilds() {
+  std::lock_guard<std::mutex> lock(stageBvhCacheMutex);
+  return numStageBvhBuilds;
+}
+
 void BulletRigidStage::setFrictionCoefficient(
     const double frictionCoefficient) {
   for (std::size_t i = 0; i < bStaticCollisionObjects_.size(); ++i) {
@@ -54,6 +54,23 @@ class BulletRigidStage : public BulletBase, public RigidStage {
       const std::vector<assets::CollisionMeshData>& meshGroup,
       const assets::MeshTransformNode& node);
 
+  /**
+   * @brief Get the quantized bvh of a stage mesh shape, building it on first
+   * use. The bvhs are shared by all instances of the same stage in the
+   * process and stay cached for the few most recently instanced stages, so
+   * instancing a stage again, e.g. on a reconfigure to the same scene, skips
+   * the bvh construction.
+   * @param meshShape The mesh shape, with its final margin and scaling.
+   * @param meshID The index of the mesh within the collision asset.
+   * @param mesh The collision mesh data the shape is built from.
+   * @return The bvh, to be set with @ref
+   * btBvhTriangleMeshShape::setOptimizedBvh.
+   */
+  std::shared_ptr<btOptimizedBvh> getOptimizedBvh(
+      btBvhTriangleMeshShape& meshShape,
+      int meshID,
+      const assets::CollisionMeshData& mesh);
+
   /**
    * @brief Adds static stage collision objects to the simulation world after
    * contracting them if necessary.
@@ -105,9 +122,19 @@ class BulletRigidStage : public BulletBase, public RigidStage {
    */
   void setRestitutionCoefficient(double restitutionCoefficient) override;
 
+  /**
+   * @brief Number of stage mesh bvhs built so far in this process, i.e. the
+   * bvh cache misses of all stage instances.
+   */
+  static int getNumOptimizedBvhBuilds();
+
  private:
   // === Physical stage ===
 
+  //! Stage data: Bullet quantized bvhs of the mesh shapes, possibly shared
+  //! with other instances of the same stage
+  std::vector<std::shared_ptr<btOptimizedBvh>> bStageBvhs_;
+
   //! Stage data: Bullet triangular mesh vertices
   std::vector<std::unique_ptr<btTriangleIndexVertexArray>> bStageArrays_;
 
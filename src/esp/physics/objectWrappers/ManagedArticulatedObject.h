@@ -141,6 +141,39 @@ class ManagedArticulatedObject
     return {};
   }
 
+  int getNumJointPositions() const {
+    if (auto sp = getObjectReference()) {
+      return sp->getNumJointPositions();
+    }
+    return 0;
+  }
+
+  int getNumDoFs() const {
+    if (auto sp = getObjectReference()) {
+      return sp->getNumDoFs();
+    }
+    return 0;
+  }
+
+  std::vector<float> getPackedState() const {
+    if (auto sp = getObjectReference()) {
+      std::vector<float> state(sp->getPackedStateSize());
+      sp->getPackedState({state.data(), state.size()});
+      return state;
+    }
+    return {};
+  }
+
+  void setPackedState(const std::vector<float>& state) {
+    if (auto sp = getObjectReference()) {
+      ESP_CHECK(state.size() == sp->getPackedStateSize(),
+                "ManagedArticulatedObject::setPackedState(): expected"
+                    << sp->getPackedStateSize() << "values but got"
+                    << state.size());
+      sp->setPackedState({state.data(), state.size()});
+    }
+  }
+
   std::vector<float> getJointMotorTorques(double fixedTimeStep) {
     if (auto sp = getObjectReference()) {
       return sp->getJointMotorTorques(fixedTimeStep);
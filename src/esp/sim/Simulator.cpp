@@ -4,7 +4,9 @@
 
 #include "Simulator.h"
 
+#include <cstdlib>
 #include <memory>
+#include <random>
 #include <string>
 #include <utility>
 
@@ -52,6 +54,17 @@ constexpr const char* defaultRenderingGroupName = "";
 const int shadowMapSize = 1024;
 const int maxNumShadowMaps = 3;  // the max number of point shadow maps
 
+//! Hash of a mesh component of @ref Simulator::getJoinedMesh
+std::size_t hashMeshComponent(const std::string& meshHandle,
+                              const mat4f& transform) {
+  std::size_t seed = std::hash<std::string>{}(meshHandle);
+  for (int i = 0; i < transform.size(); ++i) {
+    seed ^= std::hash<float>{}(transform.data()[i]) + 0x9e3779b9 +
+            (seed << 6) + (seed >> 2);
+  }
+  return seed;
+}
+
 };  // namespace
 
 Simulator::Simulator(const SimulatorConfiguration& cfg,
@@ -74,6 +87,8 @@ void Simulator::close(const bool destroy) {
   getRenderGLContext();
 
   pathfinder_ = nullptr;
+  navMeshStaticObjects_ = {};
+  joinedMeshCache_ = {};
   navMeshVisPrimID_ = esp::ID_UNDEFINED;
   navMeshVisNode_ = nullptr;
   agents_.clear();
@@ -236,6 +251,8 @@ bool Simulator::createSceneInstance(const std::string& activeSceneName) {
   // Get name of navmesh and use to create pathfinder and load navmesh
   // create pathfinder and load navmesh if available
   pathfinder_ = nav::PathFinder::create();
+  navMeshStaticObjects_ = {};
+  joinedMeshCache_ = {};
   if (Cr::Utility::Path::exists(navmeshFileLoc)) {
     ESP_DEBUG() << "Loading navmesh from" << navmeshFileLoc;
     bool pfSuccess = pathfinder_->loadNavMesh(navmeshFileLoc);
@@ -620,6 +637,9 @@ Simulator::buildCurrentStateSceneAttributes() const {
 void Simulator::seed(uint32_t newSeed) {
   random_->seed(newSeed);
   pathfinder_->seed(newSeed);
+  // core::randomRotation and random managed object handles still draw from
+  // the global generator, which the pathfinder no longer seeds
+  srand(newSeed);
 }
 
 const metadata::managers::AssetAttributesManager::ptr&
@@ -894,11 +914,36 @@ double Simulator::getPhysicsTimeStep() {
 bool Simulator::recomputeNavMesh(nav::PathFinder& pathfinder,
                                  const nav::NavMeshSettings& navMeshSettings,
                                  const bool includeStaticObjects) {
-  assets::MeshData::ptr joinedMesh = getJoinedMesh(includeStaticObjects);
+  std::unordered_map<int, Mn::Range3D> staticObjectBounds;
+  assets::MeshData::ptr joinedMesh =
+      getJoinedMesh(includeStaticObjects, &staticObjectBounds);
+
+  std::string cachedNavMesh;
+  if (!config_.navMeshCacheDir.empty()) {
+    cachedNavMesh = Cr::Utility::Path::join(
+        config_.navMeshCacheDir,
+        nav::navMeshCacheKey(navMeshSettings, *joinedMesh) + ".navmesh");
+  }
 
-  if (!pathfinder.build(navMeshSettings, *joinedMesh)) {
-    ESP_ERROR() << "Failed to build navmesh";
-    return false;
+  navMeshStaticObjects_ = {};
+  // The settings are compared as well in case of a hash collision
+  if (!cachedNavMesh.empty() && Cr::Utility::Path::exists(cachedNavMesh) &&
+      pathfinder.loadNavMesh(cachedNavMesh) &&
+      pathfinder.getNavMeshSettings() &&
+      *pathfinder.getNavMeshSettings() == navMeshSettings) {
+    ESP_DEBUG() << "Loaded cached navmesh from" << cachedNavMesh;
+  } else {
+    if (!pathfinder.build(navMeshSettings, *joinedMesh)) {
+      ESP_ERROR() << "Failed to build navmesh";
+      return false;
+    }
+    if (!cachedNavMesh.empty()) {
+      saveCachedNavMesh(pathfinder, cachedNavMesh);
+    }
+  }
+  if (includeStaticObjects) {
+    navMeshStaticObjects_.pathfinder = &pathfinder;
+    navMeshStaticObjects_.bounds = std::move(staticObjectBounds);
   }
 
   if (&pathfinder == pathfinder_.get()) {
@@ -909,13 +954,96 @@ bool Simulator::recomputeNavMesh(nav::PathFinder& pathfinder,
   return true;
 }
 
+void Simulator::saveCachedNavMesh(nav::PathFinder& pathfinder,
+                                  const std::string& cachedNavMesh) {
+  if (!Cr::Utility::Path::make(config_.navMeshCacheDir)) {
+    ESP_WARNING() << "Couldn't create navmesh cache directory"
+                  << config_.navMeshCacheDir;
+    return;
+  }
+  // Saved under a unique name and then renamed, so other processes sharing the
+  // cache never load a partially written file
+  const std::string tmpNavMesh = Cr::Utility::formatString(
+      "{}.{:x}.tmp", cachedNavMesh, std::random_device{}());
+  if (!pathfinder.saveNavMesh(tmpNavMesh) ||
+      !Cr::Utility::Path::move(tmpNavMesh, cachedNavMesh)) {
+    ESP_WARNING() << "Couldn't save navmesh to the cache at" << cachedNavMesh;
+    Cr::Utility::Path::remove(tmpNavMesh);
+    return;
+  }
+  ESP_DEBUG() << "Saved navmesh to the cache at" << cachedNavMesh;
+}
+
+bool Simulator::updateNavMesh(nav::PathFinder& pathfinder,
+                              const nav::NavMeshSettings& navMeshSettings) {
+  if (navMeshStaticObjects_.pathfinder != &pathfinder ||
+      navMeshSettings.tileSize <= 0 || !pathfinder.getNavMeshSettings() ||
+      *pathfinder.getNavMeshSettings() != navMeshSettings) {
+    return recomputeNavMesh(pathfinder, navMeshSettings, true);
+  }
+
+  std::unordered_map<int, Mn::Range3D> staticObjectBounds;
+  assets::MeshData::ptr joinedMesh = getJoinedMesh(true, &staticObjectBounds);
+
+  // Both where changed objects were and where they are now
+  std::vector<std::pair<vec3f, vec3f>> changedRegions;
+  auto addRegion = [&changedRegions](const Mn::Range3D& bounds) {
+    changedRegions.emplace_back(
+        Mn::EigenIntegration::cast<vec3f>(bounds.min()),
+        Mn::EigenIntegration::cast<vec3f>(bounds.max()));
+  };
+  for (const auto& objectBounds : staticObjectBounds) {
+    auto prevBounds = navMeshStaticObjects_.bounds.find(objectBounds.first);
+    if (prevBounds == navMeshStaticObjects_.bounds.end()) {
+      addRegion(objectBounds.second);
+    } else if (prevBounds->second != objectBounds.second) {
+      addRegion(prevBounds->second);
+      addRegion(objectBounds.second);
+    }
+  }
+  for (const auto& prevBounds : navMeshStaticObjects_.bounds) {
+    if (staticObjectBounds.count(prevBounds.first) == 0) {
+      addRegion(prevBounds.second);
+    }
+  }
+  if (changedRegions.empty()) {
+    return true;
+  }
+
+  if (!pathfinder.rebuildRegions(*joinedMesh, changedRegions)) {
+    ESP_WARNING() << "Failed to update navmesh in place, recomputing it";
+    return recomputeNavMesh(pathfinder, navMeshSettings, true);
+  }
+  navMeshStaticObjects_.bounds = std::move(staticObjectBounds);
+
+  if (&pathfinder == pathfinder_.get()) {
+    resetNavMeshVisIfActive();
+  }
+
+  ESP_DEBUG() << "update navmesh successful";
+  return true;
+}
+
 assets::MeshData::ptr Simulator::getJoinedMesh(
     const bool includeStaticObjects) {
+  return getJoinedMesh(includeStaticObjects, nullptr);
+}
+
+assets::MeshData::ptr Simulator::getJoinedMesh(
+    const bool includeStaticObjects,
+    std::unordered_map<int, Mn::Range3D>* staticObjectBounds) {
   assets::MeshData::ptr joinedMesh = assets::MeshData::create();
   auto stageInitAttrs = physicsManager_->getStageInitAttributes();
   if (stageInitAttrs != nullptr) {
-    joinedMesh = resourceManager_->createJoinedCollisionMesh(
-        stageInitAttrs->getRenderAssetHandle());
+    const std::string& stageHandle = stageInitAttrs->getRenderAssetHandle();
+    if (!joinedMeshCache_.stageMesh ||
+        joinedMeshCache_.stageHandle != stageHandle) {
+      joinedMeshCache_.stageHandle = stageHandle;
+      joinedMeshCache_.stageMesh =
+          resourceManager_->createJoinedCollisionMesh(stageHandle);
+    }
+    // copied, as objects get appended and callers may modify the result
+    joinedMesh = assets::MeshData::create(*joinedMeshCache_.stageMesh);
   }
 
   // add STATIC collision objects
@@ -930,13 +1058,15 @@ assets::MeshData::ptr Simulator::getJoinedMesh(
     // collect mesh components from all objects and then merge them.
     // Each mesh component could be duplicated multiple times w/ different
     // transforms.
+    // Each transform is paired with the id of the object it belongs to.
     std::map<std::string,
-             std::vector<Eigen::Transform<float, 3, Eigen::Affine>>>
+             std::vector<std::pair<
+                 int, Eigen::Transform<float, 3, Eigen::Affine>>>>
         meshComponentStates;
     auto rigidObjMgr = getRigidObjectManager();
     // collect RigidObject mesh components
     for (auto objectID : physicsManager_->getExistingObjectIDs()) {
-      auto objWrapper = rigidObjMgr->getObjectCopyByID(objectID);
+      auto objWrapper = rigidObjMgr->getObjectByID(objectID);
       if (objWrapper->getMotionType() == physics::MotionType::STATIC) {
         auto objectTransform = Magnum::EigenIntegration::cast<
             Eigen::Transform<float, 3, Eigen::Affine>>(
@@ -951,7 +1081,8 @@ assets::MeshData::ptr Simulator::getJoinedMesh(
         if (meshHandle.empty()) {
           meshHandle = initializationTemplate->getRenderAssetHandle();
         }
-        meshComponentStates[meshHandle].push_back(objectTransform);
+        meshComponentStates[meshHandle].emplace_back(objectID,
+                                                     objectTransform);
       }
     }
 
@@ -973,17 +1104,61 @@ assets::MeshData::ptr Simulator::getJoinedMesh(
                 Eigen::Transform<float, 3, Eigen::Affine>>(
                 visualAttachment.first->absoluteTransformationMatrix());
             std::string meshHandle = visualAttachment.second;
-            meshComponentStates[meshHandle].push_back(objectTransform);
+            meshComponentStates[meshHandle].emplace_back(objectID,
+                                                         objectTransform);
           }
         }
       }
     }
 
-    // merge mesh components into the final mesh
+    // merge mesh components into the final mesh, reusing the components of
+    // the previous call which didn't move
+    std::unordered_map<std::size_t, JoinedMeshCache::TransformedMesh>
+        transformedMeshes;
     for (auto& meshComponent : meshComponentStates) {
-      assets::MeshData::uptr joinedObjectMesh =
-          resourceManager_->createJoinedCollisionMesh(meshComponent.first);
-      for (auto& meshTransform : meshComponent.second) {
+      const std::string& meshHandle = meshComponent.first;
+      assets::MeshData::ptr& joinedObjectMesh =
+          joinedMeshCache_.assetMeshes[meshHandle];
+      if (!joinedObjectMesh) {
+        joinedObjectMesh =
+            resourceManager_->createJoinedCollisionMesh(meshHandle);
+      }
+      for (auto& meshState : meshComponent.second) {
+        const auto& meshTransform = meshState.second;
+        const mat4f& transform = meshTransform.matrix();
+        const std::size_t key = hashMeshComponent(meshHandle, transform);
+
+        const JoinedMeshCache::TransformedMesh* transformed = nullptr;
+        auto current = transformedMeshes.find(key);
+        if (current != transformedMeshes.end() &&
+            current->second.matches(meshHandle, transform)) {
+          transformed = &current->second;
+        } else {
+          JoinedMeshCache::TransformedMesh component;
+          auto cached = joinedMeshCache_.transformedMeshes.find(key);
+          if (cached != joinedMeshCache_.transformedMeshes.end() &&
+              cached->second.matches(meshHandle, transform)) {
+            component = std::move(cached->second);
+          } else {
+            component.meshHandle = meshHandle;
+            component.transform = transform;
+            component.vbo.reserve(joinedObjectMesh->vbo.size());
+            for (auto& vert : joinedObjectMesh->vbo) {
+              component.vbo.push_back(meshTransform * vert);
+            }
+            if (!component.vbo.empty()) {
+              component.bounds = {Mn::Vector3{component.vbo[0]},
+                                  Mn::Vector3{component.vbo[0]}};
+              for (const vec3f& vert : component.vbo) {
+                component.bounds = {
+                    Mn::Math::min(component.bounds.min(), Mn::Vector3{vert}),
+                    Mn::Math::max(component.bounds.max(), Mn::Vector3{vert})};
+              }
+            }
+          }
+          transformed = &(transformedMeshes[key] = std::move(component));
+        }
+
         int prevNumIndices = joinedMesh->ibo.size();
         int prevNumVerts = joinedMesh->vbo.size();
         joinedMesh->ibo.resize(prevNumIndices + joinedObjectMesh->ibo.size());
@@ -991,12 +1166,21 @@ assets::MeshData::ptr Simulator::getJoinedMesh(
           joinedMesh->ibo[ix + prevNumIndices] =
               joinedObjectMesh->ibo[ix] + prevNumVerts;
         }
-        joinedMesh->vbo.reserve(joinedObjectMesh->vbo.size() + prevNumVerts);
-        for (auto& vert : joinedObjectMesh->vbo) {
-          joinedMesh->vbo.push_back(meshTransform * vert);
+        joinedMesh->vbo.insert(joinedMesh->vbo.end(), transformed->vbo.begin(),
+                               transformed->vbo.end());
+
+        if (staticObjectBounds && !transformed->vbo.empty()) {
+          auto objectBounds = staticObjectBounds->find(meshState.first);
+          if (objectBounds == staticObjectBounds->end()) {
+            staticObjectBounds->emplace(meshState.first, transformed->bounds);
+          } else {
+            objectBounds->second =
+                Mn::Math::join(objectBounds->second, transformed->bounds);
+          }
         }
       }
     }
+    joinedMeshCache_.transformedMeshes = std::move(transformedMeshes);
   }
   ESP_CHECK(joinedMesh->vbo.size() > 0,
             "::recomputeNavMesh: "
@@ -1219,6 +1403,7 @@ esp::sensor::Sensor& Simulator::addSensorToObject(
 
 void Simulator::setPathFinder(nav::PathFinder::ptr pathfinder) {
   pathfinder_ = std::move(pathfinder);
+  navMeshStaticObjects_ = {};
 }
 gfx::RenderTarget* Simulator::getRenderTarget(int agentId,
                                               const std::string& sensorId) {
@@ -6,7 +6,9 @@
 #define ESP_SIM_SIMULATOR_H_
 
 #include <Corrade/Utility/Assert.h>
+#include <Magnum/Math/Range.h>
 
+#include <unordered_map>
 #include <utility>
 #include "esp/agent/Agent.h"
 #include "esp/assets/ResourceManager.h"
@@ -421,6 +423,24 @@ class Simulator {
     return physicsManager_->getContactPoints();
   }
 
+  /**
+   * @brief Write contact point data from the most recent collision detection
+   * cache into a caller-provided buffer. See @ref
+   * esp::physics::PhysicsManager::getContactPoints.
+   *
+   * @param contactPoints Filled with the first matching contact points.
+   * @param objectIds If not empty, only contacts involving one of these object
+   * ids are reported.
+   * @return The number of matching contact points, which may exceed the size
+   * of contactPoints.
+   */
+  std::size_t getPhysicsContactPoints(
+      Corrade::Containers::ArrayView<esp::physics::ContactPointData>
+          contactPoints,
+      Corrade::Containers::ArrayView<const int> objectIds = nullptr) {
+    return physicsManager_->getContactPoints(contactPoints, objectIds);
+  }
+
   /**
    * @brief Query the number of contact points that were active during the
    * collision detection check.
@@ -512,6 +532,36 @@ class Simulator {
     return esp::physics::RaycastResults();
   }
 
+  /**
+   * @brief Cast a batch of rays into the collision world of a scene, see
+   * @ref physics::PhysicsManager::castRays.
+   *
+   * Note: A default @ref physics::PhysicsManager has no collision world, so
+   * physics must be enabled for this feature.
+   *
+   * @param rays The rays to cast.
+   * @param hits Filled with a fixed number of hit slots per ray.
+   * @param maxDistance The maximum distance along the ray direction to search.
+   * In units of ray length.
+   * @param collisionFilterMask Bitmask of @ref physics::CollisionGroup values
+   * of the objects rays may hit.
+   * @param numThreads The number of worker threads. Values <= 0 use the
+   * OpenMP default.
+   * @param sceneID !! Not used currently !! Specifies which physical scene of
+   * the object.
+   */
+  void castRays(Corrade::Containers::ArrayView<const esp::geo::Ray> rays,
+                Corrade::Containers::ArrayView<esp::physics::RayHitInfo> hits,
+                double maxDistance = 100.0,
+                int collisionFilterMask = -1,
+                int numThreads = 0,
+                int sceneID = 0) {
+    if (sceneHasPhysics(sceneID)) {
+      physicsManager_->castRays(rays, hits, maxDistance, collisionFilterMask,
+                                numThreads);
+    }
+  }
+
   /**
    * @brief the physical world has a notion of time which passes during
    * animation/simulation/action/etc... Step the physical world forward in time
@@ -587,12 +637,33 @@ class Simulator {
    * will be assigned.
    * @param navMeshSettings The @ref nav::NavMeshSettings instance to
    * parameterize the navmesh construction.
+   *
+   * If @ref SimulatorConfiguration::navMeshCacheDir is set, a navmesh cached
+   * there for the same joined mesh and settings is loaded instead of building
+   * one, and newly built navmeshes are added to the cache.
    * @return Whether or not the navmesh recomputation succeeded.
    */
   bool recomputeNavMesh(nav::PathFinder& pathfinder,
                         const nav::NavMeshSettings& navMeshSettings,
                         bool includeStaticObjects = false);
 
+  /**
+   * @brief Update a navmesh computed with @ref recomputeNavMesh and
+   * includeStaticObjects after MotionType::STATIC objects were added, moved or
+   * removed.
+   *
+   * If the navmesh is tiled (see @ref nav::NavMeshSettings::tileSize), only
+   * the tiles overlapping the old and new bounds of the changed objects are
+   * rebuilt. Otherwise, or if the navmesh wasn't last computed by this
+   * Simulator with static objects, the whole navmesh is recomputed.
+   * @param pathfinder The pathfinder object holding the navmesh to update.
+   * @param navMeshSettings The @ref nav::NavMeshSettings instance the navmesh
+   * was computed with.
+   * @return Whether or not the navmesh update succeeded.
+   */
+  bool updateNavMesh(nav::PathFinder& pathfinder,
+                     const nav::NavMeshSettings& navMeshSettings);
+
   /**
    * @brief Get the joined mesh data for all objects in the scene
    * @param includeStaticObjects flag to include static objects
@@ -891,6 +962,146 @@ class Simulator {
 
   //============= END - Object Rigid Constraint API =============
 
+  /**
+   * @brief Capture the dynamic state of all objects and rigid constraints for
+   * a fast episode reset with @ref restorePhysicsState. See @ref
+   * esp::physics::PhysicsManager::saveState.
+   *
+   * @return The snapshot, or nullptr if no physics scene exists.
+   */
+  physics::PhysicsStateSnapshot::ptr savePhysicsState() const {
+    if (!physicsManager_) {
+      return nullptr;
+    }
+    return physicsManager_->saveState();
+  }
+
+  /**
+   * @brief Restore a snapshot taken with @ref savePhysicsState in place. See
+   * @ref esp::physics::PhysicsManager::restoreState.
+   *
+   * @param snapshot The snapshot to restore.
+   * @return Whether the snapshot matched the current objects and constraints.
+   */
+  bool restorePhysicsState(const physics::PhysicsStateSnapshot& snapshot) {
+    if (!physicsManager_) {
+      return false;
+    }
+    return physicsManager_->restoreState(snapshot);
+  }
+
+  /**
+   * @brief Read the state of a set of rigid objects into caller-provided
+   * structure-of-arrays buffers in one call. See @ref
+   * esp::physics::PhysicsManager::getRigidObjectStates.
+   *
+   * @return Whether all ids refer to existing rigid objects.
+   */
+  bool getRigidObjectStates(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<Magnum::Vector3> translations,
+      Corrade::Containers::ArrayView<Magnum::Quaternion> rotations,
+      Corrade::Containers::ArrayView<Magnum::Vector3> linearVelocities,
+      Corrade::Containers::ArrayView<Magnum::Vector3> angularVelocities,
+      Corrade::Containers::ArrayView<physics::MotionType> motionTypes) const {
+    if (!physicsManager_) {
+      return objectIds.empty();
+    }
+    return physicsManager_->getRigidObjectStates(
+        objectIds, translations, rotations, linearVelocities,
+        angularVelocities, motionTypes);
+  }
+
+  /**
+   * @brief Set the state of a set of rigid objects from structure-of-arrays
+   * buffers in one call. See @ref
+   * esp::physics::PhysicsManager::setRigidObjectStates.
+   *
+   * @return Whether all ids refer to existing rigid objects.
+   */
+  bool setRigidObjectStates(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<const Magnum::Vector3> translations,
+      Corrade::Containers::ArrayView<const Magnum::Quaternion> rotations,
+      Corrade::Containers::ArrayView<const Magnum::Vector3> linearVelocities,
+      Corrade::Containers::ArrayView<const Magnum::Vector3>
+          angularVelocities) {
+    if (!physicsManager_) {
+      return objectIds.empty();
+    }
+    return physicsManager_->setRigidObjectStates(
+        objectIds, translations, rotations, linearVelocities,
+        angularVelocities);
+  }
+
+  /**
+   * @brief Get the ids of all existing articulated objects. See @ref
+   * esp::physics::PhysicsManager::getExistingArticulatedObjectIds.
+   */
+  std::vector<int> getExistingArticulatedObjectIds() const {
+    if (!physicsManager_) {
+      return {};
+    }
+    return physicsManager_->getExistingArticulatedObjectIds();
+  }
+
+  /**
+   * @brief Count the joint values of a set of articulated objects. See @ref
+   * esp::physics::PhysicsManager::countArticulatedJointValues.
+   *
+   * @return Whether all ids refer to existing articulated objects.
+   */
+  bool countArticulatedJointValues(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      std::size_t& numPositions,
+      std::size_t& numDoFs) const {
+    numPositions = 0;
+    numDoFs = 0;
+    if (!physicsManager_) {
+      return objectIds.empty();
+    }
+    return physicsManager_->countArticulatedJointValues(
+        objectIds, numPositions, numDoFs);
+  }
+
+  /**
+   * @brief Read the joint state of a set of articulated objects into
+   * caller-provided buffers in one call. See @ref
+   * esp::physics::PhysicsManager::getArticulatedJointStates.
+   *
+   * @return Whether the ids and buffer sizes were valid.
+   */
+  bool getArticulatedJointStates(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<float> positions,
+      Corrade::Containers::ArrayView<float> velocities,
+      Corrade::Containers::ArrayView<float> forces) const {
+    if (!physicsManager_) {
+      return objectIds.empty();
+    }
+    return physicsManager_->getArticulatedJointStates(objectIds, positions,
+                                                      velocities, forces);
+  }
+
+  /**
+   * @brief Set the joint state of a set of articulated objects from
+   * caller-provided buffers in one call. See @ref
+   * esp::physics::PhysicsManager::setArticulatedJointStates.
+   *
+   * @return Whether the ids and buffer sizes were valid.
+   */
+  bool setArticulatedJointStates(
+      Corrade::Containers::ArrayView<const int> objectIds,
+      Corrade::Containers::ArrayView<const float> positions,
+      Corrade::Containers::ArrayView<const float> velocities,
+      Corrade::Containers::ArrayView<const float> forces) {
+    if (!physicsManager_) {
+      return objectIds.empty();
+    }
+    return physicsManager_->setArticulatedJointStates(objectIds, positions,
+                                                      velocities, forces);
+  }
+
   /**
    * @brief Getter for PRNG.
    *
@@ -973,6 +1184,27 @@ class Simulator {
     }
   }
 
+  /**
+   * @brief Get the joined mesh data for all objects in the scene and the
+   * world space bounds of the STATIC objects in it.
+   * @param includeStaticObjects flag to include static objects
+   * @param[out] staticObjectBounds If not null, filled with the bounds of the
+   * joined mesh of each static object, keyed by object id
+   * @return A shared ptr assets::MeshData with required mesh
+   */
+  assets::MeshData::ptr getJoinedMesh(
+      bool includeStaticObjects,
+      std::unordered_map<int, Magnum::Range3D>* staticObjectBounds);
+
+  /**
+   * @brief Save a navmesh built by @ref recomputeNavMesh to the navmesh cache.
+   * Failures are only logged, as the navmesh itself is fine.
+   * @param pathfinder The pathfinder holding the built navmesh.
+   * @param cachedNavMesh The cache file to save it to.
+   */
+  void saveCachedNavMesh(nav::PathFinder& pathfinder,
+                         const std::string& cachedNavMesh);
+
   /**
    * @brief Builds a scene instance and populates it with initial object
    * layout, if appropriate, based on @ref
@@ -1129,6 +1361,41 @@ class Simulator {
   int navMeshVisPrimID_ = esp::ID_UNDEFINED;
   esp::scene::SceneNode* navMeshVisNode_ = nullptr;
 
+  //! STATIC objects the navmesh of a PathFinder was last computed with, so
+  //! @ref updateNavMesh can find the objects which changed since
+  struct NavMeshStaticObjects {
+    //! Not owned, only compared against
+    const nav::PathFinder* pathfinder = nullptr;
+    std::unordered_map<int, Magnum::Range3D> bounds;
+  } navMeshStaticObjects_;
+
+  //! Meshes reused between @ref getJoinedMesh calls, so repeated navmesh
+  //! recomputation doesn't re-join and re-transform unchanged meshes. Cleared
+  //! with the scene.
+  struct JoinedMeshCache {
+    //! A mesh component transformed into world space
+    struct TransformedMesh {
+      std::string meshHandle;
+      //! Unaligned, as it lives in the nodes of an unordered_map
+      Eigen::Matrix<float, 4, 4, Eigen::DontAlign> transform;
+      std::vector<vec3f> vbo;
+      Magnum::Range3D bounds;
+
+      bool matches(const std::string& handle, const mat4f& xform) const {
+        return meshHandle == handle && transform == xform;
+      }
+    };
+
+    //! Render asset handle of the stage @ref stageMesh was joined from
+    std::string stageHandle;
+    assets::MeshData::ptr stageMesh;
+    //! Joined, untransformed collision mesh of each asset handle
+    std::unordered_map<std::string, assets::MeshData::ptr> assetMeshes;
+    //! Mesh components of the last call, keyed by a hash of their handle and
+    //! transform
+    std::unordered_map<std::size_t, TransformedMesh> transformedMeshes;
+  } joinedMeshCache_;
+
   /**
    * @brief Tracks whether or not the simulator was initialized
    * to load textures.  Because we cache mesh loading, this should
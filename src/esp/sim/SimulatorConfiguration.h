@@ -92,6 +92,16 @@ struct SimulatorConfiguration {
    */
   bool useSemanticTexturesIfFound = true;
 
+  /**
+   * @brief Directory of navmeshes cached by @ref Simulator::recomputeNavMesh.
+   *
+   * If not empty, recomputed navmeshes are saved here, named by the @ref
+   * nav::navMeshCacheKey of their joined mesh and settings, and later
+   * recomputations of the same key load the file instead of building. May be
+   * shared by concurrent processes.
+   */
+  std::string navMeshCacheDir;
+
   ESP_SMART_POINTERS(SimulatorConfiguration)
 };
 bool operator==(const SimulatorConfiguration& a,
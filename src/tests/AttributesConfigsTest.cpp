@@ -258,6 +258,8 @@ void AttributesConfigsTest::testPhysicsAttrVals(
   CORRADE_COMPARE(physMgrAttr->getSimulator(), "bullet_test");
   CORRADE_COMPARE(physMgrAttr->getFrictionCoefficient(), 1.4);
   CORRADE_COMPARE(physMgrAttr->getRestitutionCoefficient(), 1.1);
+  CORRADE_COMPARE(physMgrAttr->getNumThreads(), 4);
+  CORRADE_VERIFY(physMgrAttr->getDeterministic());
   // test physics manager attributes-level user config vals
   testUserDefinedConfigVals(physMgrAttr->getUserConfiguration(),
                             "pm defined string", true, 15, 12.6,
@@ -279,6 +281,8 @@ void AttributesConfigsTest::testPhysicsJSONLoad() {
   "gravity": [1,2,3],
   "friction_coefficient": 1.4,
   "restitution_coefficient": 1.1,
+  "num_threads": 4,
+  "deterministic": true,
   "user_defined" : {
       "user_string" : "pm defined string",
       "user_bool" : true,
@@ -917,6 +921,8 @@ void AttributesConfigsTest::testObjectAttrVals(
                   static_cast<int>(Attrs::ObjectInstanceShaderType::Phong));
   CORRADE_VERIFY(objAttr->getBoundingBoxCollisions());
   CORRADE_VERIFY(objAttr->getJoinCollisionMeshes());
+  CORRADE_VERIFY(objAttr->getSimplifyCollisionHulls());
+  CORRADE_COMPARE(objAttr->getMaxCollisionHullVertices(), 64);
   CORRADE_COMPARE(objAttr->getInertia(), Magnum::Vector3(1.1, 0.9, 0.3));
   CORRADE_COMPARE(objAttr->getCOM(), Magnum::Vector3(0.1, 0.2, 0.3));
   // test object attributes-level user config vals
@@ -950,6 +956,8 @@ void AttributesConfigsTest::testObjectJSONLoad() {
   "mass": 9,
   "use_bounding_box_for_collision": true,
   "join_collision_meshes":true,
+  "simplify_collision_hulls":true,
+  "max_collision_hull_vertices":64,
   "inertia": [1.1, 0.9, 0.3],
   "semantic_id" : 7,
   "COM": [0.1,0.2,0.3],
@@ -6,8 +6,11 @@
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
 
+#include <esp/assets/MeshData.h>
 #include <esp/nav/PathFinder.h>
 
+#include <thread>
+
 #include <Corrade/Utility/Path.h>
 #include <Magnum/EigenIntegration/Integration.h>
 #include <Magnum/Magnum.h>
@@ -37,6 +40,17 @@ struct PathFinderTest : Cr::TestSuite::Tester {
   void bounds();
   void tryStepNoSliding();
   void multiGoalPath();
+  void batchedPaths();
+  void concurrentQueries();
+  void batchedSteps();
+  void navLocations();
+  void clearanceField();
+  void areaWeightedSampling();
+  void tiledBuild();
+  void memoryMappedLoad();
+  void landmarkIndex();
+  void goalDistanceField();
+  void topDownView();
 
   void benchmarkSingleGoal();
   void benchmarkMultiGoal();
@@ -50,7 +64,13 @@ struct PathFinderTest : Cr::TestSuite::Tester {
 
 PathFinderTest::PathFinderTest() {
   addTests({&PathFinderTest::bounds, &PathFinderTest::tryStepNoSliding,
-            &PathFinderTest::multiGoalPath, &PathFinderTest::testCaching,
+            &PathFinderTest::multiGoalPath, &PathFinderTest::batchedPaths,
+            &PathFinderTest::concurrentQueries, &PathFinderTest::batchedSteps,
+            &PathFinderTest::navLocations, &PathFinderTest::clearanceField,
+            &PathFinderTest::areaWeightedSampling, &PathFinderTest::tiledBuild,
+            &PathFinderTest::memoryMappedLoad, &PathFinderTest::landmarkIndex,
+            &PathFinderTest::goalDistanceField, &PathFinderTest::topDownView,
+            &PathFinderTest::testCaching,
             &PathFinderTest::navMeshSettingsTestJSON});
 
   addBenchmarks({&PathFinderTest::benchmarkSingleGoal}, 1000);
@@ -135,6 +155,517 @@ void PathFinderTest::multiGoalPath() {
   }
 }
 
+void PathFinderTest::batchedPaths() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+  pathFinder.seed(0);
+
+  constexpr int numQueries = 500;
+  std::vector<esp::vec3f> starts, ends;
+  starts.reserve(numQueries);
+  ends.reserve(numQueries);
+  for (int i = 0; i < numQueries; ++i) {
+    starts.emplace_back(pathFinder.getRandomNavigablePoint());
+    ends.emplace_back(pathFinder.getRandomNavigablePoint());
+  }
+
+  std::vector<float> distances(numQueries);
+  std::vector<std::vector<esp::vec3f>> points;
+  const int numFound =
+      pathFinder.findPaths(starts, ends, distances, &points, 4);
+
+  // distance-only mode must agree with the full query
+  std::vector<float> distancesOnly(numQueries);
+  CORRADE_COMPARE(pathFinder.findPaths(starts, ends, distancesOnly), numFound);
+
+  int numFoundSerial = 0;
+  for (int i = 0; i < numQueries; ++i) {
+    CORRADE_ITERATION(i);
+    esp::nav::ShortestPath path;
+    path.requestedStart = starts[i];
+    path.requestedEnd = ends[i];
+    if (pathFinder.findPath(path)) {
+      ++numFoundSerial;
+    }
+
+    CORRADE_COMPARE(distances[i], path.geodesicDistance);
+    CORRADE_COMPARE(distancesOnly[i], path.geodesicDistance);
+    CORRADE_COMPARE(points[i].size(), path.points.size());
+  }
+  CORRADE_COMPARE(numFound, numFoundSerial);
+}
+
+void PathFinderTest::concurrentQueries() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+
+  // Island restricted sampling from several threads at once must never see
+  // another thread's island restriction
+  constexpr int numThreads = 4;
+  constexpr int numSamples = 200;
+  std::vector<int> numWrongIsland(numThreads, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; ++t) {
+    threads.emplace_back([&pathFinder, &numWrongIsland, t]() {
+      esp::core::Random rng(t);
+      const int islandIndex =
+          pathFinder.getIsland(pathFinder.getRandomNavigablePoint(rng));
+      for (int i = 0; i < numSamples; ++i) {
+        const esp::vec3f pt =
+            pathFinder.getRandomNavigablePoint(rng, 10, islandIndex);
+        // a point on the island doesn't move when snapped to the island
+        const esp::vec3f snapped = pathFinder.snapPoint(pt, islandIndex);
+        if (std::isnan(pt[0]) || !((snapped - pt).norm() < 1e-3)) {
+          ++numWrongIsland[t];
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (int t = 0; t < numThreads; ++t) {
+    CORRADE_ITERATION(t);
+    CORRADE_COMPARE(numWrongIsland[t], 0);
+  }
+
+  // The same seed must produce the same points regardless of other callers
+  esp::core::Random rngA(7), rngB(7);
+  for (int i = 0; i < 10; ++i) {
+    CORRADE_COMPARE(Mn::Vector3{pathFinder.getRandomNavigablePoint(rngA)},
+                    Mn::Vector3{pathFinder.getRandomNavigablePoint(rngB)});
+  }
+}
+
+void PathFinderTest::batchedSteps() {
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+
+  esp::core::Random rng(0);
+  const int numAgents = 64;
+  std::vector<esp::vec3f> starts, ends;
+  for (int i = 0; i < numAgents; ++i) {
+    starts.push_back(pathFinder.getRandomNavigablePoint(rng));
+    ends.push_back(starts.back() +
+                   esp::vec3f{rng.uniform_float(-0.5f, 0.5f), 0.0f,
+                              rng.uniform_float(-0.5f, 0.5f)});
+  }
+
+  // the same as stepping every agent on its own
+  std::vector<esp::vec3f> results(numAgents);
+  std::vector<std::uint64_t> polyRefs(numAgents, 0);
+  pathFinder.trySteps(starts, ends, results, polyRefs);
+  for (int i = 0; i < numAgents; ++i) {
+    CORRADE_ITERATION(i);
+    const esp::vec3f expected = pathFinder.tryStep(starts[i], ends[i]);
+    CORRADE_COMPARE(Mn::Vector3{results[i]}, Mn::Vector3{expected});
+    CORRADE_VERIFY(polyRefs[i] != 0);
+  }
+
+  // the next step starting from the cached polygons ends up in the same
+  // places as one projecting the start points again
+  std::vector<esp::vec3f> nextEnds;
+  for (int i = 0; i < numAgents; ++i) {
+    nextEnds.push_back(results[i] + (ends[i] - starts[i]));
+  }
+  std::vector<esp::vec3f> cachedResults(numAgents), projectedResults(numAgents);
+  pathFinder.trySteps(results, nextEnds, cachedResults, polyRefs);
+  pathFinder.trySteps(results, nextEnds, projectedResults, {}, true, 1);
+  for (int i = 0; i < numAgents; ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(Mn::Vector3{cachedResults[i]},
+                    Mn::Vector3{projectedResults[i]});
+  }
+
+  std::vector<esp::vec3f> noSlidingResults(numAgents);
+  pathFinder.trySteps(starts, ends, noSlidingResults, {}, false);
+  for (int i = 0; i < numAgents; ++i) {
+    CORRADE_ITERATION(i);
+    const esp::vec3f expected = pathFinder.tryStepNoSliding(starts[i], ends[i]);
+    CORRADE_COMPARE(Mn::Vector3{noSlidingResults[i]}, Mn::Vector3{expected});
+  }
+
+  // polygons cached before loading another navmesh may name unrelated
+  // polygons of the new one, so they are checked and projected again
+  CORRADE_VERIFY(pathFinder.loadNavMesh(Cr::Utility::Path::join(
+      SCENE_DATASETS, "habitat-test-scenes/van-gogh-room.navmesh")));
+  std::vector<esp::vec3f> newStarts, newEnds;
+  for (int i = 0; i < numAgents; ++i) {
+    newStarts.push_back(pathFinder.getRandomNavigablePoint(rng));
+    newEnds.push_back(newStarts.back() + (ends[i] - starts[i]));
+  }
+  pathFinder.trySteps(newStarts, newEnds, cachedResults, polyRefs);
+  pathFinder.trySteps(newStarts, newEnds, projectedResults, {}, true, 1);
+  for (int i = 0; i < numAgents; ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(Mn::Vector3{cachedResults[i]},
+                    Mn::Vector3{projectedResults[i]});
+    CORRADE_COMPARE(Mn::Vector3{cachedResults[i]},
+                    Mn::Vector3{pathFinder.tryStep(newStarts[i], newEnds[i])});
+    CORRADE_VERIFY(polyRefs[i] != 0);
+  }
+}
+
+void PathFinderTest::navLocations() {
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+
+  esp::core::Random rng(0);
+  const esp::vec3f start = pathFinder.getRandomNavigablePoint(rng);
+  esp::nav::NavLocation location = pathFinder.locate(start);
+  CORRADE_VERIFY(location.polyRef != 0);
+  CORRADE_COMPARE(Mn::Vector3{location.position},
+                  Mn::Vector3{pathFinder.snapPoint(start)});
+  CORRADE_COMPARE(pathFinder.getIsland(location), pathFinder.getIsland(start));
+  CORRADE_COMPARE(pathFinder.distanceToClosestObstacle(location),
+                  pathFinder.distanceToClosestObstacle(start));
+
+  // walking with locations ends up where walking with points does
+  esp::vec3f point = location.position;
+  const esp::vec3f stepDir{0.1f, 0.0f, 0.05f};
+  for (int i = 0; i < 50; ++i) {
+    CORRADE_ITERATION(i);
+    location = pathFinder.tryStep(location, location.position + stepDir);
+    point = pathFinder.tryStep(point, esp::vec3f{point + stepDir});
+    // up to the nudges off infinitely thin walls
+    CORRADE_COMPARE_AS((location.position - point).norm(), 1e-3f,
+                       Cr::TestSuite::Compare::LessOrEqual);
+    CORRADE_VERIFY(location.polyRef != 0);
+  }
+
+  // locating a nearby point with the previous location as a hint
+  const esp::nav::NavLocation nearby =
+      pathFinder.locate(location.position + esp::vec3f{0.01f, 0.0f, 0.0f},
+                        location);
+  CORRADE_COMPARE(
+      Mn::Vector3{nearby.position},
+      Mn::Vector3{pathFinder.snapPoint(esp::vec3f{
+          location.position + esp::vec3f{0.01f, 0.0f, 0.0f}})});
+
+  esp::nav::ShortestPath path;
+  path.requestedStart = start;
+  path.requestedEnd = location.position;
+  CORRADE_VERIFY(pathFinder.findPath(path));
+  esp::nav::ShortestPath locationPath;
+  CORRADE_VERIFY(
+      pathFinder.findPath(pathFinder.locate(start), location, locationPath));
+  CORRADE_COMPARE(locationPath.geodesicDistance, path.geodesicDistance);
+
+  // locations of a replaced navmesh are projected again
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+  CORRADE_COMPARE(pathFinder.getIsland(location),
+                  pathFinder.getIsland(location.position));
+  const esp::nav::NavLocation relocated =
+      pathFinder.locate(location.position, location);
+  CORRADE_VERIFY(relocated.generation != location.generation);
+  CORRADE_VERIFY(relocated.polyRef != 0);
+}
+
+void PathFinderTest::clearanceField() {
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+
+  esp::core::Random rng(0);
+  std::vector<esp::vec3f> points;
+  std::vector<float> expected;
+  for (int i = 0; i < 200; ++i) {
+    points.push_back(pathFinder.getRandomNavigablePoint(rng));
+    expected.push_back(pathFinder.distanceToClosestObstacle(points.back()));
+  }
+
+  const float tolerance = 0.05f;
+  CORRADE_VERIFY(!pathFinder.hasClearanceField());
+  CORRADE_VERIFY(pathFinder.buildClearanceField(tolerance, 2.0f));
+  CORRADE_VERIFY(pathFinder.hasClearanceField());
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE_AS(
+        std::abs(pathFinder.distanceToClosestObstacle(points[i]) - expected[i]),
+        tolerance + 1e-4f, Cr::TestSuite::Compare::LessOrEqual);
+    // smaller search radii clamp like the search does
+    CORRADE_COMPARE_AS(pathFinder.distanceToClosestObstacle(points[i], 0.1f),
+                       0.1f, Cr::TestSuite::Compare::LessOrEqual);
+  }
+
+  // a new navmesh discards the field
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+  CORRADE_VERIFY(!pathFinder.hasClearanceField());
+}
+
+void PathFinderTest::areaWeightedSampling() {
+  esp::nav::PathFinder pathFinder;
+  pathFinder.loadNavMesh(skokloster);
+  CORRADE_VERIFY(pathFinder.isLoaded());
+
+  // Every sample lies on the navmesh and the fraction of samples landing on
+  // each island follows the island's share of the navigable area
+  constexpr int numSamples = 20000;
+  esp::core::Random rng(0);
+  const std::vector<esp::vec3f> points =
+      pathFinder.getRandomNavigablePoints(rng, numSamples);
+  CORRADE_COMPARE(points.size(), std::size_t{numSamples});
+  std::vector<int> islandCounts(pathFinder.numIslands(), 0);
+  for (const esp::vec3f& pt : points) {
+    CORRADE_VERIFY(pathFinder.isNavigable(pt));
+    const int islandIndex = pathFinder.getIsland(pt);
+    CORRADE_VERIFY(islandIndex != esp::ID_UNDEFINED);
+    ++islandCounts[islandIndex];
+  }
+  const float totalArea = pathFinder.getNavigableArea();
+  for (int i = 0; i < pathFinder.numIslands(); ++i) {
+    CORRADE_ITERATION(i);
+    const float expected = pathFinder.getNavigableArea(i) / totalArea;
+    CORRADE_COMPARE_WITH(float(islandCounts[i]) / numSamples, expected,
+                         Cr::TestSuite::Compare::around(0.02f));
+  }
+
+  // Island restricted batches stay on their island and are reproducible
+  const int islandIndex = pathFinder.getIsland(points[0]);
+  esp::core::Random rngA(3), rngB(3);
+  const std::vector<esp::vec3f> islandPoints =
+      pathFinder.getRandomNavigablePoints(rngA, 100, islandIndex);
+  for (const esp::vec3f& pt : islandPoints) {
+    CORRADE_COMPARE(pathFinder.getIsland(pt), islandIndex);
+  }
+  for (const esp::vec3f& pt : islandPoints) {
+    CORRADE_COMPARE(
+        Mn::Vector3{pt},
+        Mn::Vector3{pathFinder.getRandomNavigablePoint(rngB, 10, islandIndex)});
+  }
+}
+
+void PathFinderTest::tiledBuild() {
+  esp::nav::PathFinder source;
+  source.loadNavMesh(skokloster);
+  CORRADE_VERIFY(source.isLoaded());
+  // rebuild from the surface of an existing navmesh
+  esp::assets::MeshData::ptr mesh = source.getNavMeshData();
+  CORRADE_VERIFY(mesh);
+
+  esp::nav::NavMeshSettings settings;
+  esp::nav::PathFinder singleTile;
+  CORRADE_VERIFY(singleTile.build(settings, *mesh));
+
+  settings.tileSize = 64;
+  esp::nav::PathFinder tiled;
+  CORRADE_VERIFY(tiled.build(settings, *mesh));
+  CORRADE_VERIFY(tiled.getNavMeshSettings());
+  CORRADE_COMPARE(tiled.getNavMeshSettings()->tileSize, 64);
+
+  // tile borders only perturb the navmesh slightly
+  CORRADE_COMPARE_WITH(tiled.getNavigableArea(),
+                       singleTile.getNavigableArea(),
+                       Cr::TestSuite::Compare::around(
+                           0.02f * singleTile.getNavigableArea()));
+
+  // paths cross tile borders
+  esp::core::Random rng(0);
+  int numFound = 0;
+  for (int i = 0; i < 100; ++i) {
+    esp::nav::ShortestPath path;
+    path.requestedStart = singleTile.getRandomNavigablePoint(rng);
+    path.requestedEnd = singleTile.getRandomNavigablePoint(rng);
+    if (!singleTile.findPath(path)) {
+      continue;
+    }
+    ++numFound;
+    esp::nav::ShortestPath tiledPath;
+    tiledPath.requestedStart = tiled.snapPoint(path.requestedStart);
+    tiledPath.requestedEnd = tiled.snapPoint(path.requestedEnd);
+    CORRADE_VERIFY(tiled.findPath(tiledPath));
+  }
+  CORRADE_VERIFY(numFound > 0);
+
+  // all tiles and the tile size survive a save and load
+  const std::string tiledFile =
+      Cr::Utility::Path::join(TEST_ASSETS, "tiled_test.navmesh");
+  CORRADE_VERIFY(tiled.saveNavMesh(tiledFile));
+  esp::nav::PathFinder loaded;
+  CORRADE_VERIFY(loaded.loadNavMesh(tiledFile));
+  CORRADE_VERIFY(*loaded.getNavMeshSettings() == settings);
+  CORRADE_COMPARE(loaded.getNavigableArea(), tiled.getNavigableArea());
+  CORRADE_COMPARE(loaded.numIslands(), tiled.numIslands());
+  Cr::Utility::Path::remove(tiledFile);
+}
+
+void PathFinderTest::memoryMappedLoad() {
+  esp::nav::PathFinder read;
+  CORRADE_VERIFY(read.loadNavMesh(skokloster));
+  esp::nav::PathFinder mapped;
+  CORRADE_VERIFY(mapped.loadNavMesh(skokloster, true));
+  CORRADE_VERIFY(mapped.isLoaded());
+
+  CORRADE_VERIFY(*mapped.getNavMeshSettings() == *read.getNavMeshSettings());
+  CORRADE_COMPARE(mapped.numIslands(), read.numIslands());
+  CORRADE_COMPARE(mapped.getNavigableArea(), read.getNavigableArea());
+  CORRADE_COMPARE(Mn::Vector3{mapped.bounds().first},
+                  Mn::Vector3{read.bounds().first});
+  CORRADE_COMPARE(Mn::Vector3{mapped.bounds().second},
+                  Mn::Vector3{read.bounds().second});
+
+  esp::core::Random rng(0);
+  for (int i = 0; i < 100; ++i) {
+    esp::nav::ShortestPath readPath;
+    readPath.requestedStart = read.getRandomNavigablePoint(rng);
+    readPath.requestedEnd = read.getRandomNavigablePoint(rng);
+    esp::nav::ShortestPath mappedPath = readPath;
+    CORRADE_COMPARE(mapped.findPath(mappedPath), read.findPath(readPath));
+    CORRADE_COMPARE(mappedPath.geodesicDistance, readPath.geodesicDistance);
+  }
+
+  // loading over a mapped navmesh releases it
+  CORRADE_VERIFY(mapped.loadNavMesh(skokloster, true));
+  CORRADE_VERIFY(mapped.loadNavMesh(skokloster));
+  CORRADE_COMPARE(mapped.getNavigableArea(), read.getNavigableArea());
+
+  CORRADE_VERIFY(!mapped.loadNavMesh("nonexistent.navmesh", true));
+}
+
+void PathFinderTest::landmarkIndex() {
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+  CORRADE_VERIFY(!pathFinder.hasLandmarkIndex());
+  CORRADE_VERIFY(pathFinder.buildLandmarkIndex(8));
+  CORRADE_VERIFY(pathFinder.hasLandmarkIndex());
+
+  esp::core::Random rng(0);
+  std::vector<esp::vec3f> starts, ends;
+  for (int i = 0; i < 100; ++i) {
+    CORRADE_ITERATION(i);
+    esp::nav::ShortestPath path;
+    path.requestedStart = pathFinder.getRandomNavigablePoint(rng);
+    path.requestedEnd = pathFinder.getRandomNavigablePoint(rng);
+    starts.push_back(path.requestedStart);
+    ends.push_back(path.requestedEnd);
+    const float estimate = pathFinder.estimateGeodesicDistance(
+        path.requestedStart, path.requestedEnd);
+    if (!pathFinder.findPath(path)) {
+      CORRADE_COMPARE(estimate, Mn::Constants::inf());
+      continue;
+    }
+    // the landmark distances are measured between polygon centers, so only
+    // approximately bounded by the straightened path
+    CORRADE_VERIFY(estimate >=
+                   (path.requestedEnd - path.requestedStart).norm() - 1e-3f);
+    CORRADE_VERIFY(estimate <= 1.5f * path.geodesicDistance + 1.0f);
+  }
+
+  // goals explored in landmark order still give the exact closest goal
+  esp::nav::PathFinder plain;
+  CORRADE_VERIFY(plain.loadNavMesh(skokloster));
+  for (int i = 0; i < 10; ++i) {
+    CORRADE_ITERATION(i);
+    esp::nav::MultiGoalShortestPath path;
+    path.requestedStart = starts[i];
+    path.setRequestedEnds(ends);
+    esp::nav::MultiGoalShortestPath plainPath;
+    plainPath.requestedStart = starts[i];
+    plainPath.setRequestedEnds(ends);
+    CORRADE_COMPARE(pathFinder.findPath(path), plain.findPath(plainPath));
+    CORRADE_COMPARE(path.geodesicDistance, plainPath.geodesicDistance);
+  }
+
+  // the index survives a save and load next to the navmesh
+  const std::string landmarkFile =
+      Cr::Utility::Path::join(TEST_ASSETS, "skokloster_test.landmarks");
+  CORRADE_VERIFY(pathFinder.saveLandmarkIndex(landmarkFile));
+  CORRADE_VERIFY(plain.loadLandmarkIndex(landmarkFile));
+  for (int i = 0; i < 100; ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(plain.estimateGeodesicDistance(starts[i], ends[i]),
+                    pathFinder.estimateGeodesicDistance(starts[i], ends[i]));
+  }
+
+  // but is rejected for any other navmesh
+  esp::nav::PathFinder other;
+  CORRADE_VERIFY(other.loadNavMesh(Cr::Utility::Path::join(
+      SCENE_DATASETS, "habitat-test-scenes/van-gogh-room.navmesh")));
+  CORRADE_VERIFY(!other.loadLandmarkIndex(landmarkFile));
+  CORRADE_VERIFY(!other.hasLandmarkIndex());
+  Cr::Utility::Path::remove(landmarkFile);
+
+  // a new navmesh discards the index
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+  CORRADE_VERIFY(!pathFinder.hasLandmarkIndex());
+}
+
+void PathFinderTest::goalDistanceField() {
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+
+  esp::core::Random rng(0);
+  std::vector<esp::vec3f> goals;
+  for (int i = 0; i < 5; ++i) {
+    goals.push_back(pathFinder.getRandomNavigablePoint(rng));
+  }
+  esp::nav::GoalDistanceField field;
+  field.setGoals(goals);
+
+  // the goals themselves are at distance 0
+  CORRADE_COMPARE_AS(pathFinder.distanceToGoals(field, goals[0]), 1e-3f,
+                     Cr::TestSuite::Compare::LessOrEqual);
+
+  for (int i = 0; i < 100; ++i) {
+    CORRADE_ITERATION(i);
+    esp::nav::MultiGoalShortestPath path;
+    path.requestedStart = pathFinder.getRandomNavigablePoint(rng);
+    path.setRequestedEnds(goals);
+    const float distance =
+        pathFinder.distanceToGoals(field, path.requestedStart);
+    if (!pathFinder.findPath(path)) {
+      CORRADE_COMPARE(distance, Mn::Constants::inf());
+      continue;
+    }
+    // paths through single points of polygon edges are slightly longer than
+    // the straightened ones
+    CORRADE_COMPARE_AS(distance, path.geodesicDistance - 1e-3f,
+                       Cr::TestSuite::Compare::GreaterOrEqual);
+    CORRADE_COMPARE_AS(distance, 1.25f * path.geodesicDistance + 0.5f,
+                       Cr::TestSuite::Compare::LessOrEqual);
+  }
+
+  // new goals recompute the field
+  field.setGoals({goals[1]});
+  CORRADE_COMPARE_AS(pathFinder.distanceToGoals(field, goals[1]), 1e-3f,
+                     Cr::TestSuite::Compare::LessOrEqual);
+}
+
+void PathFinderTest::topDownView() {
+  esp::nav::PathFinder pathFinder;
+  CORRADE_VERIFY(pathFinder.loadNavMesh(skokloster));
+
+  // the rasterized views match projecting every pixel to the navmesh
+  const float metersPerPixel = 0.1f;
+  const float height = pathFinder.getRandomNavigablePoint()[1];
+  const float eps = 0.5f;
+  const Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> view =
+      pathFinder.getTopDownView(metersPerPixel, height, eps);
+  const Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic> islandView =
+      pathFinder.getTopDownIslandView(metersPerPixel, height, eps);
+  CORRADE_COMPARE(islandView.rows(), view.rows());
+  CORRADE_COMPARE(islandView.cols(), view.cols());
+  CORRADE_VERIFY(view.count() > 0);
+
+  const std::pair<esp::vec3f, esp::vec3f> bounds = pathFinder.bounds();
+  int numMismatches = 0;
+  float curz = bounds.first[2];
+  for (int h = 0; h < view.rows(); ++h) {
+    float curx = bounds.first[0];
+    for (int w = 0; w < view.cols(); ++w) {
+      const esp::vec3f point{curx, height, curz};
+      const bool navigable = pathFinder.isNavigable(point, eps);
+      if (view(h, w) != navigable ||
+          islandView(h, w) != (navigable ? pathFinder.getIsland(point) : -1))
+        ++numMismatches;
+      curx = curx + metersPerPixel;
+    }
+    curz = curz + metersPerPixel;
+  }
+  CORRADE_COMPARE(numMismatches, 0);
+}
+
 void PathFinderTest::testCaching() {
   esp::nav::PathFinder pathFinder;
   pathFinder.loadNavMesh(skokloster);
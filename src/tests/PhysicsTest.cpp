@@ -2,9 +2,13 @@
 // This source code is licensed under the MIT license found in the
 // LICENSE file in the root directory of this source tree.
 
+#include <Corrade/Containers/ArrayViewStl.h>
 #include <Corrade/TestSuite/Compare/Numeric.h>
 #include <Corrade/TestSuite/Tester.h>
 #include <Corrade/Utility/Path.h>
+#include <Magnum/Math/Constants.h>
+#include <Magnum/Math/Quaternion.h>
+#include <cmath>
 #include <string>
 
 #include "esp/sim/Simulator.h"
@@ -74,13 +78,17 @@ struct PhysicsTest : Cr::TestSuite::Tester {
     sceneID_ = sceneManager_->initSceneGraph();
   }
 
-  void initStage(const std::string& stageFile) {
+  void initStage(const std::string& stageFile,
+                 esp::metadata::attributes::PhysicsManagerAttributes::ptr
+                     physicsManagerAttributes = nullptr) {
     auto& sceneGraph = sceneManager_->getSceneGraph(sceneID_);
     auto& rootNode = sceneGraph.getRootNode();
 
     // construct appropriate physics attributes based on config file
-    auto physicsManagerAttributes =
-        physicsAttributesManager_->createObject(physicsConfigFile, true);
+    if (!physicsManagerAttributes) {
+      physicsManagerAttributes =
+          physicsAttributesManager_->createObject(physicsConfigFile, true);
+    }
     auto stageAttributesMgr = metadataMediator_->getStageAttributesManager();
     if (physicsManagerAttributes != nullptr) {
       stageAttributesMgr->setCurrPhysicsManagerAttributesHandle(
@@ -146,12 +154,19 @@ struct PhysicsTest : Cr::TestSuite::Tester {
   void testCollisionBoundingBox();
   void testDiscreteContactTest();
   void testBulletCompoundShapeMargins();
+  void testConvexHullSimplification();
+  void testSharedCollisionShapes();
+  void testSharedStageBvhs();
+  void testMultiThreadedStepping();
+  void testDeferredNodeUpdates();
   void testConfigurableScaling();
   void testVelocityControl();
   void testSceneNodeAttachment();
   void testMotionTypes();
   void testNumActiveContactPoints();
   void testRemoveSleepingSupport();
+  void testSaveRestoreState();
+  void testBatchedRigidObjectStates();
   /////
 
   esp::logging::LoggingContext loggingContext_;
@@ -181,11 +196,18 @@ PhysicsTest::PhysicsTest() {
        &PhysicsTest::testCollisionBoundingBox,
        &PhysicsTest::testDiscreteContactTest,
        &PhysicsTest::testBulletCompoundShapeMargins,
+       &PhysicsTest::testConvexHullSimplification,
+       &PhysicsTest::testSharedCollisionShapes,
+       &PhysicsTest::testSharedStageBvhs,
+       &PhysicsTest::testMultiThreadedStepping,
+       &PhysicsTest::testDeferredNodeUpdates,
 #endif
        &PhysicsTest::testConfigurableScaling, &PhysicsTest::testVelocityControl,
        &PhysicsTest::testSceneNodeAttachment, &PhysicsTest::testMotionTypes,
        &PhysicsTest::testNumActiveContactPoints,
-       &PhysicsTest::testRemoveSleepingSupport},
+       &PhysicsTest::testRemoveSleepingSupport,
+       &PhysicsTest::testSaveRestoreState,
+       &PhysicsTest::testBatchedRigidObjectStates},
       Cr::Containers::arraySize(RendererEnabledData));
 }
 
@@ -490,6 +512,307 @@ void PhysicsTest::testBulletCompoundShapeMargins() {
     CORRADE_COMPARE(AabbOb2, objectGroundTruth);
   }
 }  // PhysicsTest::testBulletCompoundShapeMargins
+
+void PhysicsTest::testConvexHullSimplification() {
+  // interior and duplicate points of a cube are dropped
+  std::vector<Magnum::Vector3> cubePoints;
+  for (int i = 0; i < 8; ++i) {
+    cubePoints.emplace_back(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f,
+                            i & 4 ? 1.0f : -1.0f);
+  }
+  cubePoints.push_back(cubePoints[3]);
+  cubePoints.emplace_back(0.5f, -0.25f, 0.0f);
+  cubePoints.emplace_back(1.0f, 0.0f, 0.0f);
+  CORRADE_COMPARE(
+      esp::physics::BulletBase::computeConvexHull(cubePoints).size(), 8);
+
+  // a densely sampled sphere is decimated to at most the requested vertices
+  std::vector<Magnum::Vector3> spherePoints;
+  for (int i = 0; i < 40; ++i) {
+    const float theta = Magnum::Constants::pi() * (i + 0.5f) / 40;
+    for (int j = 0; j < 40; ++j) {
+      const float phi = 2.0f * Magnum::Constants::pi() * j / 40;
+      spherePoints.emplace_back(std::sin(theta) * std::cos(phi),
+                                std::cos(theta),
+                                std::sin(theta) * std::sin(phi));
+    }
+  }
+  const std::vector<Magnum::Vector3> decimated =
+      esp::physics::BulletBase::computeConvexHull(spherePoints, 32);
+  CORRADE_COMPARE_AS(decimated.size(), std::size_t{32},
+                     Cr::TestSuite::Compare::LessOrEqual);
+  CORRADE_COMPARE_AS(decimated.size(), std::size_t{4},
+                     Cr::TestSuite::Compare::GreaterOrEqual);
+  for (const Magnum::Vector3& v : decimated) {
+    CORRADE_COMPARE(v.length(), 1.0f);
+  }
+
+  // simplified mesh colliders keep the exact extents of the mesh
+  std::string objectFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/objects/transform_box.glb");
+
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+  initStage(objectFile);
+
+  if (physicsManager_->getPhysicsSimulationLibrary() ==
+      PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+    ObjectAttributes::ptr ObjectAttributes = ObjectAttributes::create();
+    ObjectAttributes->setRenderAssetHandle(objectFile);
+    ObjectAttributes->setMargin(0.1);
+    ObjectAttributes->setSimplifyCollisionHulls(true);
+
+    auto objectAttributesManager =
+        metadataMediator_->getObjectAttributesManager();
+    objectAttributesManager->registerObject(ObjectAttributes, objectFile);
+    ObjectAttributes::ptr objectTemplate =
+        objectAttributesManager->getObjectCopyByHandle(objectFile);
+
+    auto* drawables = &sceneManager_->getSceneGraph(sceneID_).getDrawables();
+    const Magnum::Range3D objectGroundTruth({-1.1, -1.1, -1.1},
+                                            {1.1, 1.1, 1.1});
+
+    for (bool join : {false, true}) {
+      objectTemplate->setJoinCollisionMeshes(join);
+      objectAttributesManager->registerObject(objectTemplate);
+      // the second instance reuses the hulls computed for the first
+      for (int i = 0; i < 2; ++i) {
+        auto objectWrapper = makeObjectGetWrapper(objectFile, drawables);
+        CORRADE_VERIFY(objectWrapper);
+        CORRADE_COMPARE(objectWrapper->getCollisionShapeAabb(),
+                        objectGroundTruth);
+      }
+    }
+  }
+}  // PhysicsTest::testConvexHullSimplification
+
+void PhysicsTest::testSharedCollisionShapes() {
+  // instances of the same object share their convex shapes without leaking
+  // per-instance changes to each other
+  std::string objectFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/objects/transform_box.glb");
+
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+  initStage(objectFile);
+
+  if (physicsManager_->getPhysicsSimulationLibrary() ==
+      PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+    ObjectAttributes::ptr ObjectAttributes = ObjectAttributes::create();
+    ObjectAttributes->setRenderAssetHandle(objectFile);
+    ObjectAttributes->setMargin(0.1);
+    metadataMediator_->getObjectAttributesManager()->registerObject(
+        ObjectAttributes, objectFile);
+
+    auto* drawables = &sceneManager_->getSceneGraph(sceneID_).getDrawables();
+    const Magnum::Range3D objectGroundTruth({-1.1, -1.1, -1.1},
+                                            {1.1, 1.1, 1.1});
+
+    auto objectWrapper0 = makeObjectGetWrapper(objectFile, drawables);
+    auto objectWrapper1 = makeObjectGetWrapper(objectFile, drawables);
+    CORRADE_VERIFY(objectWrapper0);
+    CORRADE_VERIFY(objectWrapper1);
+    CORRADE_COMPARE(objectWrapper0->getCollisionShapeAabb(),
+                    objectGroundTruth);
+    CORRADE_COMPARE(objectWrapper1->getCollisionShapeAabb(),
+                    objectGroundTruth);
+
+    // the shapes of the other instance keep their margin
+    objectWrapper0->setMargin(0.2);
+    CORRADE_COMPARE(objectWrapper0->getMargin(), 0.2);
+    CORRADE_VERIFY(objectWrapper0->getCollisionShapeAabb() !=
+                   objectGroundTruth);
+    CORRADE_COMPARE(objectWrapper1->getCollisionShapeAabb(),
+                    objectGroundTruth);
+    objectWrapper0->setMargin(0.1);
+    CORRADE_COMPARE(objectWrapper0->getCollisionShapeAabb(),
+                    objectGroundTruth);
+
+    // instances at another scale don't rescale the shapes of the others
+    const std::string scaledHandle = objectFile + "_scaled";
+    ObjectAttributes::ptr scaledAttributes =
+        metadataMediator_->getObjectAttributesManager()->getObjectCopyByHandle(
+            objectFile);
+    scaledAttributes->setScale({2.0, 3.0, 4.0});
+    metadataMediator_->getObjectAttributesManager()->registerObject(
+        scaledAttributes, scaledHandle);
+    const Magnum::Range3D scaledGroundTruth({-2.1, -3.1, -4.1},
+                                            {2.1, 3.1, 4.1});
+    auto scaledWrapper0 = makeObjectGetWrapper(scaledHandle, drawables);
+    auto scaledWrapper1 = makeObjectGetWrapper(scaledHandle, drawables);
+    CORRADE_VERIFY(scaledWrapper0);
+    CORRADE_VERIFY(scaledWrapper1);
+    CORRADE_COMPARE(scaledWrapper0->getCollisionShapeAabb(),
+                    scaledGroundTruth);
+    CORRADE_COMPARE(scaledWrapper1->getCollisionShapeAabb(),
+                    scaledGroundTruth);
+    CORRADE_COMPARE(objectWrapper0->getCollisionShapeAabb(),
+                    objectGroundTruth);
+    CORRADE_COMPARE(objectWrapper1->getCollisionShapeAabb(),
+                    objectGroundTruth);
+    rigidObjectManager_->removePhysObjectByID(scaledWrapper0->getID());
+    rigidObjectManager_->removePhysObjectByID(scaledWrapper1->getID());
+
+    // shapes are rebuilt once all instances using them are gone
+    rigidObjectManager_->removePhysObjectByID(objectWrapper0->getID());
+    rigidObjectManager_->removePhysObjectByID(objectWrapper1->getID());
+    auto objectWrapper2 = makeObjectGetWrapper(objectFile, drawables);
+    CORRADE_VERIFY(objectWrapper2);
+    CORRADE_COMPARE(objectWrapper2->getCollisionShapeAabb(),
+                    objectGroundTruth);
+  }
+}  // PhysicsTest::testSharedCollisionShapes
+
+void PhysicsTest::testSharedStageBvhs() {
+  // instances of the same stage share their bvhs, which stay cached after
+  // the last of them is released
+  std::string stageFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/scenes/simple_room.glb");
+
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+  initStage(stageFile);
+
+  if (physicsManager_->getPhysicsSimulationLibrary() ==
+      PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+    using esp::physics::BulletRigidStage;
+    // the stage may have been cached by an earlier test already
+    const int numBuilds = BulletRigidStage::getNumOptimizedBvhBuilds();
+    CORRADE_VERIFY(numBuilds > 0);
+
+    // a second instance reuses the bvhs of the first
+    std::shared_ptr<PhysicsManager> firstPhysicsManager = physicsManager_;
+    initStage(stageFile);
+    CORRADE_COMPARE(BulletRigidStage::getNumOptimizedBvhBuilds(), numBuilds);
+
+    // and so does one instanced after both are released, as the physics
+    // manager is replaced before the stage is loaded
+    firstPhysicsManager = nullptr;
+    initStage(stageFile);
+    CORRADE_COMPARE(BulletRigidStage::getNumOptimizedBvhBuilds(), numBuilds);
+  }
+}  // PhysicsTest::testSharedStageBvhs
+
+void PhysicsTest::testMultiThreadedStepping() {
+  // a deterministic world stepped with several threads follows the same
+  // trajectories as a single-threaded one
+  std::string stageFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/scenes/simple_room.glb");
+
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+
+  const auto simulate = [&](const int numThreads) {
+    auto physicsManagerAttributes =
+        physicsAttributesManager_->createObject(physicsConfigFile, true);
+    physicsManagerAttributes->setNumThreads(numThreads);
+    physicsManagerAttributes->setDeterministic(true);
+    initStage(stageFile, physicsManagerAttributes);
+
+    std::vector<Mn::Vector3> translations;
+    if (physicsManager_->getPhysicsSimulationLibrary() !=
+        PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+      return translations;
+    }
+    const std::string cubeHandle =
+        metadataMediator_->getObjectAttributesManager()
+            ->getObjectHandlesBySubstring("cubeSolid")[0];
+    // a pile of cubes, so that many contacts are dispatched each step
+    std::vector<int> ids;
+    for (int o = 0; o < 12; ++o) {
+      auto objWrapper = makeObjectGetWrapper(cubeHandle);
+      objWrapper->setTranslation(
+          {0.3f * (o % 3), 1.5f + 1.1f * o, 0.25f * (o % 2)});
+      objWrapper->setRotation(Mn::Quaternion::rotation(
+          Mn::Deg(15.0f * o), Mn::Vector3{1.0f, 1.0f, 0.0f}.normalized()));
+      ids.push_back(objWrapper->getID());
+    }
+    while (physicsManager_->getWorldTime() < 3.0) {
+      physicsManager_->stepPhysics(0.1);
+    }
+    for (const int id : ids) {
+      translations.push_back(
+          rigidObjectManager_->getObjectByID(id)->getTranslation());
+    }
+    return translations;
+  };
+
+  const std::vector<Mn::Vector3> singleThreaded = simulate(1);
+  const std::vector<Mn::Vector3> multiThreaded = simulate(4);
+  CORRADE_COMPARE(multiThreaded.size(), singleThreaded.size());
+  for (std::size_t i = 0; i < singleThreaded.size(); ++i) {
+    CORRADE_ITERATION(i);
+    CORRADE_COMPARE(multiThreaded[i], singleThreaded[i]);
+  }
+}  // PhysicsTest::testMultiThreadedStepping
+
+void PhysicsTest::testDeferredNodeUpdates() {
+  // test that deferred scene graph updates are applied by updateNodes
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+
+  std::string stageFile = "NONE";
+
+  initStage(stageFile);
+  auto& drawables = sceneManager_->getSceneGraph(sceneID_).getDrawables();
+
+  // We need dynamics to test this.
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::NoPhysics) {
+    auto objectAttributesManager =
+        metadataMediator_->getObjectAttributesManager();
+
+    std::string cubeHandle =
+        objectAttributesManager->getObjectHandlesBySubstring("cubeSolid")[0];
+
+    // a static cube with a dynamic cube sleeping on top of it
+    auto staticCube = makeObjectGetWrapper(cubeHandle, &drawables);
+    staticCube->setTranslation(Mn::Vector3(2.0, 0.0, 0.0));
+    staticCube->setMotionType(esp::physics::MotionType::STATIC);
+    auto sleepingCube = makeObjectGetWrapper(cubeHandle, &drawables);
+    sleepingCube->setTranslation(Mn::Vector3(2.0, 0.2, 0.0));
+    while (physicsManager_->getWorldTime() < 4.0) {
+      physicsManager_->stepPhysics(0.1);
+    }
+    CORRADE_VERIFY(!sleepingCube->isActive());
+    const Mn::Vector3 sleepingTranslation = sleepingCube->getTranslation();
+
+    // and one falling cube in free space
+    auto fallingCube = makeObjectGetWrapper(cubeHandle, &drawables);
+    fallingCube->setTranslation(Mn::Vector3(0.0, 2.0, 0.0));
+
+    esp::physics::BulletPhysicsManager* bPhysManager =
+        static_cast<esp::physics::BulletPhysicsManager*>(physicsManager_.get());
+
+    const Mn::Vector3 startTranslation = fallingCube->getTranslation();
+    physicsManager_->deferNodesUpdate();
+    physicsManager_->stepPhysics(0.1);
+    // the scene graph is not touched until updateNodes
+    CORRADE_COMPARE(fallingCube->getTranslation(), startTranslation);
+    // only the falling cube is pending, the sleeping and static cubes are
+    // never visited
+    CORRADE_VERIFY(!sleepingCube->isActive());
+    CORRADE_COMPARE(bPhysManager->getDeferredObjectIds().size(), 1);
+    CORRADE_COMPARE(bPhysManager->getDeferredObjectIds()[0],
+                    fallingCube->getID());
+
+    physicsManager_->updateNodes();
+    CORRADE_VERIFY(bPhysManager->getDeferredObjectIds().empty());
+    CORRADE_COMPARE_AS(fallingCube->getTranslation().y(),
+                       startTranslation.y(),
+                       Cr::TestSuite::Compare::Less);
+    CORRADE_COMPARE(staticCube->getTranslation(), Mn::Vector3(2.0, 0.0, 0.0));
+    CORRADE_COMPARE(sleepingCube->getTranslation(), sleepingTranslation);
+
+    // updates are applied immediately again after updateNodes
+    const Mn::Vector3 syncedTranslation = fallingCube->getTranslation();
+    physicsManager_->stepPhysics(0.1);
+    CORRADE_COMPARE_AS(fallingCube->getTranslation().y(),
+                       syncedTranslation.y(), Cr::TestSuite::Compare::Less);
+
+    // objects removed while their update is pending are skipped
+    physicsManager_->deferNodesUpdate();
+    physicsManager_->stepPhysics(0.1);
+    rigidObjectManager_->removePhysObjectByID(fallingCube->getID());
+    physicsManager_->updateNodes();
+    CORRADE_COMPARE(physicsManager_->getNumRigidObjects(), 2);
+  }
+}  // PhysicsTest::testDeferredNodeUpdates
 #endif
 
 void PhysicsTest::testConfigurableScaling() {
@@ -931,6 +1254,31 @@ void PhysicsTest::testNumActiveContactPoints() {
         physicsManager_->getStepCollisionSummary(),
         "[RigidObject, cubeSolid, id 0] vs [Stage, subpart 6], 4 points\n");
 
+    // streaming query into a preallocated buffer matches the vector query
+    esp::physics::ContactPointData contactBuffer[8];
+    CORRADE_COMPARE(physicsManager_->getContactPoints(contactBuffer),
+                    std::size_t{4});
+    for (std::size_t i = 0; i < 4; ++i) {
+      CORRADE_COMPARE(contactBuffer[i].objectIdA,
+                      allContactPoints[i].objectIdA);
+      CORRADE_COMPARE(contactBuffer[i].objectIdB,
+                      allContactPoints[i].objectIdB);
+      CORRADE_COMPARE(contactBuffer[i].positionOnBInWS,
+                      allContactPoints[i].positionOnBInWS);
+    }
+    // a too small buffer still reports the total count
+    CORRADE_COMPARE(physicsManager_->getContactPoints(
+                        Cr::Containers::arrayView(contactBuffer).prefix(2)),
+                    std::size_t{4});
+    // filter by object id
+    const int cubeIds[]{objWrapper0->getID()};
+    const int otherIds[]{objWrapper0->getID() + 1};
+    CORRADE_COMPARE(physicsManager_->getContactPoints(contactBuffer, cubeIds),
+                    std::size_t{4});
+    CORRADE_COMPARE(
+        physicsManager_->getContactPoints(contactBuffer, otherIds),
+        std::size_t{0});
+
     float totalNormalForce = 0;
     for (auto& cp : allContactPoints) {
       // contacts are still active
@@ -1036,6 +1384,138 @@ void PhysicsTest::testRemoveSleepingSupport() {
   }
 }  // PhysicsTest::testRemoveSleepingSupport
 
+void PhysicsTest::testSaveRestoreState() {
+  // test that restoring a snapshot reproduces the saved trajectory
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+
+  std::string stageFile =
+      Cr::Utility::Path::join(dataDir, "test_assets/scenes/simple_room.glb");
+
+  initStage(stageFile);
+  auto& drawables = sceneManager_->getSceneGraph(sceneID_).getDrawables();
+
+  // We need dynamics to test this.
+  if (physicsManager_->getPhysicsSimulationLibrary() !=
+      PhysicsManager::PhysicsSimulationLibrary::NoPhysics) {
+    auto objectAttributesManager =
+        metadataMediator_->getObjectAttributesManager();
+
+    std::string cubeHandle =
+        objectAttributesManager->getObjectHandlesBySubstring("cubeSolid")[0];
+
+    auto objWrapper = makeObjectGetWrapper(cubeHandle, &drawables);
+    objWrapper->setTranslation(Mn::Vector3(0.21964, 1.29183, -0.0897472));
+    objWrapper->setAngularVelocity(Mn::Vector3(1.0, 0.5, 0.0));
+
+    physicsManager_->stepPhysics(0.1);
+    auto snapshot = physicsManager_->saveState();
+    CORRADE_VERIFY(snapshot);
+    CORRADE_COMPARE(snapshot->rigidObjects.size(), std::size_t{1});
+    CORRADE_COMPARE(snapshot->worldTime, physicsManager_->getWorldTime());
+    const Mn::Vector3 savedTranslation = objWrapper->getTranslation();
+
+    // simulate the cube falling onto the floor and record the outcome
+    for (int i = 0; i < 10; ++i) {
+      physicsManager_->stepPhysics(0.1);
+    }
+    const double endTime = physicsManager_->getWorldTime();
+    const Mn::Vector3 endTranslation = objWrapper->getTranslation();
+    const Mn::Quaternion endRotation = objWrapper->getRotation();
+    CORRADE_VERIFY(endTranslation != savedTranslation);
+
+    // restoring brings the world back to the saved state
+    CORRADE_VERIFY(physicsManager_->restoreState(*snapshot));
+    CORRADE_COMPARE(physicsManager_->getWorldTime(), snapshot->worldTime);
+    CORRADE_COMPARE(objWrapper->getTranslation(), savedTranslation);
+
+    // replaying the same steps reproduces the same trajectory
+    for (int i = 0; i < 10; ++i) {
+      physicsManager_->stepPhysics(0.1);
+    }
+    CORRADE_COMPARE(physicsManager_->getWorldTime(), endTime);
+    CORRADE_COMPARE(objWrapper->getTranslation(), endTranslation);
+    CORRADE_COMPARE(objWrapper->getRotation(), endRotation);
+
+    // steps which are not a multiple of the timestep leave a remainder for
+    // the next one, which is restored as well
+    physicsManager_->setTimestep(0.01);
+    objWrapper->setLinearVelocity(Mn::Vector3(1.0, 3.0, 0.0));
+    physicsManager_->stepPhysics(0.025);
+    auto remainderSnapshot = physicsManager_->saveState();
+    if (physicsManager_->getPhysicsSimulationLibrary() ==
+        PhysicsManager::PhysicsSimulationLibrary::Bullet) {
+      CORRADE_COMPARE_AS(remainderSnapshot->stepRemainder, 0.0,
+                         Cr::TestSuite::Compare::Greater);
+    }
+    for (int i = 0; i < 10; ++i) {
+      physicsManager_->stepPhysics(0.025);
+    }
+    const Mn::Vector3 remainderEndTranslation = objWrapper->getTranslation();
+    const Mn::Quaternion remainderEndRotation = objWrapper->getRotation();
+    CORRADE_VERIFY(physicsManager_->restoreState(*remainderSnapshot));
+    for (int i = 0; i < 10; ++i) {
+      physicsManager_->stepPhysics(0.025);
+    }
+    CORRADE_COMPARE(objWrapper->getTranslation(), remainderEndTranslation);
+    CORRADE_COMPARE(objWrapper->getRotation(), remainderEndRotation);
+
+    // a snapshot referring to a removed object reports the mismatch
+    rigidObjectManager_->removeAllObjects();
+    CORRADE_VERIFY(!physicsManager_->restoreState(*snapshot));
+  }
+}  // PhysicsTest::testSaveRestoreState
+
+void PhysicsTest::testBatchedRigidObjectStates() {
+  // test reading and writing rigid object states through flat arrays
+  resetCreateRendererFlag(RendererEnabledData[testCaseInstanceId()].enabled);
+
+  std::string stageFile = "NONE";
+
+  initStage(stageFile);
+  auto& drawables = sceneManager_->getSceneGraph(sceneID_).getDrawables();
+
+  auto objectAttributesManager =
+      metadataMediator_->getObjectAttributesManager();
+  std::string cubeHandle =
+      objectAttributesManager->getObjectHandlesBySubstring("cubeSolid")[0];
+
+  auto objWrapper0 = makeObjectGetWrapper(cubeHandle, &drawables);
+  auto objWrapper1 = makeObjectGetWrapper(cubeHandle, &drawables);
+  objWrapper1->setMotionType(esp::physics::MotionType::KINEMATIC);
+
+  const std::vector<int> ids = physicsManager_->getExistingObjectIDs();
+  CORRADE_COMPARE(ids.size(), std::size_t{2});
+
+  const Mn::Vector3 translations[]{{1.0, 2.0, 3.0}, {-1.0, 0.5, 2.0}};
+  const Mn::Quaternion rotations[]{
+      Mn::Quaternion::rotation(Mn::Deg(30.0), Mn::Vector3::yAxis()),
+      Mn::Quaternion::rotation(Mn::Deg(-45.0), Mn::Vector3::xAxis())};
+  CORRADE_VERIFY(physicsManager_->setRigidObjectStates(
+      ids, translations, rotations, nullptr, nullptr));
+
+  Mn::Vector3 outTranslations[2];
+  Mn::Quaternion outRotations[2];
+  esp::physics::MotionType outMotionTypes[2];
+  CORRADE_VERIFY(physicsManager_->getRigidObjectStates(
+      ids, outTranslations, outRotations, nullptr, nullptr, outMotionTypes));
+  for (std::size_t i = 0; i < 2; ++i) {
+    CORRADE_COMPARE(outTranslations[i], translations[i]);
+    CORRADE_COMPARE(outRotations[i], rotations[i]);
+  }
+  CORRADE_COMPARE(objWrapper0->getTranslation(), translations[0]);
+  CORRADE_COMPARE(objWrapper1->getRotation(), rotations[1]);
+  CORRADE_COMPARE(outMotionTypes[1], esp::physics::MotionType::KINEMATIC);
+
+  // unknown ids are reported and marked as undefined
+  const int unknownIds[]{ids[0], 1000};
+  CORRADE_VERIFY(!physicsManager_->getRigidObjectStates(
+      unknownIds, nullptr, nullptr, nullptr, nullptr, outMotionTypes));
+  CORRADE_COMPARE(outMotionTypes[0], objWrapper0->getMotionType());
+  CORRADE_COMPARE(outMotionTypes[1], esp::physics::MotionType::UNDEFINED);
+  CORRADE_VERIFY(!physicsManager_->setRigidObjectStates(
+      unknownIds, translations, nullptr, nullptr, nullptr));
+}  // PhysicsTest::testBatchedRigidObjectStates
+
 }  // namespace
 
 CORRADE_TEST_MAIN(PhysicsTest)
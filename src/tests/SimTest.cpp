@@ -11,12 +11,16 @@
 #include <Magnum/ImageView.h>
 #include <Magnum/Magnum.h>
 #include <Magnum/PixelFormat.h>
+#include <algorithm>
 #include <string>
 
 #include "esp/assets/ResourceManager.h"
 #include "esp/metadata/MetadataMediator.h"
 #include "esp/physics/RigidObject.h"
 #include "esp/physics/objectManagers/RigidObjectManager.h"
+#ifdef ESP_BUILD_WITH_BULLET
+#include "esp/physics/bullet/BulletRigidStage.h"
+#endif
 #include "esp/sensor/CameraSensor.h"
 #include "esp/sim/Simulator.h"
 
@@ -125,6 +129,12 @@ struct SimTest : Cr::TestSuite::Tester {
   void updateObjectLightSetupRGBAObservation();
   void multipleLightingSetupsRGBAObservation();
   void recomputeNavmeshWithStaticObjects();
+  void updateNavmeshWithStaticObjects();
+  void joinedMeshCaching();
+  void navMeshCache();
+#ifdef ESP_BUILD_WITH_BULLET
+  void reconfigureReusesStageBvhs();
+#endif
   void loadingObjectTemplates();
   void buildingPrimAssetObjectTemplates();
   void addObjectByHandle();
@@ -168,6 +178,12 @@ SimTest::SimTest() {
             &SimTest::updateObjectLightSetupRGBAObservation,
             &SimTest::multipleLightingSetupsRGBAObservation,
             &SimTest::recomputeNavmeshWithStaticObjects,
+            &SimTest::updateNavmeshWithStaticObjects,
+            &SimTest::joinedMeshCaching,
+            &SimTest::navMeshCache,
+#ifdef ESP_BUILD_WITH_BULLET
+            &SimTest::reconfigureReusesStageBvhs,
+#endif
             &SimTest::loadingObjectTemplates,
             &SimTest::buildingPrimAssetObjectTemplates,
             &SimTest::addObjectByHandle,
@@ -490,6 +506,207 @@ void SimTest::recomputeNavmeshWithStaticObjects() {
       simulator->getPathFinder()->isNavigable(randomNavPoint + offset, 0.2));
 }
 
+void SimTest::updateNavmeshWithStaticObjects() {
+  ESP_DEBUG() << "Starting Test : updateNavmeshWithStaticObjects";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, skokloster, esp::NO_LIGHT_KEY);
+  auto objectAttribsMgr = simulator->getObjectAttributesManager();
+  auto rigidObjMgr = simulator->getRigidObjectManager();
+  auto pathfinder = simulator->getPathFinder();
+
+  // compute the initial tiled navmesh
+  esp::nav::NavMeshSettings navMeshSettings;
+  navMeshSettings.setDefaults();
+  navMeshSettings.tileSize = 64;
+  CORRADE_VERIFY(
+      simulator->recomputeNavMesh(*pathfinder, navMeshSettings, true));
+
+  auto findOpenPoint = [&pathfinder]() {
+    esp::vec3f pt = pathfinder->getRandomNavigablePoint();
+    while (pathfinder->distanceToClosestObstacle(pt) < 1.0 || pt[1] > 1.0) {
+      pt = pathfinder->getRandomNavigablePoint();
+    }
+    return pt;
+  };
+  const esp::vec3f firstPoint = findOpenPoint();
+  esp::vec3f secondPoint = findOpenPoint();
+  while ((secondPoint - firstPoint).norm() < 3.0) {
+    secondPoint = findOpenPoint();
+  }
+
+  // adding a static object only blocks the navmesh under it
+  auto objs = objectAttribsMgr->getObjectHandlesBySubstring("nested_box");
+  auto obj = rigidObjMgr->addObjectByHandle(objs[0]);
+  obj->setTranslation(Magnum::Vector3{firstPoint});
+  obj->setMotionType(esp::physics::MotionType::STATIC);
+  CORRADE_VERIFY(simulator->updateNavMesh(*pathfinder, navMeshSettings));
+  CORRADE_VERIFY(!pathfinder->isNavigable(firstPoint, 0.1));
+  CORRADE_VERIFY(pathfinder->isNavigable(secondPoint, 0.1));
+
+  // moving it frees the old location
+  obj->setTranslation(Magnum::Vector3{secondPoint});
+  CORRADE_VERIFY(simulator->updateNavMesh(*pathfinder, navMeshSettings));
+  CORRADE_VERIFY(pathfinder->isNavigable(firstPoint, 0.1));
+  CORRADE_VERIFY(!pathfinder->isNavigable(secondPoint, 0.1));
+
+  // after two in place updates the islands agree with a full recompute,
+  // including the zero area polygons disabled by the first update
+  auto compareWithFullRecompute = [&]() {
+    auto islandAreas = [&pathfinder]() {
+      std::vector<float> areas;
+      for (int island = 0; island < pathfinder->numIslands(); ++island) {
+        areas.push_back(pathfinder->getNavigableArea(island));
+      }
+      std::sort(areas.begin(), areas.end());
+      return areas;
+    };
+    const float updatedArea = pathfinder->getNavigableArea();
+    const std::vector<float> updatedIslandAreas = islandAreas();
+    CORRADE_VERIFY(
+        simulator->recomputeNavMesh(*pathfinder, navMeshSettings, true));
+    CORRADE_COMPARE_WITH(
+        updatedArea, pathfinder->getNavigableArea(),
+        Cr::TestSuite::Compare::around(0.01f *
+                                       pathfinder->getNavigableArea()));
+    const std::vector<float> recomputedIslandAreas = islandAreas();
+    CORRADE_COMPARE(updatedIslandAreas.size(), recomputedIslandAreas.size());
+    for (std::size_t i = 0; i < updatedIslandAreas.size() &&
+                            i < recomputedIslandAreas.size();
+         ++i) {
+      CORRADE_ITERATION(i);
+      CORRADE_VERIFY(updatedIslandAreas[i] > 0.0f);
+      CORRADE_COMPARE_WITH(updatedIslandAreas[i], recomputedIslandAreas[i],
+                           Cr::TestSuite::Compare::around(
+                               0.01f * recomputedIslandAreas[i] + 1e-4f));
+    }
+  };
+  compareWithFullRecompute();
+
+  // removing it frees the navmesh again
+  rigidObjMgr->removePhysObjectByHandle(obj->getHandle());
+  CORRADE_VERIFY(simulator->updateNavMesh(*pathfinder, navMeshSettings));
+  CORRADE_VERIFY(pathfinder->isNavigable(secondPoint, 0.1));
+  compareWithFullRecompute();
+}
+
+void SimTest::joinedMeshCaching() {
+  ESP_DEBUG() << "Starting Test : joinedMeshCaching";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, skokloster, esp::NO_LIGHT_KEY);
+  auto objectAttribsMgr = simulator->getObjectAttributesManager();
+  auto rigidObjMgr = simulator->getRigidObjectManager();
+
+  const esp::assets::MeshData::ptr stageMesh = simulator->getJoinedMesh();
+  const size_t numStageVerts = stageMesh->vbo.size();
+  // the result is the caller's to modify
+  stageMesh->vbo.clear();
+  CORRADE_COMPARE(simulator->getJoinedMesh()->vbo.size(), numStageVerts);
+
+  auto objs = objectAttribsMgr->getObjectHandlesBySubstring("nested_box");
+  auto obj = rigidObjMgr->addObjectByHandle(objs[0]);
+  obj->setTranslation({1.0f, 0.5f, 0.0f});
+  obj->setMotionType(esp::physics::MotionType::STATIC);
+  const esp::assets::MeshData::ptr first = simulator->getJoinedMesh(true);
+  CORRADE_VERIFY(first->vbo.size() > numStageVerts);
+
+  // cached object components are reused as long as the object doesn't move
+  const esp::assets::MeshData::ptr second = simulator->getJoinedMesh(true);
+  CORRADE_COMPARE(second->vbo.size(), first->vbo.size());
+  CORRADE_VERIFY(second->vbo == first->vbo);
+  CORRADE_VERIFY(second->ibo == first->ibo);
+
+  obj->setTranslation({2.0f, 0.5f, 0.0f});
+  const esp::assets::MeshData::ptr moved = simulator->getJoinedMesh(true);
+  CORRADE_COMPARE(moved->vbo.size(), first->vbo.size());
+  const esp::vec3f offset = moved->vbo.back() - first->vbo.back();
+  CORRADE_COMPARE(Magnum::Vector3{offset}, (Magnum::Vector3{1.0f, 0.0f, 0.0f}));
+}
+
+void SimTest::navMeshCache() {
+  ESP_DEBUG() << "Starting Test : navMeshCache";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, skokloster, esp::NO_LIGHT_KEY);
+  const std::string cacheDir =
+      Cr::Utility::Path::join(TEST_ASSETS, "navmesh_cache");
+  SimulatorConfiguration cfg =
+      simulator->getMetadataMediator()->getSimulatorConfiguration();
+  cfg.navMeshCacheDir = cacheDir;
+  simulator->reconfigure(cfg);
+
+  esp::nav::NavMeshSettings navMeshSettings;
+  navMeshSettings.setDefaults();
+  const esp::assets::MeshData::ptr joinedMesh = simulator->getJoinedMesh();
+  const std::string key =
+      esp::nav::navMeshCacheKey(navMeshSettings, *joinedMesh);
+  CORRADE_COMPARE(key.size(), 16);
+  CORRADE_COMPARE(esp::nav::navMeshCacheKey(navMeshSettings, *joinedMesh),
+                  key);
+  const std::string cachedNavMesh =
+      Cr::Utility::Path::join(cacheDir, key + ".navmesh");
+  Cr::Utility::Path::remove(cachedNavMesh);
+
+  // different settings or geometry are different navmeshes
+  esp::nav::NavMeshSettings otherSettings = navMeshSettings;
+  otherSettings.agentRadius = 0.2f;
+  CORRADE_VERIFY(esp::nav::navMeshCacheKey(otherSettings, *joinedMesh) != key);
+  esp::assets::MeshData otherMesh = *joinedMesh;
+  otherMesh.vbo[0] += esp::vec3f{0.0f, 0.01f, 0.0f};
+  CORRADE_VERIFY(esp::nav::navMeshCacheKey(navMeshSettings, otherMesh) != key);
+
+  // the first recomputation builds the navmesh and caches it
+  auto pathfinder = simulator->getPathFinder();
+  CORRADE_VERIFY(simulator->recomputeNavMesh(*pathfinder, navMeshSettings));
+  CORRADE_VERIFY(Cr::Utility::Path::exists(cachedNavMesh));
+  const float navigableArea = pathfinder->getNavigableArea();
+
+  // a fresh pathfinder, like one in another process, gets the cached navmesh
+  auto cachedPathfinder = PathFinder::create();
+  CORRADE_VERIFY(
+      simulator->recomputeNavMesh(*cachedPathfinder, navMeshSettings));
+  CORRADE_VERIFY(cachedPathfinder->isLoaded());
+  CORRADE_VERIFY(*cachedPathfinder->getNavMeshSettings() == navMeshSettings);
+  CORRADE_COMPARE(cachedPathfinder->getNavigableArea(), navigableArea);
+
+  // a cached navmesh with other settings under the key isn't used
+  auto otherPathfinder = PathFinder::create();
+  CORRADE_VERIFY(otherPathfinder->build(otherSettings, *joinedMesh));
+  CORRADE_VERIFY(otherPathfinder->saveNavMesh(cachedNavMesh));
+  CORRADE_VERIFY(
+      simulator->recomputeNavMesh(*cachedPathfinder, navMeshSettings));
+  CORRADE_VERIFY(*cachedPathfinder->getNavMeshSettings() == navMeshSettings);
+  CORRADE_COMPARE(cachedPathfinder->getNavigableArea(), navigableArea);
+
+  Cr::Utility::Path::remove(cachedNavMesh);
+  Cr::Utility::Path::remove(cacheDir);
+}
+
+#ifdef ESP_BUILD_WITH_BULLET
+void SimTest::reconfigureReusesStageBvhs() {
+  ESP_DEBUG() << "Starting Test : reconfigureReusesStageBvhs";
+  auto&& data = SimulatorBuilder[testCaseInstanceId()];
+  setTestCaseDescription(data.name);
+  auto simulator = data.creator(*this, vangogh, esp::NO_LIGHT_KEY);
+  using esp::physics::BulletRigidStage;
+  const int numBuilds = BulletRigidStage::getNumOptimizedBvhBuilds();
+  CORRADE_VERIFY(numBuilds > 0);
+
+  // a changed configuration re-instances the same stage
+  SimulatorConfiguration cfg =
+      simulator->getMetadataMediator()->getSimulatorConfiguration();
+  cfg.randomSeed += 1;
+  simulator->reconfigure(cfg);
+  CORRADE_COMPARE(BulletRigidStage::getNumOptimizedBvhBuilds(), numBuilds);
+
+  // as does a new simulator for the scene
+  simulator = nullptr;
+  simulator = data.creator(*this, vangogh, esp::NO_LIGHT_KEY);
+  CORRADE_COMPARE(BulletRigidStage::getNumOptimizedBvhBuilds(), numBuilds);
+}
+#endif
+
 void SimTest::loadingObjectTemplates() {
   ESP_DEBUG() << "Starting Test : loadingObjectTemplates";
   auto&& data = SimulatorBuilder[testCaseInstanceId()];
@@ -841,6 +1058,36 @@ void SimTest::createMagnumRenderingOff() {
     point = raycastresults.hits[0].point;
     CORRADE_COMPARE_AS(distanceBetween(point, {10.0, 10.1, 10.0}), 0.001,
                        Cr::TestSuite::Compare::Less);
+
+    // the batched raycast finds the same closest hits
+    const esp::geo::Ray rays[]{
+        esp::geo::Ray({10.0, 9.0, 10.0}, {0.0, 1.0, 0.0}),
+        esp::geo::Ray({10.0, 11.0, 10.0}, {0.0, -1.0, 0.0})};
+    esp::physics::RayHitInfo closestHits[2];
+    simulator->castRays(rays, closestHits, 100.0);
+    CORRADE_COMPARE(closestHits[0].objectId, obj->getID());
+    CORRADE_COMPARE_AS(distanceBetween(closestHits[0].point, {10.0, 9.9, 10.0}),
+                       0.001, Cr::TestSuite::Compare::Less);
+    CORRADE_COMPARE(closestHits[1].objectId, obj->getID());
+    CORRADE_COMPARE_AS(
+        distanceBetween(closestHits[1].point, {10.0, 10.1, 10.0}), 0.001,
+        Cr::TestSuite::Compare::Less);
+    esp::physics::RayHitInfo allHits[8];
+    simulator->castRays(rays, allHits, 100.0);
+    for (int i = 0; i < 2; ++i) {
+      CORRADE_COMPARE(allHits[4 * i].objectId, obj->getID());
+      CORRADE_COMPARE(allHits[4 * i].rayDistance, closestHits[i].rayDistance);
+      for (int j = 1; j < 4 && allHits[4 * i + j].rayDistance >= 0; ++j) {
+        CORRADE_COMPARE_AS(allHits[4 * i + j].rayDistance,
+                           allHits[4 * i + j - 1].rayDistance,
+                           Cr::TestSuite::Compare::GreaterOrEqual);
+      }
+    }
+    // objects outside of the filter mask are not hit
+    simulator->castRays(rays, closestHits, 100.0,
+                        int(esp::physics::CollisionGroup::Static));
+    CORRADE_VERIFY(closestHits[0].rayDistance < 0 ||
+                   closestHits[0].objectId != obj->getID());
   };
 
   auto testBoundingBox = [&]() {
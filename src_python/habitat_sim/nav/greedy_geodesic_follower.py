@@ -8,6 +8,7 @@ import attr
 import numpy as np
 
 from habitat_sim import errors, scene
+from habitat_sim._ext.habitat_sim_bindings import RigidState
 from habitat_sim.agent.agent import Agent
 from habitat_sim.agent.controls.controls import ActuationSpec
 from habitat_sim.nav import GreedyFollowerCodes, GreedyGeodesicFollowerImpl, PathFinder
@@ -195,6 +196,41 @@ class GreedyGeodesicFollower:
 
         return path
 
+    def find_paths(
+        self,
+        start_states: List[Any],
+        goal_positions: List[np.ndarray],
+        allow_sliding: bool = True,
+        num_threads: int = 0,
+    ) -> List[Optional[List[Any]]]:
+        r"""Finds the action sequences for a batch of episodes in parallel
+
+        :param start_states: The agent state each episode starts from
+        :param goal_positions: The goal position of each episode
+        :param allow_sliding: Whether or not ``move_forward`` slides along
+            walls, should match the simulator's setting
+        :param num_threads: The number of worker threads, defaults to all
+        :return: The list of actions of each episode, like :ref:`find_path`,
+            or :py:`None` if no path was found for that episode.
+
+        Unlike :ref:`find_path`, this does not go through the agent, it
+        assumes ``move_forward``, ``turn_left`` and ``turn_right`` are the
+        default agent controls and filters moves with the pathfinder like the
+        simulator does.
+        """
+        starts = [
+            RigidState(quat_to_magnum(state.rotation), state.position)
+            for state in start_states
+        ]
+        paths = self.impl.find_paths(
+            starts, list(goal_positions), allow_sliding, num_threads
+        )
+
+        return [
+            [self.action_mapping[v] for v in path] if len(path) > 0 else None
+            for path in paths
+        ]
+
     def reset(self) -> None:
         self.impl.reset()
         self.last_goal = None
@@ -188,3 +188,54 @@ def test_greedy_follower(test_navmesh, move_filter_fn, action_noise, pbar):
 
     if not test_all:
         assert test_spl / NUM_TESTS >= ACCEPTABLE_SPLS[(move_filter_fn, action_noise)]
+
+
+@pytest.mark.parametrize("test_navmesh", test_navmeshes[:1])
+@pytest.mark.parametrize("move_filter_fn", ["try_step", "try_step_no_sliding"])
+def test_greedy_follower_find_paths(test_navmesh, move_filter_fn):
+    if not osp.exists(test_navmesh):
+        pytest.skip(f"{test_navmesh} not found")
+
+    pathfinder = habitat_sim.PathFinder()
+    pathfinder.load_nav_mesh(test_navmesh)
+    assert pathfinder.is_loaded
+    pathfinder.seed(0)
+
+    scene_graph = habitat_sim.SceneGraph()
+    agent = habitat_sim.Agent(scene_graph.get_root_node().create_child())
+    agent.controls.move_filter_fn = getattr(pathfinder, move_filter_fn)
+    agent.agent_config.action_space["turn_left"].actuation.amount = TURN_DEGREE
+    agent.agent_config.action_space["turn_right"].actuation.amount = TURN_DEGREE
+
+    follower = habitat_sim.GreedyGeodesicFollower(pathfinder, agent)
+
+    start_states, goal_positions = [], []
+    for _ in range(NUM_TESTS // 4):
+        state = habitat_sim.AgentState()
+        state.position = pathfinder.get_random_navigable_point()
+        start_states.append(state)
+        goal_positions.append(pathfinder.get_random_navigable_point())
+
+    batched = follower.find_paths(
+        start_states,
+        goal_positions,
+        allow_sliding=move_filter_fn == "try_step",
+        num_threads=4,
+    )
+    assert len(batched) == len(start_states)
+
+    # The batched plans simulate the same controls as the agent, so they should
+    # agree with the serial planner up to floating point differences in the
+    # collision test
+    num_same = 0
+    for state, goal_pos, actions in zip(start_states, goal_positions, batched):
+        follower.reset()
+        agent.state = state
+        try:
+            serial = follower.find_path(goal_pos)
+        except habitat_sim.errors.GreedyFollowerError:
+            serial = None
+
+        num_same += int(actions == serial)
+
+    assert num_same >= 0.9 * len(start_states)
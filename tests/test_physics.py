@@ -403,6 +403,68 @@ def test_dynamics():
             )
 
 
+def test_rigid_object_states():
+    cfg_settings = habitat_sim.utils.settings.default_sim_settings.copy()
+    cfg_settings["scene"] = "NONE"
+    cfg_settings["enable_physics"] = True
+    hab_cfg = habitat_sim.utils.settings.make_cfg(cfg_settings)
+    with habitat_sim.Simulator(hab_cfg) as sim:
+        obj_template_mgr = sim.get_object_template_manager()
+        rigid_obj_mgr = sim.get_rigid_object_manager()
+        template_path = osp.abspath("data/test_assets/objects/nested_box")
+        template_ids = obj_template_mgr.load_configs(template_path)
+        obj_handle = obj_template_mgr.get_template_handle_by_id(template_ids[0])
+        boxes = [
+            rigid_obj_mgr.add_object_by_template_handle(obj_handle) for _ in range(3)
+        ]
+        boxes[2].motion_type = habitat_sim.physics.MotionType.KINEMATIC
+        ids = np.array([box.object_id for box in boxes], dtype=np.int32)
+
+        # set the states of all objects in one call
+        translations = np.array(
+            [[1.0, 2.0, 3.0], [-1.0, 0.5, 2.0], [0.0, 4.0, -2.0]], dtype=np.float32
+        )
+        rotation = mn.Quaternion.rotation(mn.Deg(30.0), mn.Vector3.y_axis())
+        rotations = np.tile(
+            np.array([*rotation.vector, rotation.scalar], dtype=np.float32), (3, 1)
+        )
+        assert sim.set_rigid_object_states(ids, translations, rotations)
+        for box, translation in zip(boxes, translations):
+            assert np.allclose(box.translation, translation)
+            assert np.allclose(box.rotation.vector, rotation.vector)
+            assert np.isclose(box.rotation.scalar, rotation.scalar)
+        # unknown ids are skipped and reported
+        assert not sim.set_rigid_object_states([ids[0], 1000], translations[:2])
+
+        # and get them back
+        states = sim.get_rigid_object_states(ids)
+        assert np.array_equal(states["object_ids"], ids)
+        assert np.allclose(states["translations"], translations)
+        assert np.allclose(states["rotations"], rotations)
+        assert states["motion_types"][2] == int(
+            habitat_sim.physics.MotionType.KINEMATIC
+        )
+
+        # the arrays of a previous call are filled in place
+        out_arrays = dict(states)
+        translations[:, 1] += 1.0
+        assert sim.set_rigid_object_states(ids, translations=translations)
+        filled = sim.get_rigid_object_states(ids, out=states)
+        assert filled is states
+        for key, value in out_arrays.items():
+            assert filled[key] is value
+        assert np.allclose(states["translations"], translations)
+
+        all_states = sim.get_rigid_object_states()
+        assert sorted(all_states["object_ids"]) == sorted(ids)
+        assert sim.get_rigid_object_states(out=all_states) is all_states
+
+        # out arrays which would be filled through a copy are rejected
+        states["translations"] = states["translations"].astype(np.float64)
+        with pytest.raises(Exception):
+            sim.get_rigid_object_states(ids, out=states)
+
+
 def test_velocity_control():
     cfg_settings = habitat_sim.utils.settings.default_sim_settings.copy()
     cfg_settings["scene"] = "NONE"
@@ -570,6 +632,78 @@ def test_raycast():
             assert not raycast_results.has_hits()
 
 
+@pytest.mark.skipif(
+    not osp.exists("data/scene_datasets/habitat-test-scenes/apartment_1.glb"),
+    reason="Requires the habitat-test-scenes",
+)
+def test_cast_rays():
+    cfg_settings = habitat_sim.utils.settings.default_sim_settings.copy()
+    cfg_settings["scene"] = "data/scene_datasets/habitat-test-scenes/apartment_1.glb"
+    cfg_settings["enable_physics"] = True
+    hab_cfg = habitat_sim.utils.settings.make_cfg(cfg_settings)
+    with habitat_sim.Simulator(hab_cfg) as sim:
+        if (
+            sim.get_physics_simulation_library()
+            == habitat_sim.physics.PhysicsSimulationLibrary.NoPhysics
+        ):
+            return
+
+        origins = np.array(
+            [[0.0, 0.0, 0.0], [0.0, 0.0, 2.0], [0.0, 0.0, 0.0]], dtype=np.float32
+        )
+        directions = np.array(
+            [[1.0, 0.0, 0.0], [1.0, 0.0, 0.0], [0.0, 0.0, 0.0]], dtype=np.float32
+        )
+
+        # the closest hits match those of single ray casts
+        results = sim.cast_rays(origins, directions)
+        assert results["distance"].shape == (3, 1)
+        assert results["normal"].shape == (3, 1, 3)
+        assert results["object_id"].shape == (3, 1)
+        for i in range(2):
+            ray = habitat_sim.geo.Ray(
+                mn.Vector3(*origins[i]), mn.Vector3(*directions[i])
+            )
+            closest = sim.cast_ray(ray).hits[0]
+            assert np.isclose(
+                results["distance"][i, 0], closest.ray_distance, atol=1e-4
+            )
+            assert np.allclose(results["normal"][i, 0], closest.normal, atol=1e-4)
+            assert results["object_id"][i, 0] == closest.object_id
+        # a zero direction hits nothing
+        assert results["distance"][2, 0] < 0
+
+        # all hits, sorted by distance, in a fixed number of slots per ray
+        all_results = sim.cast_rays(origins, directions, max_hits_per_ray=4)
+        for i in range(2):
+            ray = habitat_sim.geo.Ray(
+                mn.Vector3(*origins[i]), mn.Vector3(*directions[i])
+            )
+            hits = sim.cast_ray(ray).hits[:4]
+            for slot, hit in enumerate(hits):
+                assert np.isclose(
+                    all_results["distance"][i, slot], hit.ray_distance, atol=1e-4
+                )
+            assert np.all(all_results["distance"][i, len(hits) :] < 0)
+
+        # the arrays of a previous call are filled in place
+        out_arrays = dict(results)
+        origins[:, 1] += 0.5
+        filled = sim.cast_rays(origins, directions, out=results)
+        assert filled is results
+        for key, value in out_arrays.items():
+            assert filled[key] is value
+        ray = habitat_sim.geo.Ray(
+            mn.Vector3(*origins[0]), mn.Vector3(*directions[0])
+        )
+        closest = sim.cast_ray(ray).hits[0]
+        assert np.isclose(results["distance"][0, 0], closest.ray_distance, atol=1e-4)
+
+        # out arrays of another shape are rejected
+        with pytest.raises(Exception):
+            sim.cast_rays(origins, directions, max_hits_per_ray=2, out=results)
+
+
 @pytest.mark.skipif(
     not osp.exists("data/scene_datasets/habitat-test-scenes/apartment_1.glb"),
     reason="Requires the habitat-test-scenes",
@@ -981,6 +1115,49 @@ def test_articulated_object_kinematics(test_asset):
         assert np.allclose(robot.joint_velocities, np.zeros(num_dofs))
         assert np.allclose(robot.joint_forces, np.zeros(num_dofs))
 
+        # batched joint state access over a list of articulated objects
+        assert robot.num_dofs == num_dofs
+        assert robot.num_joint_positions == len(robot.joint_positions)
+        assert sim.set_articulated_joint_states(
+            [robot.object_id],
+            joint_positions=target_pose,
+            joint_velocities=target_joint_vel,
+        )
+        joint_states = sim.get_articulated_joint_states([robot.object_id])
+        assert np.allclose(joint_states["joint_positions"], target_pose)
+        assert np.allclose(joint_states["joint_velocities"], target_joint_vel)
+        assert np.allclose(joint_states["joint_forces"], np.zeros(num_dofs))
+        # the arrays of a previous call are filled in place
+        out_arrays = dict(joint_states)
+        robot.joint_velocities = np.zeros(num_dofs)
+        filled = sim.get_articulated_joint_states([robot.object_id], out=joint_states)
+        assert filled is joint_states
+        for key, value in out_arrays.items():
+            assert filled[key] is value
+        assert np.allclose(joint_states["joint_velocities"], np.zeros(num_dofs))
+        # and the forces can be skipped
+        no_forces = sim.get_articulated_joint_states(
+            [robot.object_id], include_forces=False
+        )
+        assert "joint_forces" not in no_forces
+        assert np.allclose(no_forces["joint_positions"], target_pose)
+        robot.joint_velocities = target_joint_vel
+        # sizes must match the joint counts
+        assert not sim.set_articulated_joint_states(
+            [robot.object_id], joint_velocities=np.zeros(num_dofs + 1)
+        )
+        # packed root and joint state
+        packed_state = robot.packed_state
+        num_positions = robot.num_joint_positions
+        assert len(packed_state) == 13 + num_positions + num_dofs
+        assert np.allclose(packed_state[13 : 13 + num_positions], target_pose)
+        assert np.allclose(packed_state[13 + num_positions :], target_joint_vel)
+        robot.clear_joint_states()
+        robot.packed_state = packed_state
+        assert np.allclose(robot.joint_positions, target_pose)
+        assert np.allclose(robot.joint_velocities, target_joint_vel)
+        robot.clear_joint_states()
+
         # test joint limits and clamping
         joint_limits = robot.joint_position_limits
         lower_pos_limits = joint_limits[0]